@@ -13,6 +13,7 @@
     - basic property usage
     - basic image access and rendering
  */
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 #include <new>
@@ -38,13 +39,26 @@ OfxPropertySuiteV1    *gPropHost = 0;
 inline OfxRGBAColourB *
 pixelAddress(OfxRGBAColourB *img, OfxRectI rect, int x, int y, int bytesPerLine)
 {  
-  if(x < rect.x1 || x >= rect.x2 || y < rect.y1 || y > rect.y2)
+  if(x < rect.x1 || x >= rect.x2 || y < rect.y1 || y >= rect.y2)
     return 0;
   OfxRGBAColourB *pix = (OfxRGBAColourB *) (((char *) img) + (y - rect.y1) * bytesPerLine);
   pix += x - rect.x1;  
   return pix;
 }
 
+// invert a run of pixels, a whole pixel at a time by flipping the bits of its four bytes, which compilers
+// turn into SIMD code. Each pixel is read before it is written, so dst may be the same memory as src.
+static void
+invertPixels(OfxRGBAColourB *dst, const OfxRGBAColourB *src, int n)
+{
+  for(int i = 0; i < n; i++) {
+    unsigned int bits;
+    memcpy(&bits, src + i, sizeof(bits));
+    bits = ~bits;
+    memcpy(dst + i, &bits, sizeof(bits));
+  }
+}
+
 // throws this if it can't fetch an image
 class NoImageEx {};
 
@@ -69,7 +83,6 @@ static OfxStatus render(OfxImageEffectHandle  instance,
   OfxPropertySetHandle outputImg = NULL, sourceImg = NULL;
   try {
     // fetch image to render into from that clip
-    OfxPropertySetHandle outputImg;
     if(gEffectHost->clipGetImage(outputClip, time, NULL, &outputImg) != kOfxStatOK) {
       throw NoImageEx();
     }
@@ -105,30 +118,24 @@ static OfxStatus render(OfxImageEffectHandle  instance,
     OfxRGBAColourB *src = (OfxRGBAColourB *) srcPtr;
     OfxRGBAColourB *dst = (OfxRGBAColourB *) dstPtr;
 
-    // and do some inverting
+    // the part of each row that the source has pixels for
+    int x1 = std::max(renderWindow.x1, srcRect.x1);
+    int x2 = std::max(x1, std::min(renderWindow.x2, srcRect.x2));
+
+    // and do some inverting, pixels outside the source are black and transparent
     for(int y = renderWindow.y1; y < renderWindow.y2; y++) {
       if(gEffectHost->abort(instance)) break;
 
       OfxRGBAColourB *dstPix = pixelAddress(dst, dstRect, renderWindow.x1, y, dstRowBytes);
+      OfxRGBAColourB *srcPix = x1 < x2 ? pixelAddress(src, srcRect, x1, y, srcRowBytes) : 0;
 
-      for(int x = renderWindow.x1; x < renderWindow.x2; x++) {
-        
-        OfxRGBAColourB *srcPix = pixelAddress(src, srcRect, x, y, srcRowBytes);
-
-        if(srcPix) {
-          dstPix->r = 255 - srcPix->r;
-          dstPix->g = 255 - srcPix->g;
-          dstPix->b = 255 - srcPix->b;
-          dstPix->a = 255 - srcPix->a;
-        }
-        else {
-          dstPix->r = 0;
-          dstPix->g = 0;
-          dstPix->b = 0;
-          dstPix->a = 0;
-        }
-        dstPix++;
+      if(srcPix) {
+        memset(dstPix, 0, (x1 - renderWindow.x1) * sizeof(OfxRGBAColourB));
+        invertPixels(dstPix + (x1 - renderWindow.x1), srcPix, x2 - x1);
+        memset(dstPix + (x2 - renderWindow.x1), 0, (renderWindow.x2 - x2) * sizeof(OfxRGBAColourB));
       }
+      else
+        memset(dstPix, 0, (renderWindow.x2 - renderWindow.x1) * sizeof(OfxRGBAColourB));
     }
 
     // we are finished with the source images so release them
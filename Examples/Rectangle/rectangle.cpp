@@ -16,6 +16,7 @@
     - how spatially based effects should scale parameters appropriately.
     - premultiplication
  */
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 #include <new>
@@ -158,6 +159,21 @@ getCannonicalRect(OfxImageEffectHandle effect, double time, OfxRectD &rect)
   rect.y2 = Maximum(c1.y, c2.y);
 }
 
+// function that gets the corners params as a rectangle of pixels at a render scale, pixel aspect ratio and field scale
+static OfxRectI
+getPixelRect(OfxImageEffectHandle effect, double time, OfxPointD renderScale, double pixelAspectRatio, double fieldScale)
+{
+  OfxRectD rect;
+  getCannonicalRect(effect, time, rect);
+
+  OfxRectI rectI;
+  rectI.x1 = int(rect.x1 * renderScale.x / pixelAspectRatio);
+  rectI.x2 = int(rect.x2 * renderScale.x / pixelAspectRatio);
+  rectI.y1 = int(rect.y1 * renderScale.y * fieldScale);
+  rectI.y2 = int(rect.y2 * renderScale.y * fieldScale);
+  return rectI;
+}
+
 // tells the host what region we are capable of filling
 OfxStatus 
 getSpatialRoD(OfxImageEffectHandle effect, OfxPropertySetHandle inArgs, OfxPropertySetHandle outArgs)
@@ -239,23 +255,33 @@ isIdentity(OfxImageEffectHandle effect,
   // we should not be called on a generator
   if(myData->context != eIsGenerator){ 
 
-    // get the render window and the time from the inArgs
+    // get the render window, scale, field and the time from the inArgs
     OfxTime time;
     OfxRectI renderWindow;
+    OfxPointD renderScale;
+    char *field;
   
     gPropHost->propGetDouble(inArgs, kOfxPropTime, 0, &time);
     gPropHost->propGetIntN(inArgs, kOfxImageEffectPropRenderWindow, 4, &renderWindow.x1);
+    gPropHost->propGetDoubleN(inArgs, kOfxImageEffectPropRenderScale, 2, &renderScale.x);
+    gPropHost->propGetString(inArgs, kOfxImageEffectPropFieldToRender, 0, &field);
+    double fieldScale = strcmp(field, kOfxImageFieldLower) == 0 || strcmp(field, kOfxImageFieldUpper) == 0 ? 0.5 : 1.0;
+
+    // the output has the pixel aspect ratio of the source
+    OfxPropertySetHandle sourceProps;
+    double pixelAspectRatio;
+    gEffectHost->clipGetPropertySet(myData->sourceClip, &sourceProps);
+    gPropHost->propGetDouble(sourceProps, kOfxImagePropPixelAspectRatio, 0, &pixelAspectRatio);
 
-    // get my rectangle in canonical coords
-    OfxRectD rect;
-    getCannonicalRect(effect, time, rect);
+    // get my rectangle in the same pixels as the render window, as the render will draw it
+    OfxRectI rect = getPixelRect(effect, time, renderScale, pixelAspectRatio, fieldScale);
 
     OfxRGBAColourD col;
     gParamHost->paramGetValueAtTime(myData->colourParam, time, &col.r, &col.g, &col.b, &col.a);
 
-    // if the rectangle is transparent or out of the window, then we can do a pass through on to the source clip
-    if(col.a <= 0.0 || rect.x1 > renderWindow.x2 ||  rect.y1 > renderWindow.y2 || 
-       rect.x2 < renderWindow.x1 ||  rect.y2 < renderWindow.y1) {
+    // if the rectangle is transparent or covers none of the window, then we can do a pass through on to the source clip
+    if(col.a <= 0.0 || rect.x1 >= renderWindow.x2 ||  rect.y1 >= renderWindow.y2 || 
+       rect.x2 <= renderWindow.x1 ||  rect.y2 <= renderWindow.y1 || rect.x1 >= rect.x2 || rect.y1 >= rect.y2) {
       // set the property in the out args indicating which is the identity clip
       gPropHost->propSetString(outArgs, kOfxPropName, 0, kOfxImageEffectSimpleSourceClipName);
       return kOfxStatOK;
@@ -292,7 +318,7 @@ Lerp(float a, float b, float v)
 template <class PIX> inline PIX *
 pixelAddress(PIX *img, OfxRectI rect, int x, int y, int bytesPerLine)
 {  
-  if(x < rect.x1 || x >= rect.x2 || y < rect.y1 || y > rect.y2)
+  if(x < rect.x1 || x >= rect.x2 || y < rect.y1 || y >= rect.y2)
     return 0;
   PIX *pix = (PIX *) (((char *) img) + (y - rect.y1) * bytesPerLine);
   pix += x - rect.x1;  
@@ -301,6 +327,11 @@ pixelAddress(PIX *img, OfxRectI rect, int x, int y, int bytesPerLine)
 
 ////////////////////////////////////////////////////////////////////////////////
 // base class to process images with
+//
+// Rather than testing each pixel against the rectangle and the source, each row of the window is cut into runs:
+// outside the rectangle, where the source is copied, and inside it, where the colour is composited over the
+// source. Each of those is cut again at the edges of the source, outside of which there is nothing to copy or
+// composite over. So the per pixel work is a memcpy, a fill or a composite loop without any tests in it.
 class Processor {
 protected :
   OfxImageEffectHandle effect;
@@ -336,6 +367,41 @@ public :
   static void multiThreadProcessing(unsigned int threadId, unsigned int nThreads, void *arg);
   virtual void doProcessing(OfxRectI window) = 0;
   void process(void);
+
+protected :
+  // the part [sx1, sx2) of [x1, x2) on row y that the source has pixels for, empty and at x2 if none
+  void sourceSpan(int y, int x1, int x2, int &sx1, int &sx2) const
+  {
+    if(!srcV || y < srcRect.y1 || y >= srcRect.y2) {
+      sx1 = sx2 = x2;
+      return;
+    }
+    sx1 = Clamp(srcRect.x1, x1, x2);
+    sx2 = Clamp(srcRect.x2, sx1, x2);
+  }
+
+  // the part [rx1, rx2) of [x1, x2) on row y that is inside the rectangle, empty and at x2 if none
+  void rectangleSpan(int y, int x1, int x2, int &rx1, int &rx2) const
+  {
+    if(y < position.y1 || y >= position.y2) {
+      rx1 = rx2 = x2;
+      return;
+    }
+    rx1 = Clamp(position.x1, x1, x2);
+    rx2 = Clamp(position.x2, rx1, x2);
+  }
+
+  // copy the source into [x1, x2) of row y, starting at dstPix, which is black where there is no source
+  template <class PIX> void
+  copyRun(PIX *dstPix, int y, int x1, int x2, const PIX &black) const
+  {
+    int sx1, sx2;
+    sourceSpan(y, x1, x2, sx1, sx2);
+    std::fill(dstPix, dstPix + (sx1 - x1), black);
+    if(sx1 < sx2)
+      memcpy(dstPix + (sx1 - x1), pixelAddress((PIX *) srcV, srcRect, sx1, y, srcBytesPerLine), (sx2 - sx1) * sizeof(PIX));
+    std::fill(dstPix + (sx2 - x1), dstPix + (x2 - x1), black);
+  }
 };
 
 // function call once for each thread by the host
@@ -369,6 +435,10 @@ Processor::process(void)
 // template to do the RGBA processing
 template <class PIX, int max, int isFloat>
 class ProcessRGBA : public Processor{
+  PIX black;          // the default back ground
+  PIX value;          // the colour scaled up to quantisation space
+  PIX premultValue;   // and premultiplied
+
 public :
   ProcessRGBA(OfxImageEffectHandle eff,
               OfxRectI pos,
@@ -383,19 +453,8 @@ public :
                 dst,  dRect,  dBytesPerLine,
                 win)
   {
-  }
-
-  void doProcessing(OfxRectI procWindow)
-  {
-    PIX *src = (PIX *) srcV;
-    PIX *dst = (PIX *) dstV;
-
-    // black pixel for the default back ground
-    PIX black;
     black.r = black.g = black.b = black.a = 0;
 
-    // value and premulitplied of the colour scaled up to quantisation space
-    PIX value, premultValue;
     if(isFloat) {
       // no need to clamp
       value.r = colour.r * max;
@@ -420,83 +479,94 @@ public :
       premultValue.b = Clamp(colour.b * max * colour.a, 0, max);
       premultValue.a = Clamp(colour.a * max * colour.a, 0, max);
     }
+  }
+
+  // composite the colour over n unpremultiplied source pixels
+  void compositeUnpremultiplied(PIX *dstPix, const PIX *srcPix, int n) const
+  {
+    for(int i = 0; i < n; i++, srcPix++, dstPix++) {
+      // we have to premultiply, then unpremultiply the composite
+      float a = srcPix->a + value.a - (srcPix->a * value.a)/max;
+      float r, g, b;
+      if(srcPix->a == 0) {
+        r = g = b = 0;
+      }
+      else {
+        r = Lerp(srcPix->r * max/srcPix->a, value.r, colour.a) * a/max;
+        g = Lerp(srcPix->g * max/srcPix->a, value.g, colour.a) * a/max;
+        b = Lerp(srcPix->b * max/srcPix->a, value.b, colour.a) * a/max;
+      }
+
+      // clamp or not depending on if it is floating
+      if(isFloat) {
+        dstPix->r = r;
+        dstPix->g = g;
+        dstPix->b = b;
+        dstPix->a = a;
+      }
+      else {
+        dstPix->r = Clamp(r, 0, max);
+        dstPix->g = Clamp(g, 0, max);
+        dstPix->b = Clamp(b, 0, max);
+        dstPix->a = Clamp(a, 0, max);
+      }
+    }
+  }
+
+  // composite the colour over n premultiplied source pixels, with no branches so it can vectorise
+  void compositePremultiplied(PIX *dstPix, const PIX *srcPix, int n) const
+  {
+    float opacity = float(colour.a);
+    for(int i = 0; i < n; i++, srcPix++, dstPix++) {
+      if(isFloat) {
+        dstPix->r = Lerp(srcPix->r, value.r, opacity);
+        dstPix->g = Lerp(srcPix->g, value.g, opacity);
+        dstPix->b = Lerp(srcPix->b, value.b, opacity);
+        dstPix->a = srcPix->a + value.a - (srcPix->a * value.a)/max;
+      }
+      else {
+        dstPix->r = Clamp(int(Lerp(srcPix->r, value.r, opacity)), 0, max);
+        dstPix->g = Clamp(int(Lerp(srcPix->g, value.g, opacity)), 0, max);
+        dstPix->b = Clamp(int(Lerp(srcPix->b, value.b, opacity)), 0, max);
+        dstPix->a = Clamp(int(srcPix->a + value.a - (srcPix->a * value.a)/max), 0, max);
+      }
+    }
+  }
+
+  // render [x1, x2) of row y inside the rectangle, starting at dstPix
+  void compositeRun(PIX *dstPix, int y, int x1, int x2) const
+  {
+    // no src pixel, just set it
+    const PIX &fill = unpremultiplied ? premultValue : value;
+
+    int sx1, sx2;
+    sourceSpan(y, x1, x2, sx1, sx2);
+    std::fill(dstPix, dstPix + (sx1 - x1), fill);
+    if(sx1 < sx2) {
+      const PIX *srcPix = pixelAddress((PIX *) srcV, srcRect, sx1, y, srcBytesPerLine);
+      if(unpremultiplied)
+        compositeUnpremultiplied(dstPix + (sx1 - x1), srcPix, sx2 - sx1);
+      else
+        compositePremultiplied(dstPix + (sx1 - x1), srcPix, sx2 - sx1);
+    }
+    std::fill(dstPix + (sx2 - x1), dstPix + (x2 - x1), fill);
+  }
+
+  void doProcessing(OfxRectI procWindow)
+  {
+    PIX *dst = (PIX *) dstV;
 
     for(int y = procWindow.y1; y < procWindow.y2; y++) {
       if(gEffectHost->abort(effect)) break;
 
       PIX *dstPix = pixelAddress(dst, dstRect, procWindow.x1, y, dstBytesPerLine);
 
-      for(int x = procWindow.x1; x < procWindow.x2; x++) {
-        
-        // if a generator, we have no source
-        PIX *srcPix = 0;
-        if(src)
-          srcPix = pixelAddress(src, srcRect, x, y, srcBytesPerLine);        
-        
-        if(x < position.x1 || x >= position.x2 || y < position.y1 || y >= position.y2) {
-          // we are outside the rectangle
-          *dstPix = srcPix ? *srcPix : black;
-          if(srcPix)
-            srcPix++;
-        }
-        else {
-          // we are inside the rectangle, composite it over the source image
-          if(srcPix) {
-            if(unpremultiplied) {	
-              // we have to premultiply, then unpremultiply the composite
-              float a = srcPix->a + value.a - (srcPix->a * value.a)/max;
-              float r, g, b;
-              if(srcPix->a == 0) {
-                r = g = b = 0;
-              }
-              else {
-                r = Lerp(srcPix->r * max/srcPix->a, value.r, colour.a) * a/max;
-                g = Lerp(srcPix->g * max/srcPix->a, value.g, colour.a) * a/max;
-                b = Lerp(srcPix->b * max/srcPix->a, value.b, colour.a) * a/max;
-              }
-
-              // clamp or not depending on if it is floating
-              if(isFloat) {
-                dstPix->r = r;
-                dstPix->g = g;
-                dstPix->b = b;
-                dstPix->a = a;
-              }
-              else {
-                dstPix->r = Clamp(r, 0, max);
-                dstPix->g = Clamp(g, 0, max);
-                dstPix->b = Clamp(b, 0, max);
-                dstPix->a = Clamp(a, 0, max);
-              }
-            }
-            else {
-              // source is premultiplied, easier composite
-              if(isFloat) {
-                dstPix->r = Lerp(srcPix->r, value.r, colour.a);
-                dstPix->g = Lerp(srcPix->g, value.g, colour.a);
-                dstPix->b = Lerp(srcPix->b, value.b, colour.a);
-                dstPix->a = srcPix->a + value.a - (srcPix->a * value.a)/max;
-              }
-              else {
-                dstPix->r = Clamp(int(Lerp(srcPix->r, value.r, colour.a)), 0, max);
-                dstPix->g = Clamp(int(Lerp(srcPix->g, value.g, colour.a)), 0, max);
-                dstPix->b = Clamp(int(Lerp(srcPix->b, value.b, colour.a)), 0, max);
-                dstPix->a = Clamp(int(srcPix->a + value.a - (srcPix->a * value.a)/max), 0, max);
-              }
-            }
-
-            srcPix++;
-          }
-          else {
-            // no src pixel, just set it
-            if(unpremultiplied)
-              *dstPix = premultValue;
-            else
-              *dstPix = value;
-          }
-        }
-        dstPix++;
-      }
+      // the source before and after the rectangle, and the composite in it
+      int rx1, rx2;
+      rectangleSpan(y, procWindow.x1, procWindow.x2, rx1, rx2);
+      copyRun(dstPix, y, procWindow.x1, rx1, black);
+      compositeRun(dstPix + (rx1 - procWindow.x1), y, rx1, rx2);
+      copyRun(dstPix + (rx2 - procWindow.x1), y, rx2, procWindow.x2, black);
     }
   }
 };
@@ -504,6 +574,8 @@ public :
 // template to do the Alpha processing
 template <class PIX, int max, int isFloat>
 class ProcessAlpha : public Processor {
+  PIX value;   // the alpha of the colour scaled up to quantisation space
+
  public :
   ProcessAlpha(OfxImageEffectHandle inst,
 	       OfxRectI pos,
@@ -517,57 +589,51 @@ class ProcessAlpha : public Processor {
                 dst,  dRect,  dBytesPerLine,
                 win)
   {
-  }
-
-  void doProcessing(OfxRectI procWindow)
-  {
-    PIX *src = (PIX *) srcV;
-    PIX *dst = (PIX *) dstV;
-
-    PIX value;
     if(isFloat) {
       value = colour.a * max;
     }
     else {
       value = Clamp(colour.a * max, 0, max);
     }
-    
+  }
+
+  // render [x1, x2) of row y inside the rectangle, starting at dstPix, setting it to the alpha of the colour
+  void compositeRun(PIX *dstPix, int y, int x1, int x2) const
+  {
+    int sx1, sx2;
+    sourceSpan(y, x1, x2, sx1, sx2);
+    std::fill(dstPix, dstPix + (sx1 - x1), value);
+
+    const PIX *srcPix = sx1 < sx2 ? pixelAddress((PIX *) srcV, srcRect, sx1, y, srcBytesPerLine) : 0;
+    PIX *compPix = dstPix + (sx1 - x1);
+    for(int i = 0; i < sx2 - sx1; i++) {
+      // switch will be compiled out
+      if(isFloat) {
+        compPix[i] = srcPix[i] + value - srcPix[i] * value;
+      }
+      else {
+        compPix[i] = Clamp(int(srcPix[i] + value - srcPix[i] * value), 0, max);
+      }
+    }
+
+    std::fill(dstPix + (sx2 - x1), dstPix + (x2 - x1), value);
+  }
+
+  void doProcessing(OfxRectI procWindow)
+  {
+    PIX *dst = (PIX *) dstV;
+
     for(int y = procWindow.y1; y < procWindow.y2; y++) {
       if(gEffectHost->abort(effect)) break;
 
       PIX *dstPix = pixelAddress(dst, dstRect, procWindow.x1, y, dstBytesPerLine);
 
-      for(int x = procWindow.x1; x < procWindow.x2; x++) {
-        
-        // if a generator, we have no source
-        PIX *srcPix = 0;
-        if(src)
-          srcPix = pixelAddress(src, srcRect, x, y, srcBytesPerLine);        
-        
-        if(x < position.x1 || x >= position.x2 || y < position.y1 || y >= position.y2) {
-          // we are outside the rectangle we are drawing?
-          *dstPix = srcPix ? *srcPix : 0;
-          if(srcPix)
-            srcPix++;
-        }
-        else {
-          // we are inside the rectangle, set it to the alpha of the colour
-          if(srcPix) {
-            // switch will be compiled out
-            if(isFloat) {
-              *dstPix = *srcPix + value - *srcPix * value;
-            }
-            else {
-              *dstPix = Clamp(int(*srcPix + value - *srcPix * value), 0, max);
-            }
-            srcPix++;
-          }
-          else {
-            *dstPix = value;
-          }
-        }
-        dstPix++;
-      }
+      // the source before and after the rectangle, and the alpha of the colour over it in it
+      int rx1, rx2;
+      rectangleSpan(y, procWindow.x1, procWindow.x2, rx1, rx2);
+      copyRun(dstPix, y, procWindow.x1, rx1, PIX(0));
+      compositeRun(dstPix + (rx1 - procWindow.x1), y, rx1, rx2);
+      copyRun(dstPix + (rx2 - procWindow.x1), y, rx2, procWindow.x2, PIX(0));
     }
   }
 };
@@ -625,16 +691,8 @@ static OfxStatus render(OfxImageEffectHandle effect,
     double pixelAspectRatio;
     gPropHost->propGetDouble(outputImg, kOfxImagePropPixelAspectRatio, 0, &pixelAspectRatio);
 
-    // get the rect in canonical coordinates  
-    OfxRectD rect;
-    getCannonicalRect(effect, time, rect);
-  
-    // Turn that into pixel coordinates
-    OfxRectI rectI;
-    rectI.x1 = int(rect.x1 * renderScale.x / pixelAspectRatio);
-    rectI.x2 = int(rect.x2 * renderScale.x / pixelAspectRatio);
-    rectI.y1 = int(rect.y1 * renderScale.y * fieldScale);
-    rectI.y2 = int(rect.y2 * renderScale.y * fieldScale);
+    // get the rect in pixel coordinates
+    OfxRectI rectI = getPixelRect(effect, time, renderScale, pixelAspectRatio, fieldScale);
 
     // get the colour of it
     OfxRGBAColourD colour;
@@ -20,6 +20,10 @@
 #include "ofxhPluginCache.h"
 #include "ofxhHost.h"
 #include "ofxhImageEffectAPI.h"
+#include "ofxhAnimation.h"
+#ifdef OFX_SUPPORTS_PARAMETRIC
+#include "ofxhParametricParam.h"
+#endif
 
 // my host
 #include "hostDemoHostDescriptor.h"
@@ -160,6 +164,14 @@ namespace MyHost {
       return new OFX::Host::Param::GroupInstance(descriptor,this);
     else if(descriptor.getType()==kOfxParamTypePage)
       return new OFX::Host::Param::PageInstance(descriptor,this);
+#ifdef OFX_SUPPORTS_PARAMETRIC
+    else if(descriptor.getType()==kOfxParamTypeParametric) {
+      // plugins evaluate these to fill their own look up tables, so bake ours
+      OFX::Host::ParametricParam::ParametricInstance *instance = new OFX::Host::ParametricParam::ParametricInstance(descriptor,this);
+      instance->setLUTSize(4096);
+      return instance;
+    }
+#endif
     else
       return 0;
   }
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <cmath>
 
 // ofx
 #include "ofxCore.h"
@@ -20,6 +21,7 @@
 #include "ofxhPluginCache.h"
 #include "ofxhHost.h"
 #include "ofxhImageEffectAPI.h"
+#include "ofxhAnimation.h"
 
 // my host
 #include "hostDemoHostDescriptor.h"
@@ -29,6 +31,42 @@
 
 namespace MyHost {
 
+  using OFX::Host::Animation::Curve;
+
+  /// make a curve holding the default of a double valued param
+  static Curve makeDoubleCurve(OFX::Host::Param::Descriptor& descriptor, int dim)
+  {
+    double v[4];
+    descriptor.getProperties().getDoublePropertyN(kOfxParamPropDefault, v, dim);
+    return Curve(dim, v);
+  }
+
+  /// make a curve holding the default of an int valued param
+  static Curve makeIntCurve(OFX::Host::Param::Descriptor& descriptor, int dim)
+  {
+    int iv[3];
+    double v[3];
+    descriptor.getProperties().getIntPropertyN(kOfxParamPropDefault, iv, dim);
+    for(int i = 0; i < dim; ++i)
+      v[i] = iv[i];
+    return Curve(dim, v);
+  }
+
+  /// int params hold doubles on their curves
+  static int roundToInt(double v)
+  {
+    return int(std::floor(v + 0.5));
+  }
+
+  /// set the value at the 'current' time, which keys the param if it is already animating
+  static void setCurrentValue(Curve &curve, MyEffectInstance* effect, const double *v, OFX::Host::Animation::InterpolationEnum interpolation)
+  {
+    if(curve.isAnimating())
+      curve.setKey(effect->timeLineGetTime(), v, interpolation);
+    else
+      curve.setDefault(v);
+  }
+
   //
   // MyIntegerInstance
   //
@@ -36,27 +74,50 @@ namespace MyHost {
   MyIntegerInstance::MyIntegerInstance(MyEffectInstance* effect, 
                                        const std::string& name, 
                                        OFX::Host::Param::Descriptor& descriptor)
-    : _effect(effect), _descriptor(descriptor), OFX::Host::Param::IntegerInstance(descriptor)
+    : OFX::Host::Param::IntegerInstance(descriptor), _effect(effect), _descriptor(descriptor), _curve(makeIntCurve(descriptor, 1))
   {
   }
 
-  OfxStatus MyIntegerInstance::get(int&)
+  OfxStatus MyIntegerInstance::get(int& i)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), i);
   }
 
-  OfxStatus MyIntegerInstance::get(OfxTime time, int&)
+  OfxStatus MyIntegerInstance::get(OfxTime time, int& i)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v;
+    _curve.getValue(time, &v);
+    i = roundToInt(v);
+    return kOfxStatOK;
+  }
+
+  OfxStatus MyIntegerInstance::set(int i)
+  {
+    double v = i;
+    setCurrentValue(_curve, _effect, &v, OFX::Host::Animation::eInterpolationLinear);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyIntegerInstance::set(int)
+  OfxStatus MyIntegerInstance::set(OfxTime time, int i) {
+    double v = i;
+    _curve.setKey(time, &v, OFX::Host::Animation::eInterpolationLinear);
+    return kOfxStatOK;
+  }
+
+  OfxStatus MyIntegerInstance::derive(OfxTime time, int& i)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v;
+    _curve.getDerivative(time, &v);
+    i = roundToInt(v);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyIntegerInstance::set(OfxTime time, int) {
-    return kOfxStatErrMissingHostFeature;
+  OfxStatus MyIntegerInstance::integrate(OfxTime time1, OfxTime time2, int& i)
+  {
+    double v;
+    _curve.getIntegral(time1, time2, &v);
+    i = roundToInt(v);
+    return kOfxStatOK;
   }
 
   //
@@ -66,42 +127,44 @@ namespace MyHost {
   MyDoubleInstance::MyDoubleInstance(MyEffectInstance* effect, 
                                      const std::string& name, 
                                      OFX::Host::Param::Descriptor& descriptor)
-    : _effect(effect), _descriptor(descriptor), OFX::Host::Param::DoubleInstance(descriptor)
+    : OFX::Host::Param::DoubleInstance(descriptor), _effect(effect), _descriptor(descriptor), _curve(makeDoubleCurve(descriptor, 1))
   {
   }
 
   OfxStatus MyDoubleInstance::get(double& d)
   {
-    // values for the Basic OFX plugin to work
-    d = 2.0;
+    _curve.getValue(_effect->timeLineGetTime(), &d);
     return kOfxStatOK;
   }
 
   OfxStatus MyDoubleInstance::get(OfxTime time, double& d)
   {
-    // values for the Basic OFX plugin to work
-    d = 2.0;
+    _curve.getValue(time, &d);
     return kOfxStatOK;
   }
 
-  OfxStatus MyDoubleInstance::set(double)
+  OfxStatus MyDoubleInstance::set(double d)
   {
-    return kOfxStatErrMissingHostFeature;
+    setCurrentValue(_curve, _effect, &d, OFX::Host::Animation::eInterpolationSmooth);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyDoubleInstance::set(OfxTime time, double) 
+  OfxStatus MyDoubleInstance::set(OfxTime time, double d) 
   {
-    return kOfxStatErrMissingHostFeature;
+    _curve.setKey(time, &d);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyDoubleInstance::derive(OfxTime time, double&)
+  OfxStatus MyDoubleInstance::derive(OfxTime time, double& d)
   {
-    return kOfxStatErrMissingHostFeature;
+    _curve.getDerivative(time, &d);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyDoubleInstance::integrate(OfxTime time1, OfxTime time2, double&)
+  OfxStatus MyDoubleInstance::integrate(OfxTime time1, OfxTime time2, double& d)
   {
-    return kOfxStatErrMissingHostFeature;
+    _curve.getIntegral(time1, time2, &d);
+    return kOfxStatOK;
   }
 
   //
@@ -111,29 +174,34 @@ namespace MyHost {
   MyBooleanInstance::MyBooleanInstance(MyEffectInstance* effect, 
                                        const std::string& name, 
                                        OFX::Host::Param::Descriptor& descriptor)
-    : _effect(effect), _descriptor(descriptor), OFX::Host::Param::BooleanInstance(descriptor)
+    : OFX::Host::Param::BooleanInstance(descriptor), _effect(effect), _descriptor(descriptor), _curve(makeIntCurve(descriptor, 1))
   {
   }
 
   OfxStatus MyBooleanInstance::get(bool& b)
   {
-    b = true;
-    return kOfxStatOK;
+    return get(_effect->timeLineGetTime(), b);
   }
 
   OfxStatus MyBooleanInstance::get(OfxTime time, bool& b)
   {
-    b = true;
+    double v;
+    _curve.getValue(time, &v);
+    b = v != 0.;
     return kOfxStatOK;
   }
 
-  OfxStatus MyBooleanInstance::set(bool)
+  OfxStatus MyBooleanInstance::set(bool b)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v = b ? 1. : 0.;
+    setCurrentValue(_curve, _effect, &v, OFX::Host::Animation::eInterpolationConstant);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyBooleanInstance::set(OfxTime time, bool) {
-    return kOfxStatErrMissingHostFeature;
+  OfxStatus MyBooleanInstance::set(OfxTime time, bool b) {
+    double v = b ? 1. : 0.;
+    _curve.setKey(time, &v, OFX::Host::Animation::eInterpolationConstant);
+    return kOfxStatOK;
   }
 
   //
@@ -143,28 +211,35 @@ namespace MyHost {
   MyChoiceInstance::MyChoiceInstance(MyEffectInstance* effect, 
                                      const std::string& name, 
                                      OFX::Host::Param::Descriptor& descriptor)
-    : _effect(effect), _descriptor(descriptor), OFX::Host::Param::ChoiceInstance(descriptor)
+    : OFX::Host::Param::ChoiceInstance(descriptor), _effect(effect), _descriptor(descriptor), _curve(makeIntCurve(descriptor, 1))
   {
   }
 
-  OfxStatus MyChoiceInstance::get(int&)
+  OfxStatus MyChoiceInstance::get(int& i)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), i);
   }
 
-  OfxStatus MyChoiceInstance::get(OfxTime time, int&)
+  OfxStatus MyChoiceInstance::get(OfxTime time, int& i)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v;
+    _curve.getValue(time, &v);
+    i = roundToInt(v);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyChoiceInstance::set(int)
+  OfxStatus MyChoiceInstance::set(int i)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v = i;
+    setCurrentValue(_curve, _effect, &v, OFX::Host::Animation::eInterpolationConstant);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyChoiceInstance::set(OfxTime time, int) 
+  OfxStatus MyChoiceInstance::set(OfxTime time, int i) 
   {
-    return kOfxStatErrMissingHostFeature;
+    double v = i;
+    _curve.setKey(time, &v, OFX::Host::Animation::eInterpolationConstant);
+    return kOfxStatOK;
   }
 
   //
@@ -174,28 +249,51 @@ namespace MyHost {
   MyRGBAInstance::MyRGBAInstance(MyEffectInstance* effect, 
                                  const std::string& name, 
                                  OFX::Host::Param::Descriptor& descriptor)
-    : _effect(effect), _descriptor(descriptor), OFX::Host::Param::RGBAInstance(descriptor)
+    : OFX::Host::Param::RGBAInstance(descriptor), _effect(effect), _descriptor(descriptor), _curve(makeDoubleCurve(descriptor, 4))
   {
   }
 
-  OfxStatus MyRGBAInstance::get(double&,double&,double&,double&)
+  OfxStatus MyRGBAInstance::get(double& r,double& g,double& b,double& a)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), r, g, b, a);
   }
 
-  OfxStatus MyRGBAInstance::get(OfxTime time, double&,double&,double&,double&)
+  OfxStatus MyRGBAInstance::get(OfxTime time, double& r,double& g,double& b,double& a)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[4];
+    _curve.getValue(time, v);
+    r = v[0]; g = v[1]; b = v[2]; a = v[3];
+    return kOfxStatOK;
   }
 
-  OfxStatus MyRGBAInstance::set(double,double,double,double)
+  OfxStatus MyRGBAInstance::set(double r,double g,double b,double a)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[4] = {r, g, b, a};
+    setCurrentValue(_curve, _effect, v, OFX::Host::Animation::eInterpolationSmooth);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyRGBAInstance::set(OfxTime time, double,double,double,double)
+  OfxStatus MyRGBAInstance::set(OfxTime time, double r,double g,double b,double a)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[4] = {r, g, b, a};
+    _curve.setKey(time, v);
+    return kOfxStatOK;
+  }
+
+  OfxStatus MyRGBAInstance::derive(OfxTime time, double& r,double& g,double& b,double& a)
+  {
+    double v[4];
+    _curve.getDerivative(time, v);
+    r = v[0]; g = v[1]; b = v[2]; a = v[3];
+    return kOfxStatOK;
+  }
+
+  OfxStatus MyRGBAInstance::integrate(OfxTime time1, OfxTime time2, double& r,double& g,double& b,double& a)
+  {
+    double v[4];
+    _curve.getIntegral(time1, time2, v);
+    r = v[0]; g = v[1]; b = v[2]; a = v[3];
+    return kOfxStatOK;
   }
 
   //
@@ -205,28 +303,51 @@ namespace MyHost {
   MyRGBInstance::MyRGBInstance(MyEffectInstance* effect, 
                                const std::string& name, 
                                OFX::Host::Param::Descriptor& descriptor)
-    : _effect(effect), _descriptor(descriptor), OFX::Host::Param::RGBInstance(descriptor)
+    : OFX::Host::Param::RGBInstance(descriptor), _effect(effect), _descriptor(descriptor), _curve(makeDoubleCurve(descriptor, 3))
   {
   }
 
-  OfxStatus MyRGBInstance::get(double&,double&,double&)
+  OfxStatus MyRGBInstance::get(double& r,double& g,double& b)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), r, g, b);
   }
 
-  OfxStatus MyRGBInstance::get(OfxTime time, double&,double&,double&)
+  OfxStatus MyRGBInstance::get(OfxTime time, double& r,double& g,double& b)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[3];
+    _curve.getValue(time, v);
+    r = v[0]; g = v[1]; b = v[2];
+    return kOfxStatOK;
   }
 
-  OfxStatus MyRGBInstance::set(double,double,double)
+  OfxStatus MyRGBInstance::set(double r,double g,double b)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[3] = {r, g, b};
+    setCurrentValue(_curve, _effect, v, OFX::Host::Animation::eInterpolationSmooth);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyRGBInstance::set(OfxTime time, double,double,double)
+  OfxStatus MyRGBInstance::set(OfxTime time, double r,double g,double b)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[3] = {r, g, b};
+    _curve.setKey(time, v);
+    return kOfxStatOK;
+  }
+
+  OfxStatus MyRGBInstance::derive(OfxTime time, double& r,double& g,double& b)
+  {
+    double v[3];
+    _curve.getDerivative(time, v);
+    r = v[0]; g = v[1]; b = v[2];
+    return kOfxStatOK;
+  }
+
+  OfxStatus MyRGBInstance::integrate(OfxTime time1, OfxTime time2, double& r,double& g,double& b)
+  {
+    double v[3];
+    _curve.getIntegral(time1, time2, v);
+    r = v[0]; g = v[1]; b = v[2];
+    return kOfxStatOK;
   }
 
   //
@@ -236,28 +357,51 @@ namespace MyHost {
   MyDouble2DInstance::MyDouble2DInstance(MyEffectInstance* effect, 
                                          const std::string& name, 
                                          OFX::Host::Param::Descriptor& descriptor)
-    : _effect(effect), _descriptor(descriptor), OFX::Host::Param::Double2DInstance(descriptor)
+    : OFX::Host::Param::Double2DInstance(descriptor), _effect(effect), _descriptor(descriptor), _curve(makeDoubleCurve(descriptor, 2))
   {
   }
 
-  OfxStatus MyDouble2DInstance::get(double&,double&)
+  OfxStatus MyDouble2DInstance::get(double& x,double& y)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), x, y);
   }
 
-  OfxStatus MyDouble2DInstance::get(OfxTime time,double&,double&)
+  OfxStatus MyDouble2DInstance::get(OfxTime time,double& x,double& y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[2];
+    _curve.getValue(time, v);
+    x = v[0]; y = v[1];
+    return kOfxStatOK;
   }
 
-  OfxStatus MyDouble2DInstance::set(double,double)
+  OfxStatus MyDouble2DInstance::set(double x,double y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[2] = {x, y};
+    setCurrentValue(_curve, _effect, v, OFX::Host::Animation::eInterpolationSmooth);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyDouble2DInstance::set(OfxTime time,double,double)
+  OfxStatus MyDouble2DInstance::set(OfxTime time,double x,double y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[2] = {x, y};
+    _curve.setKey(time, v);
+    return kOfxStatOK;
+  }
+
+  OfxStatus MyDouble2DInstance::derive(OfxTime time, double& x,double& y)
+  {
+    double v[2];
+    _curve.getDerivative(time, v);
+    x = v[0]; y = v[1];
+    return kOfxStatOK;
+  }
+
+  OfxStatus MyDouble2DInstance::integrate(OfxTime time1, OfxTime time2, double& x,double& y)
+  {
+    double v[2];
+    _curve.getIntegral(time1, time2, v);
+    x = v[0]; y = v[1];
+    return kOfxStatOK;
   }
 
   //
@@ -267,38 +411,45 @@ namespace MyHost {
   MyInteger2DInstance::MyInteger2DInstance(MyEffectInstance* effect, 
                                            const std::string& name, 
                                            OFX::Host::Param::Descriptor& descriptor)
-    : _effect(effect), _descriptor(descriptor), OFX::Host::Param::Integer2DInstance(descriptor)
+    : OFX::Host::Param::Integer2DInstance(descriptor), _effect(effect), _descriptor(descriptor), _curve(makeIntCurve(descriptor, 2))
   {
   }
 
-  OfxStatus MyInteger2DInstance::get(int&,int&)
+  OfxStatus MyInteger2DInstance::get(int& x,int& y)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), x, y);
   }
 
-  OfxStatus MyInteger2DInstance::get(OfxTime time,int&,int&)
+  OfxStatus MyInteger2DInstance::get(OfxTime time,int& x,int& y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[2];
+    _curve.getValue(time, v);
+    x = roundToInt(v[0]); y = roundToInt(v[1]);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyInteger2DInstance::set(int,int)
+  OfxStatus MyInteger2DInstance::set(int x,int y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[2] = {double(x), double(y)};
+    setCurrentValue(_curve, _effect, v, OFX::Host::Animation::eInterpolationLinear);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyInteger2DInstance::set(OfxTime time,int,int)
+  OfxStatus MyInteger2DInstance::set(OfxTime time,int x,int y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double v[2] = {double(x), double(y)};
+    _curve.setKey(time, v, OFX::Host::Animation::eInterpolationLinear);
+    return kOfxStatOK;
   }
 
   //
-  // MyInteger2DInstance
+  // MyPushbuttonInstance
   //
 
   MyPushbuttonInstance::MyPushbuttonInstance(MyEffectInstance* effect, 
                                              const std::string& name, 
                                              OFX::Host::Param::Descriptor& descriptor)
-    : _effect(effect), _descriptor(descriptor), OFX::Host::Param::PushbuttonInstance(descriptor)
+    : OFX::Host::Param::PushbuttonInstance(descriptor), _effect(effect), _descriptor(descriptor)
   {
   }
 
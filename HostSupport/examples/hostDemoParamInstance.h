@@ -17,18 +17,29 @@ namespace MyHost {
   protected:
     MyEffectInstance*   _effect;
     OFX::Host::Param::Descriptor& _descriptor;
+    OFX::Host::Animation::Curve _curve;
   public:
     MyIntegerInstance(MyEffectInstance* effect, const std::string& name, OFX::Host::Param::Descriptor& descriptor);
     OfxStatus get(int&);
     OfxStatus get(OfxTime time, int&);
     OfxStatus set(int);
     OfxStatus set(OfxTime time, int);
+    OfxStatus derive(OfxTime time, int&);
+    OfxStatus integrate(OfxTime time1, OfxTime time2, int&);
+
+    // keyframes live on the curve
+    OfxStatus getNumKeys(unsigned int &nKeys) const {return _curve.getNumKeys(nKeys);}
+    OfxStatus getKeyTime(int nth, OfxTime& time) const {return _curve.getKeyTime(nth, time);}
+    OfxStatus getKeyIndex(OfxTime time, int direction, int & index) const {return _curve.getKeyIndex(time, direction, index);}
+    OfxStatus deleteKey(OfxTime time) {return _curve.deleteKey(time);}
+    OfxStatus deleteAllKeys() {return _curve.deleteAllKeys();}
   };
 
   class MyDoubleInstance : public OFX::Host::Param::DoubleInstance {
   protected:
     MyEffectInstance*   _effect;
     OFX::Host::Param::Descriptor& _descriptor;
+    OFX::Host::Animation::Curve _curve;
   public:
     MyDoubleInstance(MyEffectInstance* effect, const std::string& name, OFX::Host::Param::Descriptor& descriptor);
     OfxStatus get(double&);
@@ -37,42 +48,77 @@ namespace MyHost {
     OfxStatus set(OfxTime time, double);
     OfxStatus derive(OfxTime time, double&);
     OfxStatus integrate(OfxTime time1, OfxTime time2, double&);
+    OfxStatus getAtTimes(const OfxTime *times, int nTimes, double *values) {_curve.getValues(times, nTimes, values); return kOfxStatOK;}
+
+    // keyframes live on the curve
+    OfxStatus getNumKeys(unsigned int &nKeys) const {return _curve.getNumKeys(nKeys);}
+    OfxStatus getKeyTime(int nth, OfxTime& time) const {return _curve.getKeyTime(nth, time);}
+    OfxStatus getKeyIndex(OfxTime time, int direction, int & index) const {return _curve.getKeyIndex(time, direction, index);}
+    OfxStatus deleteKey(OfxTime time) {return _curve.deleteKey(time);}
+    OfxStatus deleteAllKeys() {return _curve.deleteAllKeys();}
   };
 
   class MyBooleanInstance : public OFX::Host::Param::BooleanInstance {
   protected:
     MyEffectInstance*   _effect;
     OFX::Host::Param::Descriptor& _descriptor;
+    OFX::Host::Animation::Curve _curve;
   public:
     MyBooleanInstance(MyEffectInstance* effect, const std::string& name, OFX::Host::Param::Descriptor& descriptor);
     OfxStatus get(bool&);
     OfxStatus get(OfxTime time, bool&);
     OfxStatus set(bool);
     OfxStatus set(OfxTime time, bool);
+
+    // keyframes live on the curve
+    OfxStatus getNumKeys(unsigned int &nKeys) const {return _curve.getNumKeys(nKeys);}
+    OfxStatus getKeyTime(int nth, OfxTime& time) const {return _curve.getKeyTime(nth, time);}
+    OfxStatus getKeyIndex(OfxTime time, int direction, int & index) const {return _curve.getKeyIndex(time, direction, index);}
+    OfxStatus deleteKey(OfxTime time) {return _curve.deleteKey(time);}
+    OfxStatus deleteAllKeys() {return _curve.deleteAllKeys();}
   };
 
   class MyChoiceInstance : public OFX::Host::Param::ChoiceInstance {
   protected:
     MyEffectInstance*   _effect;
     OFX::Host::Param::Descriptor& _descriptor;
+    OFX::Host::Animation::Curve _curve;
   public:
     MyChoiceInstance(MyEffectInstance* effect,  const std::string& name, OFX::Host::Param::Descriptor& descriptor);
     OfxStatus get(int&);
     OfxStatus get(OfxTime time, int&);
     OfxStatus set(int);
     OfxStatus set(OfxTime time, int);
+
+    // keyframes live on the curve
+    OfxStatus getNumKeys(unsigned int &nKeys) const {return _curve.getNumKeys(nKeys);}
+    OfxStatus getKeyTime(int nth, OfxTime& time) const {return _curve.getKeyTime(nth, time);}
+    OfxStatus getKeyIndex(OfxTime time, int direction, int & index) const {return _curve.getKeyIndex(time, direction, index);}
+    OfxStatus deleteKey(OfxTime time) {return _curve.deleteKey(time);}
+    OfxStatus deleteAllKeys() {return _curve.deleteAllKeys();}
   };
 
   class MyRGBAInstance : public OFX::Host::Param::RGBAInstance {
   protected:
     MyEffectInstance*   _effect;
     OFX::Host::Param::Descriptor& _descriptor;
+    OFX::Host::Animation::Curve _curve;
   public:
     MyRGBAInstance(MyEffectInstance* effect, const std::string& name, OFX::Host::Param::Descriptor& descriptor);
     OfxStatus get(double&,double&,double&,double&);
     OfxStatus get(OfxTime time, double&,double&,double&,double&);
     OfxStatus set(double,double,double,double);
     OfxStatus set(OfxTime time, double,double,double,double);
+    OfxStatus derive(OfxTime time, double&,double&,double&,double&);
+    OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&,double&,double&);
+    OfxStatus getAtTimes(const OfxTime *times, int nTimes, double *values) {_curve.getValues(times, nTimes, values); return kOfxStatOK;}
+
+    // keyframes live on the curve
+    OfxStatus getNumKeys(unsigned int &nKeys) const {return _curve.getNumKeys(nKeys);}
+    OfxStatus getKeyTime(int nth, OfxTime& time) const {return _curve.getKeyTime(nth, time);}
+    OfxStatus getKeyIndex(OfxTime time, int direction, int & index) const {return _curve.getKeyIndex(time, direction, index);}
+    OfxStatus deleteKey(OfxTime time) {return _curve.deleteKey(time);}
+    OfxStatus deleteAllKeys() {return _curve.deleteAllKeys();}
   };
 
 
@@ -80,36 +126,66 @@ namespace MyHost {
   protected:
     MyEffectInstance*   _effect;
     OFX::Host::Param::Descriptor& _descriptor;
+    OFX::Host::Animation::Curve _curve;
   public:
     MyRGBInstance(MyEffectInstance* effect,  const std::string& name, OFX::Host::Param::Descriptor& descriptor);
     OfxStatus get(double&,double&,double&);
     OfxStatus get(OfxTime time, double&,double&,double&);
     OfxStatus set(double,double,double);
     OfxStatus set(OfxTime time, double,double,double);
+    OfxStatus derive(OfxTime time, double&,double&,double&);
+    OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&,double&);
+    OfxStatus getAtTimes(const OfxTime *times, int nTimes, double *values) {_curve.getValues(times, nTimes, values); return kOfxStatOK;}
+
+    // keyframes live on the curve
+    OfxStatus getNumKeys(unsigned int &nKeys) const {return _curve.getNumKeys(nKeys);}
+    OfxStatus getKeyTime(int nth, OfxTime& time) const {return _curve.getKeyTime(nth, time);}
+    OfxStatus getKeyIndex(OfxTime time, int direction, int & index) const {return _curve.getKeyIndex(time, direction, index);}
+    OfxStatus deleteKey(OfxTime time) {return _curve.deleteKey(time);}
+    OfxStatus deleteAllKeys() {return _curve.deleteAllKeys();}
   };
 
   class MyDouble2DInstance : public OFX::Host::Param::Double2DInstance {
   protected:
     MyEffectInstance*   _effect;
     OFX::Host::Param::Descriptor& _descriptor;
+    OFX::Host::Animation::Curve _curve;
   public:
     MyDouble2DInstance(MyEffectInstance* effect, const std::string& name, OFX::Host::Param::Descriptor& descriptor);
     OfxStatus get(double&,double&);
     OfxStatus get(OfxTime time,double&,double&);
     OfxStatus set(double,double);
     OfxStatus set(OfxTime time,double,double);
+    OfxStatus derive(OfxTime time, double&,double&);
+    OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&);
+    OfxStatus getAtTimes(const OfxTime *times, int nTimes, double *values) {_curve.getValues(times, nTimes, values); return kOfxStatOK;}
+
+    // keyframes live on the curve
+    OfxStatus getNumKeys(unsigned int &nKeys) const {return _curve.getNumKeys(nKeys);}
+    OfxStatus getKeyTime(int nth, OfxTime& time) const {return _curve.getKeyTime(nth, time);}
+    OfxStatus getKeyIndex(OfxTime time, int direction, int & index) const {return _curve.getKeyIndex(time, direction, index);}
+    OfxStatus deleteKey(OfxTime time) {return _curve.deleteKey(time);}
+    OfxStatus deleteAllKeys() {return _curve.deleteAllKeys();}
   };
 
   class MyInteger2DInstance : public OFX::Host::Param::Integer2DInstance {
   protected:
     MyEffectInstance*   _effect;
     OFX::Host::Param::Descriptor& _descriptor;
+    OFX::Host::Animation::Curve _curve;
   public:
     MyInteger2DInstance(MyEffectInstance* effect,  const std::string& name, OFX::Host::Param::Descriptor& descriptor);
     OfxStatus get(int&,int&);
     OfxStatus get(OfxTime time,int&,int&);
     OfxStatus set(int,int);
     OfxStatus set(OfxTime time,int,int);
+
+    // keyframes live on the curve
+    OfxStatus getNumKeys(unsigned int &nKeys) const {return _curve.getNumKeys(nKeys);}
+    OfxStatus getKeyTime(int nth, OfxTime& time) const {return _curve.getKeyTime(nth, time);}
+    OfxStatus getKeyIndex(OfxTime time, int direction, int & index) const {return _curve.getKeyIndex(time, direction, index);}
+    OfxStatus deleteKey(OfxTime time) {return _curve.deleteKey(time);}
+    OfxStatus deleteAllKeys() {return _curve.deleteAllKeys();}
   };
 
 
@@ -0,0 +1,109 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+////////////////////////////////////////////////////////////////////////////////
+/// This example times the param suite's get calls, which plugins that do not
+/// cache their params make for every value they read, on double, RGBA and
+/// int params whose values are plain members, so only the suite's own cost
+/// and the var args decoding are measured.
+///
+/// paramGetBench [calls] [runs]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "ofxPixels.h"
+#include "ofxhParam.h"
+
+/// a double param holding its value
+class BenchDouble : public OFX::Host::Param::DoubleInstance {
+  double _value;
+public :
+  BenchDouble(OFX::Host::Param::Descriptor &descriptor) : OFX::Host::Param::DoubleInstance(descriptor), _value(0.5) {}
+  OfxStatus get(double &v) {v = _value; return kOfxStatOK;}
+  OfxStatus get(OfxTime, double &v) {v = _value; return kOfxStatOK;}
+  OfxStatus set(double v) {_value = v; return kOfxStatOK;}
+  OfxStatus set(OfxTime, double v) {_value = v; return kOfxStatOK;}
+  OfxStatus derive(OfxTime, double &v) {v = 0; return kOfxStatOK;}
+  OfxStatus integrate(OfxTime time1, OfxTime time2, double &v) {v = _value * (time2 - time1); return kOfxStatOK;}
+};
+
+/// an RGBA param holding its value
+class BenchRGBA : public OFX::Host::Param::RGBAInstance {
+  double _value[4];
+public :
+  BenchRGBA(OFX::Host::Param::Descriptor &descriptor) : OFX::Host::Param::RGBAInstance(descriptor) {_value[0] = _value[1] = _value[2] = _value[3] = 0.5;}
+  OfxStatus get(double &r, double &g, double &b, double &a) {r = _value[0]; g = _value[1]; b = _value[2]; a = _value[3]; return kOfxStatOK;}
+  OfxStatus get(OfxTime, double &r, double &g, double &b, double &a) {return get(r, g, b, a);}
+  OfxStatus set(double r, double g, double b, double a) {_value[0] = r; _value[1] = g; _value[2] = b; _value[3] = a; return kOfxStatOK;}
+  OfxStatus set(OfxTime, double r, double g, double b, double a) {return set(r, g, b, a);}
+};
+
+/// an int param holding its value
+class BenchInt : public OFX::Host::Param::IntegerInstance {
+  int _value;
+public :
+  BenchInt(OFX::Host::Param::Descriptor &descriptor) : OFX::Host::Param::IntegerInstance(descriptor), _value(1) {}
+  OfxStatus get(int &v) {v = _value; return kOfxStatOK;}
+  OfxStatus get(OfxTime, int &v) {v = _value; return kOfxStatOK;}
+  OfxStatus set(int v) {_value = v; return kOfxStatOK;}
+  OfxStatus set(OfxTime, int v) {_value = v; return kOfxStatOK;}
+};
+
+typedef std::chrono::steady_clock Clock;
+
+/// time the fastest of several runs of a loop of get calls, in ms
+template <class GET>
+static double timeCalls(int calls, int runs, GET get)
+{
+  double best = 1e30;
+  for(int r = 0; r < runs; ++r) {
+    Clock::time_point start = Clock::now();
+    for(int i = 0; i < calls; ++i)
+      get(i);
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    if(ms < best)
+      best = ms;
+  }
+  return best;
+}
+
+int main(int argc, char **argv)
+{
+  int calls = argc > 1 ? atoi(argv[1]) : 1000000;
+  int runs  = argc > 2 ? atoi(argv[2]) : 20;
+
+  const OfxParameterSuiteV1 *suite = reinterpret_cast<const OfxParameterSuiteV1 *>(OFX::Host::Param::GetSuite(1));
+
+  OFX::Host::Param::Descriptor doubleDescriptor(kOfxParamTypeDouble, "double");
+  OFX::Host::Param::Descriptor rgbaDescriptor(kOfxParamTypeRGBA, "rgba");
+  OFX::Host::Param::Descriptor intDescriptor(kOfxParamTypeInteger, "int");
+  BenchDouble doubleParam(doubleDescriptor);
+  BenchRGBA rgbaParam(rgbaDescriptor);
+  BenchInt intParam(intDescriptor);
+  OfxParamHandle doubleHandle = doubleParam.getHandle();
+  OfxParamHandle rgbaHandle = rgbaParam.getHandle();
+  OfxParamHandle intHandle = intParam.getHandle();
+
+  double sum = 0;
+  double doubleMs = timeCalls(calls, runs, [&](int i) {
+      double v;
+      suite->paramGetValueAtTime(doubleHandle, i, &v);
+      sum += v;
+    });
+  double rgbaMs = timeCalls(calls, runs, [&](int i) {
+      OfxRGBAColourD v;
+      suite->paramGetValueAtTime(rgbaHandle, i, &v.r, &v.g, &v.b, &v.a);
+      sum += v.a;
+    });
+  double intMs = timeCalls(calls, runs, [&](int i) {
+      int v;
+      suite->paramGetValueAtTime(intHandle, i, &v);
+      sum += v;
+    });
+
+  printf("%d paramGetValueAtTime calls, best of %d runs (checksum %g)\n", calls, runs, sum);
+  printf("double %.2f ms, RGBA %.2f ms, int %.2f ms\n", doubleMs, rgbaMs, intMs);
+  return 0;
+}
@@ -0,0 +1,80 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+////////////////////////////////////////////////////////////////////////////////
+/// This example times parametric param evaluation the way a plugin building its
+/// own look up table does, a million getValue calls per frame, with several
+/// threads rendering different frames at once.
+///
+/// parametricBench [threads] [frames] [lutSize]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "ofxhParam.h"
+#include "ofxhParametricParam.h"
+
+static const int kCurves = 3;
+static const int kEvaluationsPerFrame = 1000000;
+
+/// render the frames given to one thread, returns a sum so the calls are not optimised away
+static void renderFrames(OFX::Host::ParametricParam::ParametricInstance *param, int first, int step, int frames, double *sum)
+{
+  double total = 0;
+  for(int frame = first; frame < frames; frame += step) {
+    for(int i = 0; i < kEvaluationsPerFrame; ++i) {
+      double value = 0;
+      param->getValue(i % kCurves, frame, (i & 1023) / 1023., &value);
+      total += value;
+    }
+  }
+  *sum = total;
+}
+
+int main(int argc, char **argv)
+{
+  int nThreads = argc > 1 ? atoi(argv[1]) : int(std::thread::hardware_concurrency());
+  int frames   = argc > 2 ? atoi(argv[2]) : 48;
+  int lutSize  = argc > 3 ? atoi(argv[3]) : 4096;
+  if(nThreads < 1) nThreads = 1;
+
+  OFX::Host::Param::Descriptor descriptor(kOfxParamTypeParametric, "curves");
+  descriptor.getProperties().setIntProperty(kOfxParamPropParametricDimension, kCurves);
+  OFX::Host::Property::PropSpec animates = {kOfxParamPropAnimates, OFX::Host::Property::eInt, 1, false, "1"};
+  descriptor.getProperties().createProperty(animates);
+
+  OFX::Host::ParametricParam::ParametricInstance param(descriptor);
+  param.setLUTSize(lutSize);
+
+  // a few points per curve, each animating so every frame has its own curve
+  for(int c = 0; c < kCurves; ++c) {
+    for(int p = 0; p < 5; ++p) {
+      double key = p / 4.;
+      param.addControlPoint(c, 0, key, key * key, true);
+      param.setNthControlPoint(c, frames, p, key, 1. - key, true);
+    }
+  }
+
+  std::vector<double> sums(nThreads);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  {
+    std::vector<std::thread> threads;
+    for(int t = 0; t < nThreads; ++t)
+      threads.push_back(std::thread(renderFrames, &param, t, nThreads, frames, &sums[t]));
+    for(int t = 0; t < nThreads; ++t)
+      threads[t].join();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  double sum = 0;
+  for(int t = 0; t < nThreads; ++t)
+    sum += sums[t];
+
+  printf("%d threads, %d frames of %d evaluations, LUT size %d\n", nThreads, frames, kEvaluationsPerFrame, lutSize);
+  printf("%.2f ms per frame, %.1f million evaluations a second (checksum %g)\n",
+         seconds * 1000. / frames, double(frames) * kEvaluationsPerFrame / (seconds * 1e6), sum);
+  return 0;
+}
@@ -0,0 +1,143 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef OFXH_ANIMATION_H
+#define OFXH_ANIMATION_H
+
+#include <atomic>
+#include <vector>
+
+//ofx
+#include "ofxCore.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Animation {
+
+      /// how a curve gets from a key to the next one
+      enum InterpolationEnum {
+        eInterpolationConstant,  ///< hold the value of the key until the next key
+        eInterpolationLinear,    ///< straight line to the next key
+        eInterpolationSmooth,    ///< cubic, with catmull-rom style tangents at each key
+        eInterpolationEaseInOut  ///< cubic, with flat tangents at both keys
+      };
+
+      /// An animation curve that param instances can use to hold their values.
+      ///
+      /// A curve has a fixed dimension, one for a double param, four for an RGBA param
+      /// and so on. All dimensions share the same key times, as that is how the
+      /// param suite sets keys.
+      ///
+      /// Keys are kept sorted by time in contiguous arrays, and each key caches the cubic
+      /// polynomial of the segment it starts and the integral of the curve up to it.
+      /// So values, derivatives and integrals are all analytic, and finding the
+      /// segment for a time is a binary search at worst. As renders walk forwards
+      /// through time, the last segment found is cached and checked first, so sequential
+      /// evaluations are O(1).
+      ///
+      /// Before the first key and after the last key the curve holds the value of
+      /// that key, with no keys it holds its default value.
+      class Curve {
+      protected :
+        int                            _dimension;      ///< number of values per key
+        std::vector<double>            _default;        ///< value of the curve when there are no keys
+        std::vector<OfxTime>           _times;          ///< key times, sorted
+        std::vector<double>            _values;         ///< key values, _dimension per key
+        std::vector<InterpolationEnum> _interpolations; ///< interpolation of the segment starting at each key
+        std::vector<double>            _coefficients;   ///< a + b.s + c.s^2 + d.s^3 of the segment starting at each key, 4 * _dimension per key
+        std::vector<double>            _integrals;      ///< integral of the curve from the first key to each key, _dimension per key
+        mutable std::atomic<int>       _hint;           ///< last segment looked up, shared by the threads evaluating the curve
+
+        /// find the segment containing time, which must be within the keys
+        int findSegment(OfxTime time) const;
+
+        /// find the key at the given time, -1 if none
+        int findKey(OfxTime time) const;
+
+        /// get the tangent at the nth key, for smooth interpolation
+        double smoothTangent(int nth, int dim) const;
+
+        /// recalculate the cached coefficients of the segments from first to last
+        /// and the integrals from first onwards, called after the keys are edited
+        void update(int first, int last);
+
+      public :
+        /// ctor
+        explicit Curve(int dimension = 1);
+
+        /// ctor with the value to hold when there are no keys
+        Curve(int dimension, const double *defaultValue);
+
+        /// copy ctor
+        Curve(const Curve &other);
+
+        /// assignment
+        Curve &operator=(const Curve &other);
+
+        /// get the number of values per key
+        int getDimension() const {return _dimension;}
+
+        /// are there any keys
+        bool isAnimating() const {return !_times.empty();}
+
+        /// set the value to hold when there are no keys
+        void setDefault(const double *value);
+
+        /// get the value held when there are no keys
+        const double *getDefault() const {return &_default[0];}
+
+        /// set a key, replacing any key already at that time
+        void setKey(OfxTime time, const double *value, InterpolationEnum interpolation = eInterpolationSmooth);
+
+        /// get the values of the nth key, which must exist
+        const double *getKeyValue(int nth) const {return &_values[nth * _dimension];}
+
+        /// get the interpolation of the segment starting at the nth key, which must exist
+        InterpolationEnum getKeyInterpolation(int nth) const {return _interpolations[nth];}
+
+        /// set the interpolation of the segment starting at the nth key
+        OfxStatus setKeyInterpolation(int nth, InterpolationEnum interpolation);
+
+        /// get the value at the given time, into _dimension doubles
+        void getValue(OfxTime time, double *value) const;
+
+        /// get the values at each of nTimes times, into _dimension doubles per time.
+        /// This walks the segments once for times that are in order, so is the call
+        /// to use when sampling a param over a shutter interval or frame range
+        void getValues(const OfxTime *times, int nTimes, double *values) const;
+
+        /// get the derivative at the given time, into _dimension doubles
+        void getDerivative(OfxTime time, double *value) const;
+
+        /// get the integral between the two times, into _dimension doubles
+        void getIntegral(OfxTime time1, OfxTime time2, double *value) const;
+
+        //
+        // these mirror Param::KeyframeParam, so instances can simply forward to them
+        //
+
+        /// get the number of keys
+        OfxStatus getNumKeys(unsigned int &nKeys) const;
+
+        /// get the time of the nth key
+        OfxStatus getKeyTime(int nth, OfxTime& time) const;
+
+        /// find the key at (direction == 0), after (direction > 0) or before (direction < 0) the given time
+        OfxStatus getKeyIndex(OfxTime time, int direction, int &index) const;
+
+        /// delete the key at the given time
+        OfxStatus deleteKey(OfxTime time);
+
+        /// delete all the keys
+        OfxStatus deleteAllKeys();
+      };
+
+    } // Animation
+
+  } // Host
+
+} // OFX
+
+#endif // OFXH_ANIMATION_H
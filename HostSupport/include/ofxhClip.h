@@ -6,8 +6,12 @@
 #define OFX_CLIP_H
 
 #include "ofxImageEffect.h"
+#include "ofxImageDescriptor.h"
 #include "ofxhUtilities.h"
 
+#include <atomic>
+#include <mutex>
+
 namespace OFX {
 
   namespace Host {
@@ -279,9 +283,32 @@ namespace OFX {
       /// instance of an image inside an image effect
       class ImageBase : public Property::Set {
       protected :
+        /// Hook on kOfxImagePropPackedDescriptor, which packs the other properties into a
+        /// descriptor when the plugin asks for it, so it has whatever the host set on them.
+        /// It is only repacked after one of them is set. Render threads may all ask for it at
+        /// once, so the packing is done under a lock, and only the first of them packs.
+        class PackedDescriptorHook : public Property::GetHook, public Property::NotifyHook {
+          const ImageBase                &_image;
+          mutable OfxImageDescriptorV1    _descriptor;
+          mutable std::atomic<bool>       _packed;     ///< is _descriptor up to date, set with _packMutex held
+          mutable std::mutex              _packMutex;  ///< guards packing _descriptor
+        public :
+          explicit PackedDescriptorHook(const ImageBase &image);
+
+          /// pack the properties of the image if need be and return the descriptor
+          void *getPointerProperty(const std::string &name, int index = 0) const;
+
+          /// a property has been set, so the descriptor needs repacking
+          void notify(const std::string &name, bool singleValue, int indexOrN);
+        };
+
+        /// hook _packedDescriptorHook onto the properties, called by the ctors
+        void hookPackedDescriptor();
+
         /// called during ctors to get bits from the clip props into ours
         void getClipBits(ClipInstance& instance);
         int _referenceCount; ///< reference count on this image
+        PackedDescriptorHook _packedDescriptorHook; ///< packs the image properties for the plugin
 
       public:
         // default constructor
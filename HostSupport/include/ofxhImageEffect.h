@@ -273,6 +273,23 @@ namespace OFX {
       /// a map used to specify needed frame ranges on set of clips
       typedef std::map<ClipInstance *, std::vector<OfxRangeD> > RangeMap;
 
+      /// A param the host has changed, one of a batch reported by Instance::paramsInstanceChangedAction.
+      ///
+      /// Made with the param before the host edits it, this records its content hash, so that if
+      /// the edit leaves it as it was, say a preset setting a param to its current value, the
+      /// plugin is not told. Made with just a name, the change is always reported.
+      struct ParamChange {
+        std::string  name;        ///< name of the param
+        bool         compareHash; ///< only report the change if the hash differs after the edit
+        uint64_t     oldHash;     ///< Param::Instance::getContentHash before the edit
+
+        explicit ParamChange(const std::string &paramName)
+          : name(paramName), compareHash(false), oldHash(0) {}
+
+        explicit ParamChange(Param::Instance &param)
+          : name(param.getName()), compareHash(true), oldHash(param.getContentHash()) {}
+      };
+
       /// an image effect plugin instance.
       ///
       /// Client code needs to filling the pure virtuals in this.
@@ -338,12 +355,22 @@ namespace OFX {
         /// get the output frame rate, as set in the clip prefences action.
         double getOutputFrameRate() const {return _outputFrameRate;}
 
+        /// Get a stable hash of everything about the instance that affects a render at a time,
+        /// which is the plugin, its version, the context and Param::SetInstance::getParamStateHash.
+        /// Hosts can key render caches on it along with the clip inputs and render scale.
+        /// Not thread safe, as it updates the cached parameter hashes.
+        uint64_t getStateHash(OfxTime time);
+
 
         /// called after construction to populate the various members
         /// ideally should be called in the ctor, but it relies on 
         /// virtuals so has to be delayed until after the effect is
         /// constructed
-        OfxStatus populate();
+        ///
+        /// If lazyParams is set, the params are added with Param::SetInstance::addLazyParam,
+        /// so newParam is only called for the ones the plugin or host go on to use, which
+        /// is much faster for effects with many params in batch renders.
+        OfxStatus populate(bool lazyParams = false);
 
         /// get the nth clip, in order of declaration
         ClipInstance* getNthClip(int index);
@@ -524,6 +551,18 @@ namespace OFX {
 
         virtual OfxStatus endInstanceChangedAction(const std::string &why);
 
+        /// Report a batch of param changes, such as loading a preset or pasting values, under a
+        /// single begin/end instance changed bracket, which is much cheaper for many params than
+        /// calling paramInstanceChangedAction for each. Changes that left a param as it was are
+        /// dropped, and if collapseRepeats is set, consecutive changes to the same param are
+        /// reported once. If nothing is left to report, no actions are called. Note that the
+        /// per param actions are called directly, not through paramInstanceChangedAction.
+        virtual OfxStatus paramsInstanceChangedAction(const std::vector<ParamChange> &changes,
+                                                      const std::string &why,
+                                                      OfxTime     time,
+                                                      OfxPointD   renderScale,
+                                                      bool        collapseRepeats = true);
+
         // purge your caches
         virtual OfxStatus purgeCachesAction();
 
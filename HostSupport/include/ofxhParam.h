@@ -8,7 +8,13 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
+#include <memory>
 #include <cstdarg>
+#include <stdint.h>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 
 //ofx
 #include "ofxParam.h"
@@ -26,12 +32,18 @@ namespace OFX {
       /// fetch the param suite
       const void *GetSuite(int version);
 
+      class Journal;
+
       bool isColourParam(const std::string &paramType);
 
       bool isIntParam(const std::string &paramType);
 
       /// is this a standard type
       bool isStandardType(const std::string &type);
+
+      /// FNV-1a hash of some bytes, continuing from a previous hash if given, which unlike
+      /// std::hash is the same from one run to the next, so can key on disk caches
+      uint64_t hashBytes(const void *data, size_t size, uint64_t hash = 14695981039346656037ULL);
       
       /// base class for all params
       class Base {
@@ -165,8 +177,35 @@ namespace OFX {
       class Instance : public Base, protected Property::NotifyHook {
         Instance();  
       protected:
-        SetInstance*  _paramSetInstance;
-        Instance*     _parentInstance;
+        SetInstance*        _paramSetInstance;
+        Instance*           _parentInstance;
+      public:
+        /// which of the typed int and double instances a param is, eValueNone for any other param
+        enum ValueKindEnum {
+          eValueNone,
+          eValueInteger,
+          eValueChoice,
+          eValueBoolean,
+          eValueInteger2D,
+          eValueInteger3D,
+          eValueDouble,
+          eValueDouble2D,
+          eValueDouble3D,
+          eValueRGB,
+          eValueRGBA
+        };
+      protected:
+        ValueKindEnum       _valueKind;       ///< which typed instance this is, set by its constructor
+
+        /// called by the typed instances' constructors
+        void setValueKind(ValueKindEnum valueKind) {_valueKind = valueKind;}
+
+        // state hashing, managed by the owning SetInstance
+        friend class SetInstance;
+        uint64_t            _hashName;        ///< hash of the param's name, so equal values in different params hash apart
+        uint64_t            _hashStatic;      ///< what this param adds to its set's static hash
+        bool                _hashTimed;       ///< is it in its set's list of params hashed at each time
+        bool                _hashDirty;       ///< is it in its set's list of params to rehash, guarded by the set's _hashDirtyMutex
       public:
         virtual ~Instance();
 
@@ -230,6 +269,66 @@ namespace OFX {
         /// integrate a value, implemented by instances to deconstruct var args
         virtual OfxStatus integrateV(OfxTime time1, OfxTime time2, va_list arg);
 
+        // typed calls below get and set all the values of an int or double
+        // param through one pointer, so the state hashing and the change
+        // journal can handle any such param without knowing its type. They
+        // switch on the param's value kind and call the typed instance's get
+        // or set, so they are not to be overridden. The param suite keeps
+        // to the var args calls above, which measured no slower
+
+        /// which typed instance this param is
+        ValueKindEnum getValueKind() const {return _valueKind;}
+
+        /// eInt or eDouble if the typed gets work on this param, eNone if only the var args calls do
+        Property::TypeEnum getValueType() const;
+
+        /// number of values the typed gets take
+        int getValueDimension() const;
+
+        /// get the n values of an int, boolean, choice or integer 2D/3D param
+        OfxStatus getInt(int *values, int n);
+
+        /// get the n values of an int, boolean, choice or integer 2D/3D param at a time
+        OfxStatus getInt(OfxTime time, int *values, int n);
+
+        /// get the n values of a double, colour or double 2D/3D param
+        OfxStatus getDouble(double *values, int n);
+
+        /// get the n values of a double, colour or double 2D/3D param at a time
+        OfxStatus getDouble(OfxTime time, double *values, int n);
+
+        /// set the n values of an int, boolean, choice or integer 2D/3D param
+        OfxStatus setInt(const int *values, int n);
+
+        /// set the n values of an int, boolean, choice or integer 2D/3D param at a time
+        OfxStatus setInt(OfxTime time, const int *values, int n);
+
+        /// set the n values of a double, colour or double 2D/3D param
+        OfxStatus setDouble(const double *values, int n);
+
+        /// set the n values of a double, colour or double 2D/3D param at a time
+        OfxStatus setDouble(OfxTime time, const double *values, int n);
+
+        /// Tell the owning set the param's value, keys or render relevant properties have
+        /// changed, so its state hash needs recomputing. The param suite calls this on the
+        /// plugin's edits, and ImageEffect::Instance::paramInstanceChangedAction and
+        /// paramsInstanceChangedAction on the host's. Hosts that change a param without
+        /// reporting it need to call it themselves.
+        virtual void invalidateHash();
+
+        /// Does the param's state hash depend on the time. The default is true if the param
+        /// has keys and its kOfxParamPropCacheInvalidation is kOfxParamInvalidateValueChange,
+        /// as then a change only invalidates renders at the times whose value changed.
+        virtual bool getHashIsTimed();
+
+        /// Hash of the param's value at a time, used for timed params. The default hashes what
+        /// the typed gets or a string get return, hosts with a cheaper way can override this.
+        virtual uint64_t getValueHash(OfxTime time);
+
+        /// Hash of the param's entire state, used for params that aren't timed. The default
+        /// hashes the value if there are no keys, else the time and value of each key.
+        virtual uint64_t getContentHash();
+
         /// overridden from Property::NotifyHook
         virtual void notify(const std::string &name, bool single, int num);
       };
@@ -248,11 +347,13 @@ namespace OFX {
 
       class GroupInstance : public Instance {
       protected:
-        std::vector<Param::Instance*> _children;
+        mutable std::vector<Param::Instance*> _children; // mutable so lazily made sets can find them on demand
       public:
         GroupInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {}
 
         void setChildren(std::vector<Param::Instance*> children);
+
+        /// get the children, if they weren't set, they are found from the set's params parented to this
         const std::vector<Param::Instance*> &getChildren() const;
       };
 
@@ -266,7 +367,7 @@ namespace OFX {
 
       class IntegerInstance : public Instance, public KeyframeParam {
       public:
-        IntegerInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {}
+        IntegerInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {setValueKind(eValueInteger);}
 
         // Deriving implementatation needs to overide these 
         virtual OfxStatus get(int&) = 0;
@@ -278,6 +379,11 @@ namespace OFX {
         virtual OfxStatus derive(OfxTime time, int&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, int&) ;
 
+        /// get the values at each of nTimes times, one value per time, into values.
+        /// The default calls get(time, ...) for each time, hosts with a curve engine should override this.
+        /// It is for the host's own code, the param suite has no batch call to reach it from plugins
+        virtual OfxStatus getAtTimes(const OfxTime *times, int nTimes, int *values);
+
         /// implementation of var args function
         virtual OfxStatus getV(va_list arg);
 
@@ -328,7 +434,7 @@ namespace OFX {
 
       class DoubleInstance : public Instance, public KeyframeParam {
       public:
-        DoubleInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {}
+        DoubleInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {setValueKind(eValueDouble);}
 
         // Deriving implementatation needs to overide these 
         virtual OfxStatus get(double&) = 0;
@@ -338,6 +444,11 @@ namespace OFX {
         virtual OfxStatus derive(OfxTime time, double&) = 0;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&) = 0;
 
+        /// get the values at each of nTimes times, one value per time, into values.
+        /// The default calls get(time, ...) for each time, hosts with a curve engine should override this.
+        /// It is for the host's own code, the param suite has no batch call to reach it from plugins
+        virtual OfxStatus getAtTimes(const OfxTime *times, int nTimes, double *values);
+
         /// implementation of var args function
         virtual OfxStatus getV(va_list arg);
 
@@ -359,7 +470,7 @@ namespace OFX {
 
       class BooleanInstance : public Instance, public KeyframeParam {
       public:
-        BooleanInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {}
+        BooleanInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {setValueKind(eValueBoolean);}
 
         // Deriving implementatation needs to overide these
         virtual OfxStatus get(bool&) = 0;
@@ -382,7 +493,7 @@ namespace OFX {
 
       class RGBAInstance : public Instance, public KeyframeParam {
       public:
-        RGBAInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {}
+        RGBAInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {setValueKind(eValueRGBA);}
 
         // Deriving implementatation needs to overide these
         virtual OfxStatus get(double&,double&,double&,double&) = 0;
@@ -394,6 +505,11 @@ namespace OFX {
         virtual OfxStatus derive(OfxTime time, double&,double&,double&,double&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&,double&,double&) ;
 
+        /// get the values at each of nTimes times, 4 values per time, into values.
+        /// The default calls get(time, ...) for each time, hosts with a curve engine should override this.
+        /// It is for the host's own code, the param suite has no batch call to reach it from plugins
+        virtual OfxStatus getAtTimes(const OfxTime *times, int nTimes, double *values);
+
         /// implementation of var args function
         virtual OfxStatus getV(va_list arg);
 
@@ -415,7 +531,7 @@ namespace OFX {
 
       class RGBInstance : public Instance, public KeyframeParam {
       public:
-        RGBInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {}
+        RGBInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {setValueKind(eValueRGB);}
 
         // Deriving implementatation needs to overide these
         virtual OfxStatus get(double&,double&,double&) = 0;
@@ -427,6 +543,11 @@ namespace OFX {
         virtual OfxStatus derive(OfxTime time, double&,double&,double&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&,double&) ;
 
+        /// get the values at each of nTimes times, 3 values per time, into values.
+        /// The default calls get(time, ...) for each time, hosts with a curve engine should override this.
+        /// It is for the host's own code, the param suite has no batch call to reach it from plugins
+        virtual OfxStatus getAtTimes(const OfxTime *times, int nTimes, double *values);
+
         /// implementation of var args function
         virtual OfxStatus getV(va_list arg);
 
@@ -448,7 +569,7 @@ namespace OFX {
         
       class Double2DInstance : public Instance, public KeyframeParam {
       public:
-        Double2DInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {}
+        Double2DInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {setValueKind(eValueDouble2D);}
 
         // Deriving implementatation needs to overide these
         virtual OfxStatus get(double&,double&) = 0;
@@ -460,6 +581,11 @@ namespace OFX {
         virtual OfxStatus derive(OfxTime time, double&,double&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&) ;
 
+        /// get the values at each of nTimes times, 2 values per time, into values.
+        /// The default calls get(time, ...) for each time, hosts with a curve engine should override this.
+        /// It is for the host's own code, the param suite has no batch call to reach it from plugins
+        virtual OfxStatus getAtTimes(const OfxTime *times, int nTimes, double *values);
+
         /// implementation of var args function
         virtual OfxStatus getV(va_list arg);
 
@@ -481,7 +607,7 @@ namespace OFX {
 
       class Integer2DInstance : public Instance, public KeyframeParam {
       public:
-        Integer2DInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {}
+        Integer2DInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {setValueKind(eValueInteger2D);}
 
         // Deriving implementatation needs to overide these
         virtual OfxStatus get(int&,int&) = 0;
@@ -493,6 +619,11 @@ namespace OFX {
         virtual OfxStatus derive(OfxTime time, int&,int&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, int&,int&) ;
 
+        /// get the values at each of nTimes times, 2 values per time, into values.
+        /// The default calls get(time, ...) for each time, hosts with a curve engine should override this.
+        /// It is for the host's own code, the param suite has no batch call to reach it from plugins
+        virtual OfxStatus getAtTimes(const OfxTime *times, int nTimes, int *values);
+
         /// implementation of var args function
         virtual OfxStatus getV(va_list arg);
 
@@ -514,7 +645,7 @@ namespace OFX {
 
       class Double3DInstance : public Instance , public KeyframeParam{
       public:
-        Double3DInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {}
+        Double3DInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {setValueKind(eValueDouble3D);}
 
         // Deriving implementatation needs to overide these
         virtual OfxStatus get(double&,double&,double&)  = 0;
@@ -526,6 +657,11 @@ namespace OFX {
         virtual OfxStatus derive(OfxTime time, double&,double&,double&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&,double&) ;
 
+        /// get the values at each of nTimes times, 3 values per time, into values.
+        /// The default calls get(time, ...) for each time, hosts with a curve engine should override this.
+        /// It is for the host's own code, the param suite has no batch call to reach it from plugins
+        virtual OfxStatus getAtTimes(const OfxTime *times, int nTimes, double *values);
+
         /// implementation of var args function
         virtual OfxStatus getV(va_list arg);
 
@@ -547,7 +683,7 @@ namespace OFX {
 
       class Integer3DInstance : public Instance, public KeyframeParam {
       public:
-        Integer3DInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {}
+        Integer3DInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : Instance(descriptor,instance) {setValueKind(eValueInteger3D);}
 
         virtual OfxStatus get(int&,int&,int&) = 0;
         virtual OfxStatus get(OfxTime time, int&,int&,int&) = 0;
@@ -558,6 +694,11 @@ namespace OFX {
         virtual OfxStatus derive(OfxTime time, int&,int&,int&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, int&,int&,int&) ;
 
+        /// get the values at each of nTimes times, 3 values per time, into values.
+        /// The default calls get(time, ...) for each time, hosts with a curve engine should override this.
+        /// It is for the host's own code, the param suite has no batch call to reach it from plugins
+        virtual OfxStatus getAtTimes(const OfxTime *times, int nTimes, int *values);
+
         /// implementation of var args function
         virtual OfxStatus getV(va_list arg);
 
@@ -604,9 +745,55 @@ namespace OFX {
         virtual OfxStatus setV(OfxTime time, va_list arg);
       };
 
+      /// A custom param instance.
+      ///
+      /// Host implementations of get(time, value) on animated custom params find the keys either
+      /// side of the time and call getInterpolatedValue, which calls the plugin's
+      /// kOfxParamPropCustomInterpCallbackV1. As that means the plugin parsing and reformatting
+      /// both keys, the results are cached, keyed on the time and a generation count of the
+      /// keys, which invalidateHash bumps. The cache holds a bounded number of times, and
+      /// threads asking for a time another thread is already interpolating wait for its
+      /// result rather than calling the plugin again.
       class CustomInstance : public StringInstance {
+      protected:
+        /// an interpolated value, or one being interpolated if pending
+        struct InterpolatedValue {
+          OfxTime      time;
+          unsigned int generation;
+          bool         pending;
+          std::string  value;
+        };
+
+        std::vector<InterpolatedValue> _interpCache;      ///< cached results, up to _interpCacheSize
+        size_t                         _interpCacheSize;  ///< max number of cached results
+        size_t                         _interpCacheNext;  ///< next entry to replace once the cache is full
+        unsigned int                   _keyGeneration;    ///< bumped each time the keys change
+        std::mutex                     _interpMutex;      ///< guards all the above
+        std::condition_variable        _interpReady;      ///< signalled as pending results complete
+
+        /// call the plugin's interpolation callback
+        OfxStatus callInterpolation(OfxTime time,
+                                    OfxTime time1, const std::string &value1,
+                                    OfxTime time2, const std::string &value2,
+                                    double amount, std::string &value);
+
       public:
-        CustomInstance(Descriptor& descriptor, Param::SetInstance* instance = 0) : StringInstance(descriptor,instance) {}
+        CustomInstance(Descriptor& descriptor, Param::SetInstance* instance = 0);
+
+        /// Get the value at a time between two keys by calling the plugin's interpolation callback,
+        /// or the cache. amount is how far between the keys to go, which is for the host to derive
+        /// from the time, and must be the same whenever the keys are. Returns kOfxStatErrUnsupported
+        /// if the plugin has no callback.
+        OfxStatus getInterpolatedValue(OfxTime time,
+                                       OfxTime time1, const std::string &value1,
+                                       OfxTime time2, const std::string &value2,
+                                       double amount, std::string &value);
+
+        /// set the max number of interpolated values cached, 0 to not cache, the default is 64
+        void setInterpolationCacheSize(int size);
+
+        /// also drops the cached interpolated values, so must be called whenever the keys change
+        virtual void invalidateHash();
       };
 
       class PushbuttonInstance : public Instance, public KeyframeParam {
@@ -619,11 +806,47 @@ namespace OFX {
       /// As we are the owning object we delete the params inside ourselves. It was tempting
       /// to make params autoref objects and have shared ownership with the client code
       /// but that adds complexity for no strong gain.
+      ///
+      /// The set also keeps a hash of the render state of its params, for hosts to key render
+      /// caches on, see getParamStateHash.
+      ///
+      /// Params can also be added lazily, as just their descriptor, in which case newParam is
+      /// only called for them when they are first asked for, see addLazyParam. So a set with
+      /// hundreds of params, of which a batch render only reads a few, only makes those few.
       class SetInstance : public BaseSet {
       protected:
         std::map<std::string, Instance*> _params;        ///< params by name
         std::list<Instance *>            _paramList;     ///< params list
 
+        std::map<std::string, Descriptor*> _lazyParams;    ///< descriptors of params added lazily but not made yet
+        std::vector<std::string>           _paramOrder;    ///< names of all the params in the order added, if any were lazy
+        std::atomic<bool>                  _hasLazyParams; ///< are any params not made yet, if not the above, _params and _paramList only change on the set's own thread
+        mutable std::recursive_mutex       _lazyMutex;     ///< guards making params on demand, recursive as newParam may fetch other params
+
+        std::vector<Instance*>           _hashDirtyParams; ///< params changed since the hash was last asked for
+        std::mutex                       _hashDirtyMutex;  ///< guards _hashDirtyParams, as params are changed from any thread
+        std::vector<Instance*>           _hashTimedParams; ///< params hashed by their value at the time asked for
+        uint64_t                         _hashStatic;      ///< sum of the hashes of all other params
+        bool                             _hashCached;      ///< is the below valid
+        OfxTime                          _hashCachedTime;  ///< time of the last hash asked for
+        uint64_t                         _hashCachedValue; ///< the last hash asked for
+
+        std::unique_ptr<Journal>         _journal;         ///< log of changes, if journalling
+
+        friend class Instance;
+
+        /// queue a param to be rehashed, from any thread
+        void paramHashChanged(Instance *param);
+
+        /// make the lazy param with the given name, call with _lazyMutex held
+        OfxStatus makeLazyParam(const std::string &name, Instance *&instance) const;
+
+        /// rebuild the list once no params are lazy, then clear _hasLazyParams, call with _lazyMutex held
+        void finishLazyParams() const;
+
+        /// take a param being deleted out of the hash
+        void paramHashRemoved(Instance *param);
+
       public :
         /// ctor
         ///
@@ -634,14 +857,19 @@ namespace OFX {
         /// dtor. 
         virtual ~SetInstance();
 
-        /// get the params
+        /// get the params, which makes any lazy params
         const std::map<std::string, Instance*> &getParams() const;
 
-        /// get the params
+        /// get the params, which makes any lazy params
         const std::list<Instance*> &getParamList() const;
 
-        // get the param
+        // get the param, making it if it was added lazily
         Instance* getParam(const std::string &name) const {
+          if(_hasLazyParams.load(std::memory_order_acquire)) {
+            Instance *instance = 0;
+            fetchParam(name, instance);
+            return instance;
+          }
           std::map<std::string,Instance*>::const_iterator it = _params.find(name);
           if(it!=_params.end())
             return it->second;
@@ -649,6 +877,34 @@ namespace OFX {
             return 0;
         }
 
+        /// Get the param, making it if it was added lazily, which can be done from any thread.
+        /// Returns kOfxStatErrUnknown if there is no such param, and kOfxStatFailed if newParam
+        /// failed to make it, in which case it is tried again the next time it is asked for.
+        OfxStatus fetchParam(const std::string &name, Instance *&instance) const;
+
+        /// Add a param that is made by newParam the first time it is asked for, by getParam or
+        /// the plugin fetching its handle, rather than now. The descriptor must outlive the set.
+        /// Until it is made a param is at its default, and isn't part of getParamStateHash.
+        OfxStatus addLazyParam(const std::string& name, Descriptor& descriptor);
+
+        /// Make all the lazy params. Any that newParam fails on are dropped, so afterwards no params
+        /// are lazy and getParams and getParamList hold still for callers on any thread.
+        void makeLazyParams() const;
+
+        /// Get the params whose parent is the named group, in the order they were added, making
+        /// any of them that are lazy but leaving the set's other lazy params alone.
+        std::vector<Instance*> fetchChildParams(const std::string &groupName) const;
+
+        /// is the named param lazy and not made yet
+        bool isLazyParam(const std::string &name) const;
+
+        /// Turn on or off logging the changes made to the params, for undo, see Journal.
+        /// Turning it off discards the log.
+        void setJournalling(bool journalling, size_t checkpointInterval = 1024);
+
+        /// get the log of changes, NULL unless journalling
+        Journal *getJournal() const {return _journal.get();}
+
         /// The inheriting plugin instance needs to set this up to deal with 
         /// plug-ins changing their own values.
         virtual void paramChangedByPlugin(Param::Instance *param) = 0;
@@ -656,6 +912,14 @@ namespace OFX {
         /// add a param
         virtual OfxStatus addParam(const std::string& name, Instance* instance);
 
+        /// Get a stable hash of the render state of all the params at a time, which is the
+        /// same whenever the params would render the same. Params with kOfxParamPropEvaluateOnChange
+        /// off are left out. Timed params (see Instance::getHashIsTimed) add their value at the
+        /// time, all others add a hash of their entire state that is cached until they change.
+        /// So this costs the number of changed and timed params, not the number of params.
+        /// Params can be changed from any thread, but call this from only one at a time.
+        uint64_t getParamStateHash(OfxTime time);
+
         /// make a parameter instance
         ///
         /// Client host code needs to implement this
@@ -0,0 +1,173 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef OFXH_PARAM_JOURNAL_H
+#define OFXH_PARAM_JOURNAL_H
+
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+//ofx
+#include "ofxCore.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Param {
+
+      class Instance;
+
+      /// A compact log of the changes made to the params of a set, for undo and redo.
+      ///
+      /// Rather than keep a copy of a param for every change, the journal appends each
+      /// change to a byte log, with ints stored as the varint of their difference from the
+      /// param's last logged value and doubles as the XOR of their bits with it, which is
+      /// mostly zero bytes for the small edits of an interactive session. So a change is a
+      /// handful of bytes. Strings are stored whole.
+      ///
+      /// Every so often the journal takes a checkpoint, a snapshot of all the params it has
+      /// seen. Moving to any position in the log restores the last checkpoint before it in
+      /// one go, then replays the changes from there, so costs at most a checkpoint interval
+      /// of changes however long the log is.
+      ///
+      /// Changes between paramEditBegin and paramEditEnd form a single block, which undo and
+      /// redo step over as one. Changes outside a block are blocks of their own.
+      ///
+      /// The param suite logs the plugin's edits. Hosts log their own by calling aboutToChange
+      /// before and one of the record calls after. Once the position has been moved back, the
+      /// next change discards the log after it, as with any undo stack.
+      ///
+      /// Int, double, boolean, choice, colour, string and custom params are logged, others
+      /// are ignored. A param's state is what the typed gets and keyframe calls return, so
+      /// anything else a host keeps on a param, such as a value held under its keys that
+      /// reappears when they are deleted, is not restored.
+      class Journal {
+      public :
+        /// what a log entry does
+        enum EntryEnum {
+          eEntryValue,          ///< set the value
+          eEntryKey,            ///< set a key
+          eEntryDeleteKey,      ///< delete a key
+          eEntryDeleteAllKeys,  ///< delete all the keys
+          eEntryState           ///< set the value and all the keys
+        };
+
+      protected :
+        /// a snapshot of all the params at a position
+        struct Checkpoint {
+          size_t                       position; ///< entries before it
+          size_t                       offset;   ///< bytes of log before it
+          std::vector<unsigned char>   state;    ///< an eEntryState for each param
+        };
+
+        /// what deltas in the log are relative to for one param
+        struct Base {
+          std::vector<uint64_t>  values;  ///< bits of the last value logged
+          uint64_t               time;    ///< bits of the last time logged
+
+          Base() : time(0) {}
+        };
+
+        size_t                          _checkpointInterval; ///< entries between checkpoints
+
+        std::vector<Instance*>          _params;      ///< the params seen, by their index in the log
+        std::map<Instance*, unsigned>   _indices;     ///< index of each param seen
+
+        std::vector<unsigned char>      _log;         ///< the entries
+        size_t                          _size;        ///< number of entries in the log
+        size_t                          _position;    ///< number of entries applied
+        size_t                          _offset;      ///< bytes of log applied
+        std::vector<Base>               _bases;       ///< deltas as of _position, by param index
+
+        std::vector<Checkpoint>         _checkpoints; ///< in position order, the first is at 0
+        std::vector<size_t>             _blockEnds;   ///< positions that end a block, in order
+        int                             _blockDepth;  ///< nesting of beginBlock
+
+        /// index of a param, or -1 if it isn't logged
+        int getIndex(Instance &param);
+
+        /// start an entry, discarding any log after the position
+        void beginEntry(EntryEnum kind, int index);
+
+        /// finish an entry
+        void endEntry();
+
+        /// append the value of a param, at a time or the current one if time is NULL
+        void writeValue(std::vector<unsigned char> &out, Instance &param, const OfxTime *time, Base &base);
+
+        /// append the whole state of a param
+        void writeState(std::vector<unsigned char> &out, Instance &param);
+
+        /// apply the entry at data, returning the param it changed
+        Instance *applyEntry(const unsigned char *&data);
+
+        /// apply a param's value at data, at a time or the current one if time is NULL
+        void applyValue(const unsigned char *&data, Instance &param, const OfxTime *time, Base &base);
+
+        /// apply a param's whole state at data
+        void applyState(const unsigned char *&data, Instance &param);
+
+      public :
+        /// ctor, taking a checkpoint of the params seen every checkpointInterval changes
+        explicit Journal(size_t checkpointInterval = 1024);
+
+        /// call before changing a param, so the journal has its state from before the change
+        void aboutToChange(Instance &param);
+
+        /// log a param's new value
+        void recordValue(Instance &param);
+
+        /// log a key set on a param at a time
+        void recordKey(Instance &param, OfxTime time);
+
+        /// log the deletion of a key
+        void recordDeleteKey(Instance &param, OfxTime time);
+
+        /// log the deletion of all a param's keys
+        void recordDeleteAllKeys(Instance &param);
+
+        /// log the whole state of a param, for changes that don't fit the above, such as a copy
+        void recordState(Instance &param);
+
+        /// start a block of changes, blocks nest
+        void beginBlock();
+
+        /// end a block of changes
+        void endBlock();
+
+        /// take a checkpoint at the position now, which must be the end of the log
+        void checkpoint();
+
+        /// number of changes applied
+        size_t getPosition() const {return _position;}
+
+        /// number of changes logged
+        size_t getSize() const {return _size;}
+
+        /// Move to the given position, by restoring the last checkpoint before it and replaying
+        /// the changes since. If changed is given, it is filled with the params whose content
+        /// hash differs afterwards, for the host to pass on to the plugin.
+        OfxStatus setPosition(size_t position, std::vector<Instance*> *changed = 0);
+
+        /// move back to the start of the block before the position, false if there is none
+        bool undo(std::vector<Instance*> *changed = 0);
+
+        /// move on to the end of the block after the position, false if there is none
+        bool redo(std::vector<Instance*> *changed = 0);
+
+        /// bytes used by the log, checkpoints and tables
+        size_t getMemoryUsage() const;
+
+        /// forget everything logged
+        void clear();
+      };
+
+    } // Param
+
+  } // Host
+
+} // OFX
+
+#endif // OFXH_PARAM_JOURNAL_H
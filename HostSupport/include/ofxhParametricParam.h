@@ -0,0 +1,169 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef OFXH_PARAMETRIC_PARAM_H
+#define OFXH_PARAMETRIC_PARAM_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+//ofx
+#include "ofxParametricParam.h"
+
+//ofxh
+#include "ofxhParam.h"
+#include "ofxhAnimation.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace ParametricParam {
+
+      /// fetch the parametric param suite
+      const void *GetSuite(int version);
+
+      /// A parametric param instance, which hosts can make in Param::SetInstance::newParam
+      /// for params of kOfxParamTypeParametric, or derive from to hook the edits into their UI.
+      ///
+      /// Each of the kOfxParamPropParametricDimension curves is a list of control points.
+      /// Each control point is a two dimensional Animation::Curve over time of its key and
+      /// value, so points animate independently. At a given time the curve is a smooth
+      /// Animation::Curve through the points, flat beyond the first and last points, and
+      /// the identity if there are none. The points a plugin set on the descriptor are the
+      /// initial points of the instance.
+      ///
+      /// As evaluating means building the curve through the points, the curves at the last
+      /// few times asked for are cached, so renders of different frames at once do not keep
+      /// rebuilding them. If the host sets a LUT size, each cached curve is also baked into a
+      /// table over kOfxParamPropParametricRange, and getValue within the range is then a
+      /// lookup and a lerp, which is what plugins building their own look up tables by calling
+      /// parametricParamGetValue many times per frame want. Cached curves are never changed
+      /// once made, and each thread remembers the last few it used along with the generation
+      /// of the instance they were made at, so getValue on them takes no lock, only a curve
+      /// the thread has not used since the last edit goes through the instance's mutex.
+      ///
+      /// Control points are numbered in key order as of the last edit, by all the calls, so
+      /// the nth point is the same point whatever the time, even if animated points pass
+      /// each other.
+      ///
+      /// All the calls are safe to make from several threads, apart from the state hashing
+      /// calls, which like the rest of the hashing are only for the thread owning the set.
+      class ParametricInstance : public Param::Instance {
+      protected :
+        /// number of times each curve is cached at
+        static const int kCachedTimes = 8;
+
+        /// a curve at one time, with its baked LUT, not changed once made
+        struct CurveCache {
+          OfxTime              time;
+          Animation::Curve     curve;
+          std::vector<double>  lut;
+          double               lutMin;
+          double               lutScale;
+
+          CurveCache() : time(0), lutMin(0), lutScale(0) {}
+        };
+
+        /// the cached times of a curve
+        struct CurveCaches {
+          std::shared_ptr<const CurveCache> entries[kCachedTimes];
+          int                               next;  ///< entry to replace next
+
+          CurveCaches() : next(0) {}
+        };
+
+        /// a curve a thread used last, checked against the generation of its instance before use
+        struct ThreadCache {
+          const ParametricInstance         *owner;
+          uint64_t                          generation;
+          int                               curveIndex;
+          OfxTime                           time;
+          std::shared_ptr<const CurveCache> cache;
+
+          ThreadCache() : owner(0), generation(0), curveIndex(0), time(0) {}
+        };
+
+        /// number of curves each thread remembers
+        static const int kThreadCaches = 4;
+
+        /// the curves this thread used last, over all instances
+        static thread_local ThreadCache _threadCaches[kThreadCaches];
+
+        std::vector<std::vector<Animation::Curve> > _controlPoints; ///< the points of each curve, in key order as of the last edit
+        std::vector<CurveCaches>                    _caches;        ///< one per curve
+        int                                         _lutSize;       ///< number of LUT entries, 0 for none
+        std::atomic<uint64_t>                       _generation;    ///< unique over all instances, changed by every edit
+        mutable std::mutex                          _mutex;         ///< guards all the above, apart from reading the generation
+
+        /// get the key and value of the points of a curve at a time, sorted by key, with the index of each in _controlPoints
+        void getControlPoints(int curveIndex, OfxTime time, std::vector<double> &keys, std::vector<double> &values, std::vector<int> &indices) const;
+
+        /// set a point, keying it if asked to or if it is already animating, call with the mutex held
+        void setControlPoint(Animation::Curve &point, OfxTime time, double key, double value, bool addAnimationKey);
+
+        /// put the points of a curve back in key order and drop its caches, call with the mutex held
+        void controlPointsChanged(int curveIndex, OfxTime time);
+
+        /// drop the cached times of a curve and move to a new generation, call with the mutex held
+        void clearCaches(int curveIndex);
+
+        /// get the curve at a time, from the cache if it is there, otherwise made and cached, call
+        /// without the mutex held, the reference is good until the thread's next call
+        const CurveCache &fetchCache(int curveIndex, OfxTime time);
+
+      public :
+        /// ctor, picks up the dimension and default points from the descriptor
+        ParametricInstance(Param::Descriptor& descriptor, Param::SetInstance* setInstance = 0);
+
+        /// number of curves
+        int getCurveCount() const {return int(_controlPoints.size());}
+
+        /// Set the number of entries in the LUT baked for each curve, 0 (the default) to always
+        /// evaluate the curve exactly. A few thousand entries is indistinguishable from the
+        /// curve for 8 and 16 bit look up tables.
+        void setLUTSize(int size);
+
+        /// get the number of entries in the LUT baked for each curve
+        int getLUTSize() const;
+
+        /// evaluate a curve
+        virtual OfxStatus getValue(int curveIndex, OfxTime time, double parametricPosition, double *returnValue);
+
+        /// get the number of control points on a curve
+        virtual OfxStatus getNControlPoints(int curveIndex, OfxTime time, int *returnValue);
+
+        /// get the key and value of the nth control point of a curve at the time
+        virtual OfxStatus getNthControlPoint(int curveIndex, OfxTime time, int nthCtl, double *key, double *value);
+
+        /// modify the nth control point of a curve at the time
+        virtual OfxStatus setNthControlPoint(int curveIndex, OfxTime time, int nthCtl, double key, double value, bool addAnimationKey);
+
+        /// add a control point to a curve, or set the one sufficiently close to key
+        virtual OfxStatus addControlPoint(int curveIndex, OfxTime time, double key, double value, bool addAnimationKey);
+
+        /// delete the nth control point of a curve
+        virtual OfxStatus deleteControlPoint(int curveIndex, int nthCtl);
+
+        /// delete all the control points of a curve
+        virtual OfxStatus deleteAllControlPoints(int curveIndex);
+
+        /// the hash is timed if any point is animating and the param invalidates on value changes
+        virtual bool getHashIsTimed();
+
+        /// hash of the points of all the curves at a time
+        virtual uint64_t getValueHash(OfxTime time);
+
+        /// hash of the defaults and keys of all the points of all the curves
+        virtual uint64_t getContentHash();
+      };
+
+    } // ParametricParam
+
+  } // Host
+
+} // OFX
+
+#endif // OFXH_PARAMETRIC_PARAM_H
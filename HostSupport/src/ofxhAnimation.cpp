@@ -0,0 +1,394 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <algorithm>
+#include <math.h>
+
+// ofx
+#include "ofxCore.h"
+
+// ofx host
+#include "ofxhAnimation.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Animation {
+
+      /// keys closer than this are at the same time, see OfxParameterSuiteV1::paramGetKeyIndex
+      static const double kKeyTimeTolerance = 1e-6;
+
+      /// ctor
+      Curve::Curve(int dimension)
+        : _dimension(dimension)
+        , _default(dimension, 0.)
+        , _hint(0)
+      {
+      }
+
+      /// ctor with the value to hold when there are no keys
+      Curve::Curve(int dimension, const double *defaultValue)
+        : _dimension(dimension)
+        , _default(defaultValue, defaultValue + dimension)
+        , _hint(0)
+      {
+      }
+
+      /// copy ctor
+      Curve::Curve(const Curve &other)
+        : _dimension(other._dimension)
+        , _default(other._default)
+        , _times(other._times)
+        , _values(other._values)
+        , _interpolations(other._interpolations)
+        , _coefficients(other._coefficients)
+        , _integrals(other._integrals)
+        , _hint(0)
+      {
+      }
+
+      /// assignment, the hint is just dropped as it is only ever a guess
+      Curve &Curve::operator=(const Curve &other)
+      {
+        _dimension = other._dimension;
+        _default = other._default;
+        _times = other._times;
+        _values = other._values;
+        _interpolations = other._interpolations;
+        _coefficients = other._coefficients;
+        _integrals = other._integrals;
+        _hint.store(0, std::memory_order_relaxed);
+        return *this;
+      }
+
+      /// set the value to hold when there are no keys
+      void Curve::setDefault(const double *value)
+      {
+        std::copy(value, value + _dimension, _default.begin());
+      }
+
+      /// find the segment containing time, which must be within the keys
+      int Curve::findSegment(OfxTime time) const
+      {
+        int nSegments = int(_times.size()) - 1;
+
+        // the hint may have been left by another thread, so check it is sane before trusting it
+        int hint = _hint.load(std::memory_order_relaxed);
+        if(hint >= 0 && hint < nSegments && _times[hint] <= time) {
+          if(time < _times[hint + 1])
+            return hint;
+          // sequential renders will usually have just stepped into the next segment
+          if(hint + 1 < nSegments && time < _times[hint + 2]) {
+            _hint.store(hint + 1, std::memory_order_relaxed);
+            return hint + 1;
+          }
+        }
+
+        int segment = int(std::upper_bound(_times.begin(), _times.end(), time) - _times.begin()) - 1;
+        _hint.store(segment, std::memory_order_relaxed);
+        return segment;
+      }
+
+      /// find the key at the given time, -1 if none
+      int Curve::findKey(OfxTime time) const
+      {
+        std::vector<OfxTime>::const_iterator it = std::lower_bound(_times.begin(), _times.end(), time - kKeyTimeTolerance);
+        if(it != _times.end() && fabs(*it - time) <= kKeyTimeTolerance)
+          return int(it - _times.begin());
+        return -1;
+      }
+
+      /// get the tangent at the nth key, for smooth interpolation
+      double Curve::smoothTangent(int nth, int dim) const
+      {
+        int nKeys = int(_times.size());
+        if(nKeys < 2)
+          return 0.;
+
+        // one sided at the ends, centred elsewhere
+        int prev = std::max(nth - 1, 0);
+        int next = std::min(nth + 1, nKeys - 1);
+        return (_values[next * _dimension + dim] - _values[prev * _dimension + dim]) / (_times[next] - _times[prev]);
+      }
+
+      /// recalculate the cached coefficients of the segments from first to last
+      /// and the integrals from first onwards, called after the keys are edited
+      void Curve::update(int first, int last)
+      {
+        int nKeys = int(_times.size());
+        if(nKeys == 0)
+          return;
+
+        first = std::max(first, 0);
+        last = std::min(last, nKeys - 2);
+
+        for(int i = first; i <= last; ++i) {
+          double dt = _times[i + 1] - _times[i];
+          for(int k = 0; k < _dimension; ++k) {
+            double p0 = _values[i * _dimension + k];
+            double p1 = _values[(i + 1) * _dimension + k];
+            double *c = &_coefficients[(i * _dimension + k) * 4];
+
+            c[0] = p0;
+            switch(_interpolations[i]) {
+            case eInterpolationConstant :
+              c[1] = c[2] = c[3] = 0.;
+              break;
+            case eInterpolationLinear :
+              c[1] = p1 - p0;
+              c[2] = c[3] = 0.;
+              break;
+            case eInterpolationSmooth :
+            case eInterpolationEaseInOut :
+              {
+                // cubic hermite, with the tangents scaled to the segment
+                double m0 = 0., m1 = 0.;
+                if(_interpolations[i] == eInterpolationSmooth) {
+                  m0 = smoothTangent(i, k) * dt;
+                  m1 = smoothTangent(i + 1, k) * dt;
+                }
+                c[1] = m0;
+                c[2] = 3. * (p1 - p0) - 2. * m0 - m1;
+                c[3] = 2. * (p0 - p1) + m0 + m1;
+              }
+              break;
+            }
+          }
+        }
+
+        // integrals are cumulative, so everything after the first edited segment moves
+        for(int k = 0; k < _dimension; ++k)
+          _integrals[k] = 0.;
+        for(int i = first; i < nKeys - 1; ++i) {
+          double dt = _times[i + 1] - _times[i];
+          for(int k = 0; k < _dimension; ++k) {
+            const double *c = &_coefficients[(i * _dimension + k) * 4];
+            _integrals[(i + 1) * _dimension + k] = _integrals[i * _dimension + k] + dt * (c[0] + c[1] / 2. + c[2] / 3. + c[3] / 4.);
+          }
+        }
+      }
+
+      /// set a key, replacing any key already at that time
+      void Curve::setKey(OfxTime time, const double *value, InterpolationEnum interpolation)
+      {
+        int nth = findKey(time);
+        if(nth < 0) {
+          nth = int(std::upper_bound(_times.begin(), _times.end(), time) - _times.begin());
+          _times.insert(_times.begin() + nth, time);
+          _values.insert(_values.begin() + nth * _dimension, _dimension, 0.);
+          _interpolations.insert(_interpolations.begin() + nth, interpolation);
+          _coefficients.insert(_coefficients.begin() + nth * _dimension * 4, _dimension * 4, 0.);
+          _integrals.insert(_integrals.begin() + nth * _dimension, _dimension, 0.);
+        }
+
+        std::copy(value, value + _dimension, _values.begin() + nth * _dimension);
+        _interpolations[nth] = interpolation;
+
+        // smooth tangents reach one key either side, so do the segments they touch
+        update(nth - 2, nth + 1);
+      }
+
+      /// set the interpolation of the segment starting at the nth key
+      OfxStatus Curve::setKeyInterpolation(int nth, InterpolationEnum interpolation)
+      {
+        if(nth < 0 || nth >= int(_times.size()))
+          return kOfxStatErrBadIndex;
+        _interpolations[nth] = interpolation;
+        update(nth, nth);
+        return kOfxStatOK;
+      }
+
+      /// get the value at the given time, into _dimension doubles
+      void Curve::getValue(OfxTime time, double *value) const
+      {
+        int nKeys = int(_times.size());
+        if(nKeys == 0) {
+          std::copy(_default.begin(), _default.end(), value);
+        }
+        else if(time <= _times[0]) {
+          std::copy(_values.begin(), _values.begin() + _dimension, value);
+        }
+        else if(time >= _times[nKeys - 1]) {
+          std::copy(_values.end() - _dimension, _values.end(), value);
+        }
+        else {
+          int i = findSegment(time);
+          double s = (time - _times[i]) / (_times[i + 1] - _times[i]);
+          const double *c = &_coefficients[i * _dimension * 4];
+          for(int k = 0; k < _dimension; ++k, c += 4)
+            value[k] = c[0] + s * (c[1] + s * (c[2] + s * c[3]));
+        }
+      }
+
+      /// get the values at each of nTimes times, into _dimension doubles per time
+      void Curve::getValues(const OfxTime *times, int nTimes, double *values) const
+      {
+        int nKeys = int(_times.size());
+        if(nKeys < 2) {
+          for(int j = 0; j < nTimes; ++j)
+            getValue(times[j], values + j * _dimension);
+          return;
+        }
+
+        // the segment of the previous time, only looked up again when a time leaves it
+        int i = -1;
+        OfxTime t0 = 0., t1 = 0.;
+        double invDt = 0.;
+        const double *coefficients = 0;
+
+        for(int j = 0; j < nTimes; ++j, values += _dimension) {
+          OfxTime time = times[j];
+          if(time <= _times[0]) {
+            std::copy(_values.begin(), _values.begin() + _dimension, values);
+          }
+          else if(time >= _times[nKeys - 1]) {
+            std::copy(_values.end() - _dimension, _values.end(), values);
+          }
+          else {
+            if(i < 0 || time < t0 || time >= t1) {
+              i = findSegment(time);
+              t0 = _times[i];
+              t1 = _times[i + 1];
+              invDt = 1. / (t1 - t0);
+              coefficients = &_coefficients[i * _dimension * 4];
+            }
+            double s = (time - t0) * invDt;
+            const double *c = coefficients;
+            for(int k = 0; k < _dimension; ++k, c += 4)
+              values[k] = c[0] + s * (c[1] + s * (c[2] + s * c[3]));
+          }
+        }
+      }
+
+      /// get the derivative at the given time, into _dimension doubles
+      void Curve::getDerivative(OfxTime time, double *value) const
+      {
+        int nKeys = int(_times.size());
+        if(nKeys < 2 || time < _times[0] || time >= _times[nKeys - 1]) {
+          std::fill(value, value + _dimension, 0.);
+        }
+        else {
+          int i = findSegment(time);
+          double dt = _times[i + 1] - _times[i];
+          double s = (time - _times[i]) / dt;
+          const double *c = &_coefficients[i * _dimension * 4];
+          for(int k = 0; k < _dimension; ++k, c += 4)
+            value[k] = (c[1] + s * (2. * c[2] + s * 3. * c[3])) / dt;
+        }
+      }
+
+      /// get the integral between the two times, into _dimension doubles
+      void Curve::getIntegral(OfxTime time1, OfxTime time2, double *value) const
+      {
+        int nKeys = int(_times.size());
+        if(nKeys == 0) {
+          for(int k = 0; k < _dimension; ++k)
+            value[k] = _default[k] * (time2 - time1);
+          return;
+        }
+
+        // integrate each time from the first key, -1 is before the first key, nKeys-1 after the last
+        OfxTime times[2] = {time1, time2};
+        int segments[2];
+        for(int j = 0; j < 2; ++j) {
+          if(times[j] < _times[0])
+            segments[j] = -1;
+          else if(times[j] >= _times[nKeys - 1])
+            segments[j] = nKeys - 1;
+          else
+            segments[j] = findSegment(times[j]);
+        }
+
+        for(int k = 0; k < _dimension; ++k) {
+          double primitives[2];
+          for(int j = 0; j < 2; ++j) {
+            int i = segments[j];
+            if(i < 0) {
+              primitives[j] = _values[k] * (times[j] - _times[0]);
+            }
+            else if(i == nKeys - 1) {
+              primitives[j] = _integrals[i * _dimension + k] + _values[i * _dimension + k] * (times[j] - _times[i]);
+            }
+            else {
+              double dt = _times[i + 1] - _times[i];
+              double s = (times[j] - _times[i]) / dt;
+              const double *c = &_coefficients[(i * _dimension + k) * 4];
+              primitives[j] = _integrals[i * _dimension + k] + dt * s * (c[0] + s * (c[1] / 2. + s * (c[2] / 3. + s * c[3] / 4.)));
+            }
+          }
+          value[k] = primitives[1] - primitives[0];
+        }
+      }
+
+      /// get the number of keys
+      OfxStatus Curve::getNumKeys(unsigned int &nKeys) const
+      {
+        nKeys = (unsigned int)_times.size();
+        return kOfxStatOK;
+      }
+
+      /// get the time of the nth key
+      OfxStatus Curve::getKeyTime(int nth, OfxTime& time) const
+      {
+        if(nth < 0 || nth >= int(_times.size()))
+          return kOfxStatErrBadIndex;
+        time = _times[nth];
+        return kOfxStatOK;
+      }
+
+      /// find the key at (direction == 0), after (direction > 0) or before (direction < 0) the given time
+      OfxStatus Curve::getKeyIndex(OfxTime time, int direction, int &index) const
+      {
+        index = -1;
+        if(direction == 0) {
+          index = findKey(time);
+        }
+        else if(direction > 0) {
+          std::vector<OfxTime>::const_iterator it = std::upper_bound(_times.begin(), _times.end(), time + kKeyTimeTolerance);
+          if(it != _times.end())
+            index = int(it - _times.begin());
+        }
+        else {
+          std::vector<OfxTime>::const_iterator it = std::lower_bound(_times.begin(), _times.end(), time - kKeyTimeTolerance);
+          if(it != _times.begin())
+            index = int(it - _times.begin()) - 1;
+        }
+        return index >= 0 ? kOfxStatOK : kOfxStatFailed;
+      }
+
+      /// delete the key at the given time
+      OfxStatus Curve::deleteKey(OfxTime time)
+      {
+        int nth = findKey(time);
+        if(nth < 0)
+          return kOfxStatErrBadIndex;
+
+        _times.erase(_times.begin() + nth);
+        _values.erase(_values.begin() + nth * _dimension, _values.begin() + (nth + 1) * _dimension);
+        _interpolations.erase(_interpolations.begin() + nth);
+        _coefficients.erase(_coefficients.begin() + nth * _dimension * 4, _coefficients.begin() + (nth + 1) * _dimension * 4);
+        _integrals.erase(_integrals.begin() + nth * _dimension, _integrals.begin() + (nth + 1) * _dimension);
+
+        // the keys either side of the hole are now neighbours
+        update(nth - 2, nth + 1);
+        return kOfxStatOK;
+      }
+
+      /// delete all the keys
+      OfxStatus Curve::deleteAllKeys()
+      {
+        _times.clear();
+        _values.clear();
+        _interpolations.clear();
+        _coefficients.clear();
+        _integrals.clear();
+        _hint.store(0, std::memory_order_relaxed);
+        return kOfxStatOK;
+      }
+
+    } // Animation
+
+  } // Host
+
+} // OFX
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 #include <assert.h>
+#include <string.h>
 
 // ofx
 #include "ofxCore.h"
@@ -468,13 +469,66 @@ namespace OFX {
         { kOfxImagePropRowBytes, Property::eInt, 1, true, "0", },
         { kOfxImagePropField, Property::eString, 1, true, "", },
         { kOfxImagePropUniqueIdentifier, Property::eString, 1, true, "" },
+        { kOfxImagePropPackedDescriptor, Property::ePointer, 1, true, NULL },
         Property::propSpecEnd
       };
 
+      ImageBase::PackedDescriptorHook::PackedDescriptorHook(const ImageBase &image)
+        : _image(image)
+        , _packed(false)
+      {
+        memset(&_descriptor, 0, sizeof(_descriptor));
+      }
+
+      void ImageBase::PackedDescriptorHook::notify(const std::string &/*name*/, bool /*singleValue*/, int /*indexOrN*/)
+      {
+        std::lock_guard<std::mutex> lock(_packMutex);
+        _packed.store(false, std::memory_order_relaxed);
+      }
+
+      void *ImageBase::PackedDescriptorHook::getPointerProperty(const std::string &/*name*/, int /*index*/) const
+      {
+        if(_packed.load(std::memory_order_acquire))
+          return &_descriptor;
+
+        std::lock_guard<std::mutex> lock(_packMutex);
+        if(_packed.load(std::memory_order_relaxed))
+          return &_descriptor;
+
+        // the data pointer is only on images, not textures
+        Property::Pointer *data = _image.fetchPointerProperty(kOfxImagePropData);
+        _descriptor.data = data ? data->getValue() : NULL;
+        _image.getIntPropertyN(kOfxImagePropBounds, &_descriptor.bounds.x1, 4);
+        _image.getIntPropertyN(kOfxImagePropRegionOfDefinition, &_descriptor.regionOfDefinition.x1, 4);
+        _descriptor.rowBytes = _image.getIntProperty(kOfxImagePropRowBytes);
+        _descriptor.pixelAspectRatio = _image.getDoubleProperty(kOfxImagePropPixelAspectRatio);
+        _image.getDoublePropertyN(kOfxImageEffectPropRenderScale, &_descriptor.renderScale.x, 2);
+
+        // the strings are the property values, which live as long as the image
+        _descriptor.components = _image.getStringProperty(kOfxImageEffectPropComponents).c_str();
+        _descriptor.pixelDepth = _image.getStringProperty(kOfxImageEffectPropPixelDepth).c_str();
+        _descriptor.preMultiplication = _image.getStringProperty(kOfxImageEffectPropPreMultiplication).c_str();
+        _descriptor.field = _image.getStringProperty(kOfxImagePropField).c_str();
+        _descriptor.uniqueIdentifier = _image.getStringProperty(kOfxImagePropUniqueIdentifier).c_str();
+        _packed.store(true, std::memory_order_release);
+        return &_descriptor;
+      }
+
+      void ImageBase::hookPackedDescriptor()
+      {
+        setGetHook(kOfxImagePropPackedDescriptor, &_packedDescriptorHook);
+        for(int i = 0; imageBaseStuffs[i].name; ++i) {
+          if(strcmp(imageBaseStuffs[i].name, kOfxImagePropPackedDescriptor) != 0)
+            addNotifyHook(imageBaseStuffs[i].name, &_packedDescriptorHook);
+        }
+      }
+
       ImageBase::ImageBase()
         : Property::Set(imageBaseStuffs)
         , _referenceCount(1)
+        , _packedDescriptorHook(*this)
       {
+        hookPackedDescriptor();
       }
 
       /// called during ctor to get bits from the clip props into ours
@@ -501,7 +555,9 @@ namespace OFX {
       ImageBase::ImageBase(ClipInstance& instance)
         : Property::Set(imageBaseStuffs)
         , _referenceCount(1)
+        , _packedDescriptorHook(*this)
       {
+        hookPackedDescriptor();
         getClipBits(instance);
       }      
 
@@ -516,7 +572,9 @@ namespace OFX {
                    std::string uniqueIdentifier) 
         : Property::Set(imageBaseStuffs)
         , _referenceCount(1)
+        , _packedDescriptorHook(*this)
       {
+        hookPackedDescriptor();
         getClipBits(instance);
 
         // set other data
@@ -573,6 +631,7 @@ namespace OFX {
         : ImageBase()
       {
         addProperties(imageStuffs);
+        addNotifyHook(kOfxImagePropData, &_packedDescriptorHook);
       }
 
       /// make an image from a clip instance
@@ -580,6 +639,7 @@ namespace OFX {
         : ImageBase(instance)
       {
         addProperties(imageStuffs);
+        addNotifyHook(kOfxImagePropData, &_packedDescriptorHook);
       }
 
       // construction based on clip instance
@@ -595,6 +655,7 @@ namespace OFX {
         : ImageBase(instance, renderScaleX, renderScaleY, bounds, rod, rowBytes, field, uniqueIdentifier)
       {
         addProperties(imageStuffs);
+        addNotifyHook(kOfxImagePropData, &_packedDescriptorHook);
 
         // set other data
         setPointerProperty(kOfxImagePropData,data);
@@ -384,8 +384,21 @@ namespace OFX {
         return _properties;
       }
 
+      /// get a stable hash of the render state of the instance at a time
+      uint64_t Instance::getStateHash(OfxTime time)
+      {
+        const std::string &identifier = _plugin->getIdentifier();
+        int versions[2] = {_plugin->getVersionMajor(), _plugin->getVersionMinor()};
+        uint64_t paramHash = getParamStateHash(time);
+
+        uint64_t hash = Param::hashBytes(identifier.c_str(), identifier.size() + 1);
+        hash = Param::hashBytes(versions, sizeof(versions), hash);
+        hash = Param::hashBytes(_context.c_str(), _context.size() + 1, hash);
+        return Param::hashBytes(&paramHash, sizeof(paramHash), hash);
+      }
+
       /// called after construction to populate clips and params
-      OfxStatus Instance::populate() 
+      OfxStatus Instance::populate(bool lazyParams) 
       {        
         const std::vector<ClipDescriptor*>& clips = _descriptor->getClipsByOrder();
 
@@ -416,6 +429,13 @@ namespace OFX {
             // name of the parameter
             std::string name = descriptor->getName();
 
+            // lazy params are made on demand, and groups find their children then
+            if(lazyParams) {
+              OfxStatus st = addLazyParam(name,*descriptor);
+              if(st != kOfxStatOK) return st;
+              continue;
+            }
+
             // get a param instance from a param descriptor
             Param::Instance* instance = newParam(name,*descriptor);
             if(!instance) return kOfxStatFailed;
@@ -727,6 +747,9 @@ namespace OFX {
           return kOfxStatFailed;
         }
 
+        // the host has changed the param, so its state hash is stale
+        param->invalidateHash();
+
         Property::PropSpec stuff[] = {
           { kOfxPropType, Property::eString, 1, true, kOfxTypeParameter },
           { kOfxPropName, Property::eString, 1, true, paramName.c_str() },
@@ -753,6 +776,81 @@ namespace OFX {
         return st;
       }
 
+      OfxStatus Instance::paramsInstanceChangedAction(const std::vector<ParamChange> &changes,
+                                                      const std::string & why,
+                                                      OfxTime     time,
+                                                      OfxPointD   renderScale,
+                                                      bool        collapseRepeats)
+      {
+        // work out which params to report before calling anything, so an empty batch costs nothing
+        std::vector<Param::Instance*> params;
+        params.reserve(changes.size());
+        for(size_t i = 0; i < changes.size(); ++i) {
+          const ParamChange &change = changes[i];
+
+          size_t last = i;
+          if(collapseRepeats) {
+            while(last + 1 < changes.size() && changes[last + 1].name == change.name)
+              ++last;
+          }
+
+          Param::Instance* param = getParam(change.name);
+          if(!param)
+            return kOfxStatFailed;
+
+          // compare the hash from before the first of the run with the param now
+          if(!change.compareHash || change.oldHash != param->getContentHash())
+            params.push_back(param);
+          i = last;
+        }
+
+        if(params.empty())
+          return kOfxStatReplyDefault;
+
+        OfxStatus st = beginInstanceChangedAction(why);
+        if(st != kOfxStatOK && st != kOfxStatReplyDefault)
+          return st;
+        st = kOfxStatOK;
+
+        // one set of args for the lot, with only the name changing
+        Property::PropSpec stuff[] = {
+          { kOfxPropType, Property::eString, 1, true, kOfxTypeParameter },
+          { kOfxPropName, Property::eString, 1, true, "" },
+          { kOfxPropChangeReason, Property::eString, 1, true, why.c_str() },
+          { kOfxPropTime, Property::eDouble, 1, true, "0" },
+          { kOfxImageEffectPropRenderScale, Property::eDouble, 2, true, "0" },
+          Property::propSpecEnd
+        };
+
+        Property::Set inArgs(stuff);
+        inArgs.setDoubleProperty(kOfxPropTime,time);
+        inArgs.setDoublePropertyN(kOfxImageEffectPropRenderScale, &renderScale.x, 2);
+
+        for(size_t i = 0; i < params.size(); ++i) {
+          const std::string &paramName = params[i]->getName();
+
+          if(isClipPreferencesSlaveParam(paramName))
+            _clipPrefsDirty = true;
+
+          params[i]->invalidateHash();
+
+          inArgs.setStringProperty(kOfxPropName, paramName);
+#         ifdef OFX_DEBUG_ACTIONS
+            std::cout << "OFX: "<<(void*)this<<"->"<<kOfxActionInstanceChanged<<"("<<kOfxTypeParameter<<","<<paramName<<","<<why<<","<<time<<",("<<renderScale.x<<","<<renderScale.y<<"))"<<std::endl;
+#         endif
+          OfxStatus paramSt = mainEntry(kOfxActionInstanceChanged,this->getHandle(), &inArgs, 0);
+#         ifdef OFX_DEBUG_ACTIONS
+            std::cout << "OFX: "<<(void*)this<<"->"<<kOfxActionInstanceChanged<<"("<<kOfxTypeParameter<<","<<paramName<<","<<why<<","<<time<<",("<<renderScale.x<<","<<renderScale.y<<"))->"<<StatStr(paramSt)<<std::endl;
+#         endif
+          // keep going, so one failure doesn't hide the other changes, but report the first
+          if(st == kOfxStatOK && paramSt != kOfxStatOK && paramSt != kOfxStatReplyDefault)
+            st = paramSt;
+        }
+
+        OfxStatus endSt = endInstanceChangedAction(why);
+        return st != kOfxStatOK ? st : endSt;
+      }
+
       OfxStatus Instance::clipInstanceChangedAction(const std::string & clipName,
                                                     const std::string & why,
                                                     OfxTime     time,
@@ -2686,7 +2784,7 @@ namespace OFX {
         { kOfxParamHostPropSupportsCustomAnimation, Property::eInt, 1, true, "0" },
         { kOfxPropHostOSHandle, Property::ePointer, 1, true, NULL },
 #ifdef OFX_SUPPORTS_PARAMETRIC
-        { kOfxParamHostPropSupportsParametricAnimation, Property::eInt, 1, true, "0"},
+        { kOfxParamHostPropSupportsParametricAnimation, Property::eInt, 1, true, "1"},
 #endif
         { kOfxParamHostPropMaxParameters, Property::eInt, 1, true, "-1" },
         { kOfxParamHostPropMaxPages, Property::eInt, 1, true, "0" },
@@ -12,6 +12,7 @@
 #include "ofxhBinary.h"
 #include "ofxhPropertySuite.h"
 #include "ofxhParam.h"
+#include "ofxhParamJournal.h"
 #include "ofxhImageEffect.h"
 #include "ofxOld.h" // old plugins may rely on deprecated properties being present
 
@@ -106,6 +107,10 @@ namespace OFX {
         return _properties.getStringProperty(kOfxParamPropHint, 0);
       }
 
+      const std::string &Base::getCacheInvalidation() const {
+        return _properties.getStringProperty(kOfxParamPropCacheInvalidation, 0);
+      }
+
       bool Base::getEnabled() const {
         return _properties.getIntProperty(kOfxParamPropEnabled, 0) != 0;
       }
@@ -533,19 +538,85 @@ namespace OFX {
         return desc;
       }
 
+      ////////////////////////////////////////////////////////////////////////////////
+      //
+      // state hashing
+      //
+
+      /// FNV-1a hash of some bytes
+      uint64_t hashBytes(const void *data, size_t size, uint64_t hash)
+      {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for(size_t i = 0; i < size; ++i) {
+          hash ^= bytes[i];
+          hash *= 1099511628211ULL;
+        }
+        return hash;
+      }
+
+      /// scramble a hash so that sums of them are as good as the hashes themselves
+      static uint64_t hashMix(uint64_t hash)
+      {
+        hash ^= hash >> 30;
+        hash *= 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 27;
+        hash *= 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+        return hash;
+      }
+
+      /// add the value of a param, at a time or the current one if time is NULL, to a hash
+      static uint64_t hashParamValue(Instance &param, const OfxTime *time, uint64_t hash)
+      {
+        const int n = param.getValueDimension();
+        if(param.getValueType() == Property::eDouble) {
+          double values[4];
+          OfxStatus stat = time ? param.getDouble(*time, values, n) : param.getDouble(values, n);
+          if(stat == kOfxStatOK) {
+            for(int i = 0; i < n; ++i) {
+              if(values[i] == 0.)
+                values[i] = 0.; // so -0 hashes as 0
+            }
+            hash = hashBytes(values, n * sizeof(double), hash);
+          }
+        }
+        else if(param.getValueType() == Property::eInt) {
+          int values[4];
+          OfxStatus stat = time ? param.getInt(*time, values, n) : param.getInt(values, n);
+          if(stat == kOfxStatOK)
+            hash = hashBytes(values, n * sizeof(int), hash);
+        }
+        else if(StringInstance *stringParam = dynamic_cast<StringInstance*>(&param)) {
+          std::string value;
+          OfxStatus stat = time ? stringParam->get(*time, value) : stringParam->get(value);
+          if(stat == kOfxStatOK)
+            hash = hashBytes(value.data(), value.size(), hash);
+        }
+        return hash;
+      }
+
       ////////////////////////////////////////////////////////////////////////////////
       //
       // Instance
       //
 
       /// the description of a plugin parameter
-      Instance::~Instance() {}
+      Instance::~Instance()
+      {
+        if(_paramSetInstance)
+          _paramSetInstance->paramHashRemoved(this);
+      }
 
       /// make a parameter, with the given type and name
       Instance::Instance(Descriptor& descriptor, Param::SetInstance* paramSet) 
         : Base(descriptor.getName(), descriptor.getType(), descriptor.getProperties())
         , _paramSetInstance(paramSet)
         , _parentInstance(0)
+        , _valueKind(eValueNone)
+        , _hashName(hashBytes(getName().data(), getName().size()))
+        , _hashStatic(0)
+        , _hashTimed(false)
+        , _hashDirty(false)
       {
         _properties.addNotifyHook(kOfxParamPropEnabled, this);
         _properties.addNotifyHook(kOfxParamPropSecret, this);
@@ -555,6 +626,7 @@ namespace OFX {
         _properties.addNotifyHook(kOfxParamPropDisplayMin, this);
         _properties.addNotifyHook(kOfxParamPropDisplayMax, this);
         _properties.addNotifyHook(kOfxParamPropEvaluateOnChange, this);
+        _properties.addNotifyHook(kOfxParamPropCacheInvalidation, this);
       }
 
       // callback which should set enabled state as appropriate
@@ -623,6 +695,234 @@ namespace OFX {
         return kOfxStatErrUnsupported;
       }
 
+      /// eInt or eDouble if the typed gets work on this param, eNone if only the var args calls do
+      Property::TypeEnum Instance::getValueType() const
+      {
+        switch(_valueKind) {
+        case eValueInteger :
+        case eValueChoice :
+        case eValueBoolean :
+        case eValueInteger2D :
+        case eValueInteger3D :
+          return Property::eInt;
+        case eValueDouble :
+        case eValueDouble2D :
+        case eValueDouble3D :
+        case eValueRGB :
+        case eValueRGBA :
+          return Property::eDouble;
+        default :
+          return Property::eNone;
+        }
+      }
+
+      /// number of values the typed gets take
+      int Instance::getValueDimension() const
+      {
+        switch(_valueKind) {
+        case eValueInteger :
+        case eValueChoice :
+        case eValueBoolean :
+        case eValueDouble :
+          return 1;
+        case eValueInteger2D :
+        case eValueDouble2D :
+          return 2;
+        case eValueInteger3D :
+        case eValueDouble3D :
+        case eValueRGB :
+          return 3;
+        case eValueRGBA :
+          return 4;
+        default :
+          return 0;
+        }
+      }
+
+      /// get the values of an int param with its typed get, at a time or the current one if time is NULL
+      static OfxStatus getIntValues(Instance &param, const OfxTime *time, int *v)
+      {
+        switch(param.getValueKind()) {
+        case Instance::eValueInteger : {
+          IntegerInstance &p = static_cast<IntegerInstance &>(param);
+          return time ? p.get(*time, v[0]) : p.get(v[0]);
+        }
+        case Instance::eValueChoice : {
+          ChoiceInstance &p = static_cast<ChoiceInstance &>(param);
+          return time ? p.get(*time, v[0]) : p.get(v[0]);
+        }
+        case Instance::eValueBoolean : {
+          BooleanInstance &p = static_cast<BooleanInstance &>(param);
+          bool b;
+          OfxStatus stat = time ? p.get(*time, b) : p.get(b);
+          if(stat == kOfxStatOK)
+            v[0] = b;
+          return stat;
+        }
+        case Instance::eValueInteger2D : {
+          Integer2DInstance &p = static_cast<Integer2DInstance &>(param);
+          return time ? p.get(*time, v[0], v[1]) : p.get(v[0], v[1]);
+        }
+        case Instance::eValueInteger3D : {
+          Integer3DInstance &p = static_cast<Integer3DInstance &>(param);
+          return time ? p.get(*time, v[0], v[1], v[2]) : p.get(v[0], v[1], v[2]);
+        }
+        default :
+          return kOfxStatErrUnsupported;
+        }
+      }
+
+      /// get the values of a double param with its typed get, at a time or the current one if time is NULL
+      static OfxStatus getDoubleValues(Instance &param, const OfxTime *time, double *v)
+      {
+        switch(param.getValueKind()) {
+        case Instance::eValueDouble : {
+          DoubleInstance &p = static_cast<DoubleInstance &>(param);
+          return time ? p.get(*time, v[0]) : p.get(v[0]);
+        }
+        case Instance::eValueDouble2D : {
+          Double2DInstance &p = static_cast<Double2DInstance &>(param);
+          return time ? p.get(*time, v[0], v[1]) : p.get(v[0], v[1]);
+        }
+        case Instance::eValueDouble3D : {
+          Double3DInstance &p = static_cast<Double3DInstance &>(param);
+          return time ? p.get(*time, v[0], v[1], v[2]) : p.get(v[0], v[1], v[2]);
+        }
+        case Instance::eValueRGB : {
+          RGBInstance &p = static_cast<RGBInstance &>(param);
+          return time ? p.get(*time, v[0], v[1], v[2]) : p.get(v[0], v[1], v[2]);
+        }
+        case Instance::eValueRGBA : {
+          RGBAInstance &p = static_cast<RGBAInstance &>(param);
+          return time ? p.get(*time, v[0], v[1], v[2], v[3]) : p.get(v[0], v[1], v[2], v[3]);
+        }
+        default :
+          return kOfxStatErrUnsupported;
+        }
+      }
+
+      /// set the values of an int param with its typed set, at a time or the current one if time is NULL
+      static OfxStatus setIntValues(Instance &param, const OfxTime *time, const int *v)
+      {
+        switch(param.getValueKind()) {
+        case Instance::eValueInteger : {
+          IntegerInstance &p = static_cast<IntegerInstance &>(param);
+          return time ? p.set(*time, v[0]) : p.set(v[0]);
+        }
+        case Instance::eValueChoice : {
+          ChoiceInstance &p = static_cast<ChoiceInstance &>(param);
+          return time ? p.set(*time, v[0]) : p.set(v[0]);
+        }
+        case Instance::eValueBoolean : {
+          BooleanInstance &p = static_cast<BooleanInstance &>(param);
+          return time ? p.set(*time, v[0] != 0) : p.set(v[0] != 0);
+        }
+        case Instance::eValueInteger2D : {
+          Integer2DInstance &p = static_cast<Integer2DInstance &>(param);
+          return time ? p.set(*time, v[0], v[1]) : p.set(v[0], v[1]);
+        }
+        case Instance::eValueInteger3D : {
+          Integer3DInstance &p = static_cast<Integer3DInstance &>(param);
+          return time ? p.set(*time, v[0], v[1], v[2]) : p.set(v[0], v[1], v[2]);
+        }
+        default :
+          return kOfxStatErrUnsupported;
+        }
+      }
+
+      /// set the values of a double param with its typed set, at a time or the current one if time is NULL
+      static OfxStatus setDoubleValues(Instance &param, const OfxTime *time, const double *v)
+      {
+        switch(param.getValueKind()) {
+        case Instance::eValueDouble : {
+          DoubleInstance &p = static_cast<DoubleInstance &>(param);
+          return time ? p.set(*time, v[0]) : p.set(v[0]);
+        }
+        case Instance::eValueDouble2D : {
+          Double2DInstance &p = static_cast<Double2DInstance &>(param);
+          return time ? p.set(*time, v[0], v[1]) : p.set(v[0], v[1]);
+        }
+        case Instance::eValueDouble3D : {
+          Double3DInstance &p = static_cast<Double3DInstance &>(param);
+          return time ? p.set(*time, v[0], v[1], v[2]) : p.set(v[0], v[1], v[2]);
+        }
+        case Instance::eValueRGB : {
+          RGBInstance &p = static_cast<RGBInstance &>(param);
+          return time ? p.set(*time, v[0], v[1], v[2]) : p.set(v[0], v[1], v[2]);
+        }
+        case Instance::eValueRGBA : {
+          RGBAInstance &p = static_cast<RGBAInstance &>(param);
+          return time ? p.set(*time, v[0], v[1], v[2], v[3]) : p.set(v[0], v[1], v[2], v[3]);
+        }
+        default :
+          return kOfxStatErrUnsupported;
+        }
+      }
+
+      /// get the n values of an int, boolean, choice or integer 2D/3D param
+      OfxStatus Instance::getInt(int *values, int n)
+      {
+        if(n != getValueDimension())
+          return kOfxStatErrBadIndex;
+        return getIntValues(*this, 0, values);
+      }
+
+      /// get the n values of an int, boolean, choice or integer 2D/3D param at a time
+      OfxStatus Instance::getInt(OfxTime time, int *values, int n)
+      {
+        if(n != getValueDimension())
+          return kOfxStatErrBadIndex;
+        return getIntValues(*this, &time, values);
+      }
+
+      /// get the n values of a double, colour or double 2D/3D param
+      OfxStatus Instance::getDouble(double *values, int n)
+      {
+        if(n != getValueDimension())
+          return kOfxStatErrBadIndex;
+        return getDoubleValues(*this, 0, values);
+      }
+
+      /// get the n values of a double, colour or double 2D/3D param at a time
+      OfxStatus Instance::getDouble(OfxTime time, double *values, int n)
+      {
+        if(n != getValueDimension())
+          return kOfxStatErrBadIndex;
+        return getDoubleValues(*this, &time, values);
+      }
+
+      /// set the n values of an int, boolean, choice or integer 2D/3D param
+      OfxStatus Instance::setInt(const int *values, int n)
+      {
+        if(n != getValueDimension())
+          return kOfxStatErrBadIndex;
+        return setIntValues(*this, 0, values);
+      }
+
+      /// set the n values of an int, boolean, choice or integer 2D/3D param at a time
+      OfxStatus Instance::setInt(OfxTime time, const int *values, int n)
+      {
+        if(n != getValueDimension())
+          return kOfxStatErrBadIndex;
+        return setIntValues(*this, &time, values);
+      }
+
+      /// set the n values of a double, colour or double 2D/3D param
+      OfxStatus Instance::setDouble(const double *values, int n)
+      {
+        if(n != getValueDimension())
+          return kOfxStatErrBadIndex;
+        return setDoubleValues(*this, 0, values);
+      }
+
+      /// set the n values of a double, colour or double 2D/3D param at a time
+      OfxStatus Instance::setDouble(OfxTime time, const double *values, int n)
+      {
+        if(n != getValueDimension())
+          return kOfxStatErrBadIndex;
+        return setDoubleValues(*this, &time, values);
+      }
+
       /// overridden from Property::NotifyHook
       void Instance::notify(const std::string &name, bool /*single*/, int /*num*/)
       {
@@ -643,7 +943,53 @@ namespace OFX {
         }
         if (name == kOfxParamPropEvaluateOnChange) {
           setEvaluateOnChange();
+          invalidateHash();
+        }
+        if (name == kOfxParamPropCacheInvalidation) {
+          invalidateHash();
+        }
+      }
+
+      /// tell the owning set the param's state hash needs recomputing
+      void Instance::invalidateHash()
+      {
+        if(_paramSetInstance)
+          _paramSetInstance->paramHashChanged(this);
+      }
+
+      /// does the param's state hash depend on the time
+      bool Instance::getHashIsTimed()
+      {
+        KeyframeParam *keyframes = dynamic_cast<KeyframeParam*>(this);
+        unsigned int nKeys = 0;
+        if(!keyframes || keyframes->getNumKeys(nKeys) != kOfxStatOK || nKeys == 0)
+          return false;
+        return getCacheInvalidation() == kOfxParamInvalidateValueChange;
+      }
+
+      /// hash of the param's value at a time
+      uint64_t Instance::getValueHash(OfxTime time)
+      {
+        return hashParamValue(*this, &time, hashBytes(0, 0));
+      }
+
+      /// hash of the param's entire state
+      uint64_t Instance::getContentHash()
+      {
+        uint64_t hash = hashBytes(0, 0);
+        KeyframeParam *keyframes = dynamic_cast<KeyframeParam*>(this);
+        unsigned int nKeys = 0;
+        if(!keyframes || keyframes->getNumKeys(nKeys) != kOfxStatOK || nKeys == 0)
+          return hashParamValue(*this, 0, hash);
+
+        for(unsigned int i = 0; i < nKeys; ++i) {
+          OfxTime time;
+          if(keyframes->getKeyTime(int(i), time) == kOfxStatOK) {
+            hash = hashBytes(&time, sizeof(time), hash);
+            hash = hashParamValue(*this, &time, hash);
+          }
         }
+        return hash;
       }
 
       // copy one parameter to another, with a range (NULL means to copy all animation)
@@ -695,6 +1041,12 @@ namespace OFX {
       
       const std::vector<Param::Instance*> &GroupInstance::getChildren() const
       {
+        if(_children.empty() && _paramSetInstance) {
+          // only makes the lazy params in this group, not every lazy param in the set
+          _children = _paramSetInstance->fetchChildParams(getName());
+          for(std::vector<Instance*>::const_iterator it = _children.begin(); it != _children.end(); ++it)
+            (*it)->setParentInstance(const_cast<GroupInstance*>(this));
+        }
         return _children;
       }
 
@@ -728,6 +1080,7 @@ namespace OFX {
       ChoiceInstance::ChoiceInstance(Descriptor& descriptor, Param::SetInstance* instance)
         : Instance(descriptor,instance)
       {
+        setValueKind(eValueChoice);
         _properties.addNotifyHook(kOfxParamPropChoiceOption, this);
       }
 
@@ -873,6 +1226,17 @@ namespace OFX {
         return stat;
       }
 
+      /// get the values at each of nTimes times, the default calls get(time, ...) for each time
+      OfxStatus IntegerInstance::getAtTimes(const OfxTime *times, int nTimes, int *values)
+      {
+        for(int i = 0; i < nTimes; ++i, ++values) {
+          OfxStatus stat = get(times[i], *values);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // DoubleInstance
       //
@@ -948,6 +1312,17 @@ namespace OFX {
         return stat;
       }
 
+      /// get the values at each of nTimes times, the default calls get(time, ...) for each time
+      OfxStatus DoubleInstance::getAtTimes(const OfxTime *times, int nTimes, double *values)
+      {
+        for(int i = 0; i < nTimes; ++i, ++values) {
+          OfxStatus stat = get(times[i], *values);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // BooleanInstance
       //
@@ -1106,6 +1481,17 @@ namespace OFX {
         return stat;
       }
 
+      /// get the values at each of nTimes times, the default calls get(time, ...) for each time
+      OfxStatus RGBAInstance::getAtTimes(const OfxTime *times, int nTimes, double *values)
+      {
+        for(int i = 0; i < nTimes; ++i, values += 4) {
+          OfxStatus stat = get(times[i], values[0], values[1], values[2], values[3]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // RGBInstance
       //
@@ -1201,6 +1587,17 @@ namespace OFX {
         return stat;
       }
 
+      /// get the values at each of nTimes times, the default calls get(time, ...) for each time
+      OfxStatus RGBInstance::getAtTimes(const OfxTime *times, int nTimes, double *values)
+      {
+        for(int i = 0; i < nTimes; ++i, values += 3) {
+          OfxStatus stat = get(times[i], values[0], values[1], values[2]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // Double2DInstance
       //
@@ -1290,6 +1687,17 @@ namespace OFX {
         return stat;
       }
 
+      /// get the values at each of nTimes times, the default calls get(time, ...) for each time
+      OfxStatus Double2DInstance::getAtTimes(const OfxTime *times, int nTimes, double *values)
+      {
+        for(int i = 0; i < nTimes; ++i, values += 2) {
+          OfxStatus stat = get(times[i], values[0], values[1]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // Integer2DInstance
       //
@@ -1379,6 +1787,17 @@ namespace OFX {
         return stat;
       }
 
+      /// get the values at each of nTimes times, the default calls get(time, ...) for each time
+      OfxStatus Integer2DInstance::getAtTimes(const OfxTime *times, int nTimes, int *values)
+      {
+        for(int i = 0; i < nTimes; ++i, values += 2) {
+          OfxStatus stat = get(times[i], values[0], values[1]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // Double3DInstance
       //
@@ -1474,6 +1893,17 @@ namespace OFX {
         return stat;
       }
 
+      /// get the values at each of nTimes times, the default calls get(time, ...) for each time
+      OfxStatus Double3DInstance::getAtTimes(const OfxTime *times, int nTimes, double *values)
+      {
+        for(int i = 0; i < nTimes; ++i, values += 3) {
+          OfxStatus stat = get(times[i], values[0], values[1], values[2]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // Integer3DInstance
       //
@@ -1568,6 +1998,17 @@ namespace OFX {
         return stat;
       }
 
+      /// get the values at each of nTimes times, the default calls get(time, ...) for each time
+      OfxStatus Integer3DInstance::getAtTimes(const OfxTime *times, int nTimes, int *values)
+      {
+        for(int i = 0; i < nTimes; ++i, values += 3) {
+          OfxStatus stat = get(times[i], values[0], values[1], values[2]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       ////////////////////////////////////////////////////////////////////////////////
       // string param
       OfxStatus StringInstance::getV(va_list arg)
@@ -1618,6 +2059,160 @@ namespace OFX {
 #       endif
         return set(time, value);
       }
+
+      //
+      // CustomInstance
+      //
+
+      CustomInstance::CustomInstance(Descriptor& descriptor, Param::SetInstance* instance)
+        : StringInstance(descriptor,instance)
+        , _interpCacheSize(64)
+        , _interpCacheNext(0)
+        , _keyGeneration(0)
+      {
+      }
+
+      OfxStatus CustomInstance::callInterpolation(OfxTime time,
+                                                  OfxTime time1, const std::string &value1,
+                                                  OfxTime time2, const std::string &value2,
+                                                  double amount, std::string &value)
+      {
+        OfxCustomParamInterpFuncV1 *interp =
+          reinterpret_cast<OfxCustomParamInterpFuncV1*>(_properties.getPointerProperty(kOfxParamPropCustomInterpCallbackV1));
+        if(!interp)
+          return kOfxStatErrUnsupported;
+
+        Property::PropSpec inStuff[] = {
+          { kOfxPropName, Property::eString, 1, true, getName().c_str() },
+          { kOfxPropTime, Property::eDouble, 1, true, "0" },
+          { kOfxParamPropCustomValue, Property::eString, 2, true, "" },
+          { kOfxParamPropInterpolationTime, Property::eDouble, 2, true, "0" },
+          { kOfxParamPropInterpolationAmount, Property::eDouble, 1, true, "0" },
+          Property::propSpecEnd
+        };
+        Property::PropSpec outStuff[] = {
+          { kOfxParamPropCustomValue, Property::eString, 1, false, "" },
+          Property::propSpecEnd
+        };
+
+        Property::Set inArgs(inStuff);
+        Property::Set outArgs(outStuff);
+
+        double times[2] = {time1, time2};
+        inArgs.setDoubleProperty(kOfxPropTime, time);
+        inArgs.setStringProperty(kOfxParamPropCustomValue, value1, 0);
+        inArgs.setStringProperty(kOfxParamPropCustomValue, value2, 1);
+        inArgs.setDoublePropertyN(kOfxParamPropInterpolationTime, times, 2);
+        inArgs.setDoubleProperty(kOfxParamPropInterpolationAmount, amount);
+
+        OfxParamSetHandle setHandle = _paramSetInstance ? _paramSetInstance->getParamSetHandle() : 0;
+        OfxStatus stat;
+        try {
+          stat = interp(setHandle, inArgs.getHandle(), outArgs.getHandle());
+        }
+        catch(...) {
+          stat = kOfxStatFailed;
+        }
+
+        if(stat == kOfxStatOK)
+          value = outArgs.getStringProperty(kOfxParamPropCustomValue);
+        return stat;
+      }
+
+      OfxStatus CustomInstance::getInterpolatedValue(OfxTime time,
+                                                     OfxTime time1, const std::string &value1,
+                                                     OfxTime time2, const std::string &value2,
+                                                     double amount, std::string &value)
+      {
+        std::unique_lock<std::mutex> lock(_interpMutex);
+        const unsigned int generation = _keyGeneration;
+
+        // look for the time, waiting for it if another thread is interpolating it
+        for(;;) {
+          size_t i = 0;
+          while(i < _interpCache.size() &&
+                (_interpCache[i].time != time || _interpCache[i].generation != generation))
+            ++i;
+          if(i == _interpCache.size())
+            break;
+          if(!_interpCache[i].pending) {
+            value = _interpCache[i].value;
+            return kOfxStatOK;
+          }
+          _interpReady.wait(lock);
+          if(_keyGeneration != generation)
+            break;
+        }
+
+        // claim an entry, growing the cache up to its size, then replacing round robin,
+        // skipping entries other threads are still filling
+        InterpolatedValue *entry = 0;
+        if(_interpCache.size() < _interpCacheSize) {
+          InterpolatedValue pending = {time, generation, true, std::string()};
+          _interpCache.push_back(pending);
+          entry = &_interpCache.back();
+        }
+        else {
+          for(size_t n = 0; n < _interpCache.size() && !entry; ++n) {
+            InterpolatedValue &candidate = _interpCache[_interpCacheNext];
+            _interpCacheNext = (_interpCacheNext + 1) % _interpCache.size();
+            if(!candidate.pending) {
+              candidate.time = time;
+              candidate.generation = generation;
+              candidate.pending = true;
+              entry = &candidate;
+            }
+          }
+        }
+        size_t entryIndex = entry ? size_t(entry - &_interpCache[0]) : 0;
+
+        lock.unlock();
+        std::string result;
+        OfxStatus stat = callInterpolation(time, time1, value1, time2, value2, amount, result);
+        lock.lock();
+
+        // the cache may have been cleared or resized while we were out
+        if(entry && entryIndex < _interpCache.size() && _interpCache[entryIndex].pending &&
+           _interpCache[entryIndex].time == time && _interpCache[entryIndex].generation == generation) {
+          InterpolatedValue &done = _interpCache[entryIndex];
+          if(stat == kOfxStatOK) {
+            done.value = result;
+            done.pending = false;
+          }
+          else {
+            // forget it, so waiting threads try for themselves
+            done.generation = generation - 1;
+            done.pending = false;
+          }
+          _interpReady.notify_all();
+        }
+
+        if(stat == kOfxStatOK)
+          value = result;
+        return stat;
+      }
+
+      void CustomInstance::setInterpolationCacheSize(int size)
+      {
+        std::lock_guard<std::mutex> lock(_interpMutex);
+        _interpCacheSize = size > 0 ? size_t(size) : 0;
+        _interpCache.clear();
+        _interpCacheNext = 0;
+        ++_keyGeneration;
+        _interpReady.notify_all();
+      }
+
+      void CustomInstance::invalidateHash()
+      {
+        {
+          std::lock_guard<std::mutex> lock(_interpMutex);
+          _interpCache.clear();
+          _interpCacheNext = 0;
+          ++_keyGeneration;
+          _interpReady.notify_all();
+        }
+        Instance::invalidateHash();
+      }
       
       //////////////////////////////////////////////////////////////////////////////////
       // Param::SetInstance
@@ -1625,34 +2220,47 @@ namespace OFX {
 
       /// ctor
       SetInstance::SetInstance()
+        : _hasLazyParams(false)
+        , _hashStatic(0)
+        , _hashCached(false)
+        , _hashCachedTime(0)
+        , _hashCachedValue(0)
+        , _journal()
       {}
 
       /// dtor. 
       SetInstance::~SetInstance()
       {
-        // iterate the params and delete them
-        std::list<Instance *>::iterator i;
-        for(i = _paramList.begin(); i != _paramList.end(); ++i) {
-          if(*i) 
-            delete (*i);
+        // iterate the params and delete them, through the map as params made lazily
+        // since the list was last built are only in that
+        std::map<std::string, Instance *>::iterator i;
+        for(i = _params.begin(); i != _params.end(); ++i) {
+          if(i->second) 
+            delete i->second;
         }
       }
 
       const std::map<std::string, Instance*> &SetInstance::getParams() const
       {
+        makeLazyParams();
         return _params;
       }
 
       const std::list<Instance*> &SetInstance::getParamList() const
       {
+        makeLazyParams();
         return _paramList;
       }
 
       OfxStatus SetInstance::addParam(const std::string& name, Instance* instance)
       {
-        if(_params.find(name)==_params.end()){
+        std::lock_guard<std::recursive_mutex> lock(_lazyMutex);
+        if(_params.find(name)==_params.end() && _lazyParams.find(name)==_lazyParams.end()){
           _params[name] = instance;
           _paramList.push_back(instance);
+          if(!_paramOrder.empty())
+            _paramOrder.push_back(name);
+          paramHashChanged(instance);
         }
         else
           return kOfxStatErrExists;
@@ -1660,6 +2268,242 @@ namespace OFX {
         return kOfxStatOK;
       }
 
+      OfxStatus SetInstance::addLazyParam(const std::string& name, Descriptor& descriptor)
+      {
+        std::lock_guard<std::recursive_mutex> lock(_lazyMutex);
+        if(_params.find(name)!=_params.end() || _lazyParams.find(name)!=_lazyParams.end())
+          return kOfxStatErrExists;
+
+        // remember the order, so getParamList is the same as if they were all added eagerly
+        if(_paramOrder.empty()) {
+          for(std::list<Instance*>::const_iterator it = _paramList.begin(); it != _paramList.end(); ++it)
+            _paramOrder.push_back((*it)->getName());
+        }
+        _paramOrder.push_back(name);
+        _lazyParams[name] = &descriptor;
+        _hasLazyParams.store(true, std::memory_order_release);
+        return kOfxStatOK;
+      }
+
+      /// make the lazy param with the given name, call with _lazyMutex held
+      OfxStatus SetInstance::makeLazyParam(const std::string &name, Instance *&instance) const
+      {
+        std::map<std::string, Descriptor*>::const_iterator it = _lazyParams.find(name);
+        if(it == _lazyParams.end())
+          return kOfxStatErrUnknown;
+
+        // making a param on demand doesn't change what the set holds, so this is still const
+        SetInstance *self = const_cast<SetInstance*>(this);
+        instance = self->newParam(name, *it->second);
+        if(!instance)
+          return kOfxStatFailed;
+
+        // newParam may have made other lazy params, so erase by name rather than through the iterator.
+        // The list is left alone, getParamList readers may be iterating it, it is rebuilt once the last is made
+        self->_lazyParams.erase(name);
+        self->_params[name] = instance;
+        self->paramHashChanged(instance);
+
+        // the eager path sets the parent through the group's children, here the parent may not be made yet
+        const std::string &parentName = instance->getParentName();
+        if(!parentName.empty()) {
+          Instance *parent = 0;
+          if(fetchParam(parentName, parent) == kOfxStatOK)
+            instance->setParentInstance(parent);
+        }
+
+        if(_lazyParams.empty())
+          finishLazyParams();
+        return kOfxStatOK;
+      }
+
+      /// put all the made params in the list, in the order they were added, and only then
+      /// publish that there are no lazy params left, call with _lazyMutex held
+      void SetInstance::finishLazyParams() const
+      {
+        SetInstance *self = const_cast<SetInstance*>(this);
+        std::list<Instance*> paramList;
+        for(size_t i = 0; i < _paramOrder.size(); ++i) {
+          std::map<std::string, Instance*>::const_iterator it = _params.find(_paramOrder[i]);
+          if(it != _params.end())
+            paramList.push_back(it->second);
+        }
+        self->_paramList.swap(paramList);
+        self->_paramOrder.clear();
+        self->_hasLazyParams.store(false, std::memory_order_release);
+      }
+
+      /// get the param, making it if it was added lazily, from any thread
+      OfxStatus SetInstance::fetchParam(const std::string &name, Instance *&instance) const
+      {
+        std::lock_guard<std::recursive_mutex> lock(_lazyMutex);
+        std::map<std::string, Instance*>::const_iterator it = _params.find(name);
+        if(it != _params.end()) {
+          instance = it->second;
+          return kOfxStatOK;
+        }
+        instance = 0;
+        return makeLazyParam(name, instance);
+      }
+
+      void SetInstance::makeLazyParams() const
+      {
+        if(!_hasLazyParams.load(std::memory_order_acquire))
+          return;
+
+        std::lock_guard<std::recursive_mutex> lock(_lazyMutex);
+        if(!_hasLazyParams.load(std::memory_order_relaxed))
+          return;
+
+        std::vector<std::string> names;
+        for(std::map<std::string, Descriptor*>::const_iterator it = _lazyParams.begin(); it != _lazyParams.end(); ++it)
+          names.push_back(it->first);
+        for(size_t i = 0; i < names.size(); ++i) {
+          Instance *instance = 0;
+          fetchParam(names[i], instance);
+        }
+
+        // drop any newParam failed on, so the list is final and callers can iterate it unlocked
+        if(!_lazyParams.empty()) {
+          const_cast<SetInstance*>(this)->_lazyParams.clear();
+          finishLazyParams();
+        }
+      }
+
+      /// make and get the params whose parent is the named group, in the order they were added
+      std::vector<Instance*> SetInstance::fetchChildParams(const std::string &groupName) const
+      {
+        std::vector<Instance*> children;
+        if(!_hasLazyParams.load(std::memory_order_acquire)) {
+          for(std::list<Instance*>::const_iterator it = _paramList.begin(); it != _paramList.end(); ++it) {
+            if((*it)->getParentName() == groupName)
+              children.push_back(*it);
+          }
+          return children;
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(_lazyMutex);
+        // a copy, as making the last lazy param clears the order
+        std::vector<std::string> names = _paramOrder;
+        for(size_t i = 0; i < names.size(); ++i) {
+          std::map<std::string, Instance*>::const_iterator made = _params.find(names[i]);
+          std::map<std::string, Descriptor*>::const_iterator lazy = _lazyParams.find(names[i]);
+          Instance *instance = 0;
+          if(made != _params.end()) {
+            if(made->second->getParentName() == groupName)
+              children.push_back(made->second);
+          }
+          else if(lazy != _lazyParams.end() && lazy->second->getParentName() == groupName) {
+            if(fetchParam(names[i], instance) == kOfxStatOK)
+              children.push_back(instance);
+          }
+        }
+        return children;
+      }
+
+      /// is the named param lazy and not made yet
+      bool SetInstance::isLazyParam(const std::string &name) const
+      {
+        std::lock_guard<std::recursive_mutex> lock(_lazyMutex);
+        return _lazyParams.find(name) != _lazyParams.end();
+      }
+
+      void SetInstance::setJournalling(bool journalling, size_t checkpointInterval)
+      {
+        _journal.reset(journalling ? new Journal(checkpointInterval) : 0);
+      }
+
+      /// queue a param to be rehashed, from any thread
+      void SetInstance::paramHashChanged(Instance *param)
+      {
+        std::lock_guard<std::mutex> lock(_hashDirtyMutex);
+        if(!param->_hashDirty) {
+          param->_hashDirty = true;
+          _hashDirtyParams.push_back(param);
+        }
+      }
+
+      /// take a param being deleted out of the hash
+      void SetInstance::paramHashRemoved(Instance *param)
+      {
+        {
+          std::lock_guard<std::mutex> lock(_hashDirtyMutex);
+          if(param->_hashDirty) {
+            _hashDirtyParams.erase(std::find(_hashDirtyParams.begin(), _hashDirtyParams.end(), param));
+            param->_hashDirty = false;
+          }
+        }
+
+        _hashStatic -= param->_hashStatic;
+        param->_hashStatic = 0;
+        if(param->_hashTimed) {
+          _hashTimedParams.erase(std::find(_hashTimedParams.begin(), _hashTimedParams.end(), param));
+          param->_hashTimed = false;
+        }
+        _hashCached = false;
+      }
+
+      /// get a stable hash of the render state of all the params at a time
+      uint64_t SetInstance::getParamStateHash(OfxTime time)
+      {
+        // what a param with the given value or content hash adds to the set's hash
+        struct Contribution {
+          static uint64_t get(const Instance *param, uint64_t hash) {return hashMix(hashBytes(&hash, sizeof(hash), param->_hashName));}
+        };
+
+        // take the changed params off the queue, so they can be queued again while they are rehashed
+        std::vector<Instance*> dirtyParams;
+        {
+          std::lock_guard<std::mutex> lock(_hashDirtyMutex);
+          dirtyParams.swap(_hashDirtyParams);
+          for(size_t i = 0; i < dirtyParams.size(); ++i)
+            dirtyParams[i]->_hashDirty = false;
+        }
+        if(!dirtyParams.empty())
+          _hashCached = false;
+
+        // move the changed params out of the hash and back in
+        for(size_t i = 0; i < dirtyParams.size(); ++i) {
+          Instance *param = dirtyParams[i];
+
+          _hashStatic -= param->_hashStatic;
+          param->_hashStatic = 0;
+          if(param->_hashTimed) {
+            _hashTimedParams.erase(std::find(_hashTimedParams.begin(), _hashTimedParams.end(), param));
+            param->_hashTimed = false;
+          }
+
+          const std::string &type = param->getType();
+          if(type == kOfxParamTypeGroup || type == kOfxParamTypePage || type == kOfxParamTypePushButton ||
+             !param->getEvaluateOnChange())
+            continue;
+
+          if(param->getHashIsTimed()) {
+            _hashTimedParams.push_back(param);
+            param->_hashTimed = true;
+          }
+          else {
+            param->_hashStatic = Contribution::get(param, param->getContentHash());
+            _hashStatic += param->_hashStatic;
+          }
+        }
+
+        if(_hashCached && _hashCachedTime == time)
+          return _hashCachedValue;
+
+        // the params are summed, so the order they are in doesn't matter
+        uint64_t hash = _hashStatic;
+        for(size_t i = 0; i < _hashTimedParams.size(); ++i) {
+          Instance *param = _hashTimedParams[i];
+          hash += Contribution::get(param, param->getValueHash(time));
+        }
+
+        _hashCached = true;
+        _hashCachedTime = time;
+        _hashCachedValue = hashMix(hash);
+        return _hashCachedValue;
+      }
+
       ////////////////////////////////////////////////////////////////////////////////
       // Suite functions below
 
@@ -1718,20 +2562,21 @@ namespace OFX {
         SetInstance *setInstance = dynamic_cast<SetInstance*>(baseSet);
 
         if(setInstance){          
-          const std::map<std::string,Instance*>& params = setInstance->getParams();
-          std::map<std::string,Instance*>::const_iterator it = params.find(name);         
+          // this makes the param if it was added lazily
+          Instance *instance = 0;
+          OfxStatus stat = setInstance->fetchParam(name, instance);
 
-          // if we can't find it return an error...
-          if(it==params.end()) {
+          // if we can't find or make it return an error...
+          if(stat != kOfxStatOK) {
 #           ifdef OFX_DEBUG_PARAMETERS
-            std::cout << ' '<< StatStr(kOfxStatErrUnknown) << std::endl;
+            std::cout << ' '<< StatStr(stat) << std::endl;
 #           endif
-            return kOfxStatErrUnknown;
+            return stat;
           }
 
           // get the param
           if (param) {
-            *param = (it->second)->getHandle();
+            *param = instance->getHandle();
 #           ifdef OFX_DEBUG_PARAMETERS
             std::cout << ' ' << *param;
 #           endif
@@ -1739,7 +2584,7 @@ namespace OFX {
 
           // get the param property set
           if(propertySet) {
-            *propertySet = (it->second)->getPropHandle();
+            *propertySet = instance->getPropHandle();
 #           ifdef OFX_DEBUG_PARAMETERS
             std::cout << ' ' << *propertySet;
 #           endif
@@ -1979,6 +2824,13 @@ namespace OFX {
         return stat;
       }
 
+      /// the journal of the set a param is in, NULL if it isn't journalling
+      static Journal *getJournal(Instance *param)
+      {
+        SetInstance *setInstance = param->getParamSetInstance();
+        return setInstance ? setInstance->getJournal() : 0;
+      }
+
       /// set the param's value at the 'current' time
       static OfxStatus paramSetValue(OfxParamHandle  paramHandle,
                                      ...) 
@@ -1994,6 +2846,10 @@ namespace OFX {
           return kOfxStatErrBadHandle;
         }
 
+        Journal *journal = getJournal(paramInstance);
+        if(journal)
+          journal->aboutToChange(*paramInstance);
+
         va_list ap;
         va_start(ap, paramHandle);
         OfxStatus stat = kOfxStatErrUnsupported;
@@ -2006,6 +2862,9 @@ namespace OFX {
         va_end(ap);
 
         if (stat == kOfxStatOK) {
+          if(journal)
+            journal->recordValue(*paramInstance);
+          paramInstance->invalidateHash();
           paramInstance->getParamSetInstance()->paramChangedByPlugin(paramInstance);
         }
 
@@ -2032,6 +2891,10 @@ namespace OFX {
           return kOfxStatErrBadHandle;
         }
 
+        Journal *journal = getJournal(paramInstance);
+        if(journal)
+          journal->aboutToChange(*paramInstance);
+
         va_list ap;
         va_start(ap, time);
         OfxStatus stat = kOfxStatErrUnsupported;
@@ -2044,6 +2907,9 @@ namespace OFX {
         va_end(ap);
 
         if (stat == kOfxStatOK) {
+          if(journal)
+            journal->recordKey(*paramInstance, time);
+          paramInstance->invalidateHash();
           paramInstance->getParamSetInstance()->paramChangedByPlugin(paramInstance);
         }
 
@@ -2168,7 +3034,15 @@ namespace OFX {
 #         endif
           return kOfxStatErrBadHandle;
         }
+        Journal *journal = getJournal(pInstance);
+        if(journal)
+          journal->aboutToChange(*pInstance);
         OfxStatus stat = paramInstance->deleteKey(time);
+        if(stat == kOfxStatOK) {
+          if(journal)
+            journal->recordDeleteKey(*pInstance, time);
+          pInstance->invalidateHash();
+        }
 #       ifdef OFX_DEBUG_PARAMETERS
         std::cout << ' ' << StatStr(stat) << std::endl;
 #       endif
@@ -2196,7 +3070,15 @@ namespace OFX {
 #         endif
           return kOfxStatErrBadHandle;
         }
+        Journal *journal = getJournal(pInstance);
+        if(journal)
+          journal->aboutToChange(*pInstance);
         OfxStatus stat = paramInstance->deleteAllKeys();
+        if(stat == kOfxStatOK) {
+          if(journal)
+            journal->recordDeleteAllKeys(*pInstance);
+          pInstance->invalidateHash();
+        }
 #       ifdef OFX_DEBUG_PARAMETERS
         std::cout << ' ' << StatStr(stat) << std::endl;
 #       endif
@@ -2221,7 +3103,15 @@ namespace OFX {
           return kOfxStatErrBadHandle;
         }
 
+        Journal *journal = getJournal(paramInstanceTo);
+        if(journal)
+          journal->aboutToChange(*paramInstanceTo);
         OfxStatus stat = paramInstanceTo->copyFrom(*paramInstanceFrom,dstOffset,frameRange);
+        if(stat == kOfxStatOK) {
+          if(journal)
+            journal->recordState(*paramInstanceTo);
+          paramInstanceTo->invalidateHash();
+        }
 #       ifdef OFX_DEBUG_PARAMETERS
         std::cout << ' ' << StatStr(stat) << std::endl;
 #       endif
@@ -2240,6 +3130,8 @@ namespace OFX {
 #         endif
           return kOfxStatErrBadHandle;
         }
+        if(setInstance->getJournal())
+          setInstance->getJournal()->beginBlock();
         OfxStatus stat = setInstance->editBegin(std::string(name));
 #       ifdef OFX_DEBUG_PARAMETERS
         std::cout << ' ' << StatStr(stat) << std::endl;
@@ -2259,6 +3151,8 @@ namespace OFX {
 #         endif
           return kOfxStatErrBadHandle;
         }
+        if(setInstance->getJournal())
+          setInstance->getJournal()->endBlock();
         OfxStatus stat = setInstance->editEnd();
 #       ifdef OFX_DEBUG_PARAMETERS
         std::cout << ' ' << StatStr(stat) << std::endl;
@@ -0,0 +1,527 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <string.h>
+#include <algorithm>
+
+// ofx
+#include "ofxCore.h"
+#include "ofxParam.h"
+
+// ofx host
+#include "ofxhParam.h"
+#include "ofxhParamJournal.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Param {
+
+      //
+      // encoding helpers
+      //
+
+      /// append an unsigned LEB128 varint
+      static void writeVarint(std::vector<unsigned char> &out, uint64_t value)
+      {
+        while(value >= 0x80) {
+          out.push_back((unsigned char)(value | 0x80));
+          value >>= 7;
+        }
+        out.push_back((unsigned char)value);
+      }
+
+      static uint64_t readVarint(const unsigned char *&data)
+      {
+        uint64_t value = 0;
+        int shift = 0;
+        unsigned char byte;
+        do {
+          byte = *data++;
+          value |= uint64_t(byte & 0x7f) << shift;
+          shift += 7;
+        } while(byte & 0x80);
+        return value;
+      }
+
+      /// append bits as their XOR with base, as a header byte of the number of trailing zero
+      /// bytes and the number of bytes that follow, then those bytes
+      static void writeXor(std::vector<unsigned char> &out, uint64_t bits, uint64_t base)
+      {
+        uint64_t x = bits ^ base;
+        if(x == 0) {
+          out.push_back(0);
+          return;
+        }
+        int trailing = 0;
+        while(!(x & 0xff)) {
+          x >>= 8;
+          ++trailing;
+        }
+        int length = 0;
+        for(uint64_t rest = x; rest; rest >>= 8)
+          ++length;
+        out.push_back((unsigned char)((trailing << 4) | length));
+        for(int i = 0; i < length; ++i, x >>= 8)
+          out.push_back((unsigned char)x);
+      }
+
+      static uint64_t readXor(const unsigned char *&data, uint64_t base)
+      {
+        unsigned char header = *data++;
+        int trailing = header >> 4;
+        int length = header & 0xf;
+        uint64_t x = 0;
+        for(int i = 0; i < length; ++i)
+          x |= uint64_t(*data++) << (8 * i);
+        return base ^ (x << (8 * trailing));
+      }
+
+      static uint64_t doubleBits(double value)
+      {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+      }
+
+      static double bitsDouble(uint64_t bits)
+      {
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+      }
+
+      /// can the journal log the param
+      static bool isLoggable(Instance &param)
+      {
+        return param.getValueType() == Property::eInt ||
+          param.getValueType() == Property::eDouble ||
+          dynamic_cast<StringInstance*>(&param) != 0;
+      }
+
+      /// get the keys of a param, none if it has no keyframes
+      static unsigned int getNumKeys(Instance &param)
+      {
+        KeyframeParam *keyframes = dynamic_cast<KeyframeParam*>(&param);
+        unsigned int nKeys = 0;
+        if(!keyframes || keyframes->getNumKeys(nKeys) != kOfxStatOK)
+          return 0;
+        return nKeys;
+      }
+
+      //
+      // Journal
+      //
+
+      Journal::Journal(size_t checkpointInterval)
+        : _checkpointInterval(checkpointInterval > 0 ? checkpointInterval : 1)
+        , _size(0)
+        , _position(0)
+        , _offset(0)
+        , _blockDepth(0)
+      {
+        checkpoint();
+      }
+
+      void Journal::writeValue(std::vector<unsigned char> &out, Instance &param, const OfxTime *time, Base &base)
+      {
+        const int n = param.getValueDimension();
+        if(param.getValueType() == Property::eDouble) {
+          base.values.resize(n, 0);
+          double values[4];
+          if((time ? param.getDouble(*time, values, n) : param.getDouble(values, n)) != kOfxStatOK) {
+            for(int i = 0; i < n; ++i)
+              values[i] = bitsDouble(base.values[i]);
+          }
+          for(int i = 0; i < n; ++i) {
+            uint64_t bits = doubleBits(values[i]);
+            writeXor(out, bits, base.values[i]);
+            base.values[i] = bits;
+          }
+        }
+        else if(param.getValueType() == Property::eInt) {
+          base.values.resize(n, 0);
+          int values[4];
+          if((time ? param.getInt(*time, values, n) : param.getInt(values, n)) != kOfxStatOK) {
+            for(int i = 0; i < n; ++i)
+              values[i] = int(base.values[i]);
+          }
+          for(int i = 0; i < n; ++i) {
+            // zigzag, so small negative deltas are small too
+            int64_t delta = int64_t(values[i]) - int64_t(int(base.values[i]));
+            writeVarint(out, (uint64_t(delta) << 1) ^ uint64_t(delta >> 63));
+            base.values[i] = uint64_t(int64_t(values[i]));
+          }
+        }
+        else if(StringInstance *stringParam = dynamic_cast<StringInstance*>(&param)) {
+          std::string value;
+          if(time)
+            stringParam->get(*time, value);
+          else
+            stringParam->get(value);
+          writeVarint(out, value.size());
+          out.insert(out.end(), value.begin(), value.end());
+        }
+      }
+
+      void Journal::applyValue(const unsigned char *&data, Instance &param, const OfxTime *time, Base &base)
+      {
+        const int n = param.getValueDimension();
+        if(param.getValueType() == Property::eDouble) {
+          base.values.resize(n, 0);
+          double values[4];
+          for(int i = 0; i < n; ++i) {
+            base.values[i] = readXor(data, base.values[i]);
+            values[i] = bitsDouble(base.values[i]);
+          }
+          if(time)
+            param.setDouble(*time, values, n);
+          else
+            param.setDouble(values, n);
+        }
+        else if(param.getValueType() == Property::eInt) {
+          base.values.resize(n, 0);
+          int values[4];
+          for(int i = 0; i < n; ++i) {
+            uint64_t zigzag = readVarint(data);
+            int64_t delta = int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+            values[i] = int(int64_t(int(base.values[i])) + delta);
+            base.values[i] = uint64_t(int64_t(values[i]));
+          }
+          if(time)
+            param.setInt(*time, values, n);
+          else
+            param.setInt(values, n);
+        }
+        else if(StringInstance *stringParam = dynamic_cast<StringInstance*>(&param)) {
+          size_t length = size_t(readVarint(data));
+          std::string value(reinterpret_cast<const char*>(data), length);
+          data += length;
+          if(time)
+            stringParam->set(*time, value.c_str());
+          else
+            stringParam->set(value.c_str());
+        }
+      }
+
+      void Journal::writeState(std::vector<unsigned char> &out, Instance &param)
+      {
+        // the keys, or the value if there are none, relative to each other
+        Base base;
+        unsigned int nKeys = getNumKeys(param);
+        writeVarint(out, nKeys);
+        if(nKeys == 0) {
+          writeValue(out, param, 0, base);
+          return;
+        }
+
+        KeyframeParam *keyframes = dynamic_cast<KeyframeParam*>(&param);
+        for(unsigned int i = 0; i < nKeys; ++i) {
+          OfxTime time = 0;
+          keyframes->getKeyTime(int(i), time);
+          uint64_t bits = doubleBits(time);
+          writeXor(out, bits, base.time);
+          base.time = bits;
+          writeValue(out, param, &time, base);
+        }
+      }
+
+      int Journal::getIndex(Instance &param)
+      {
+        std::map<Instance*, unsigned>::const_iterator it = _indices.find(&param);
+        if(it != _indices.end())
+          return int(it->second);
+
+        // not told beforehand, so the best we can do is to take the state now
+        aboutToChange(param);
+        it = _indices.find(&param);
+        return it != _indices.end() ? int(it->second) : -1;
+      }
+
+      void Journal::aboutToChange(Instance &param)
+      {
+        if(_indices.find(&param) != _indices.end() || !isLoggable(param))
+          return;
+
+        unsigned index = unsigned(_params.size());
+        _params.push_back(&param);
+        _indices[&param] = index;
+        _bases.resize(_params.size());
+
+        // the param hasn't changed since any of the checkpoints, so they all get its state now
+        std::vector<unsigned char> state;
+        writeVarint(state, index);
+        writeState(state, param);
+        for(size_t i = 0; i < _checkpoints.size(); ++i)
+          _checkpoints[i].state.insert(_checkpoints[i].state.end(), state.begin(), state.end());
+      }
+
+      void Journal::beginEntry(EntryEnum kind, int index)
+      {
+        if(_position < _size) {
+          // we've been moved back, so what came after is gone
+          _log.resize(_offset);
+          _size = _position;
+          while(_checkpoints.size() > 1 && _checkpoints.back().position > _position)
+            _checkpoints.pop_back();
+          while(!_blockEnds.empty() && _blockEnds.back() > _position)
+            _blockEnds.pop_back();
+        }
+
+        _log.push_back((unsigned char)kind);
+        writeVarint(_log, unsigned(index));
+      }
+
+      void Journal::endEntry()
+      {
+        ++_size;
+        ++_position;
+        _offset = _log.size();
+
+        if(_blockDepth == 0)
+          _blockEnds.push_back(_position);
+
+        if(_position - _checkpoints.back().position >= _checkpointInterval)
+          checkpoint();
+      }
+
+      void Journal::recordValue(Instance &param)
+      {
+        int index = getIndex(param);
+        if(index < 0)
+          return;
+        beginEntry(eEntryValue, index);
+        writeValue(_log, param, 0, _bases[index]);
+        endEntry();
+      }
+
+      void Journal::recordKey(Instance &param, OfxTime time)
+      {
+        int index = getIndex(param);
+        if(index < 0)
+          return;
+        beginEntry(eEntryKey, index);
+        Base &base = _bases[index];
+        uint64_t bits = doubleBits(time);
+        writeXor(_log, bits, base.time);
+        base.time = bits;
+        writeValue(_log, param, &time, base);
+        endEntry();
+      }
+
+      void Journal::recordDeleteKey(Instance &param, OfxTime time)
+      {
+        int index = getIndex(param);
+        if(index < 0)
+          return;
+        beginEntry(eEntryDeleteKey, index);
+        Base &base = _bases[index];
+        uint64_t bits = doubleBits(time);
+        writeXor(_log, bits, base.time);
+        base.time = bits;
+        endEntry();
+      }
+
+      void Journal::recordDeleteAllKeys(Instance &param)
+      {
+        int index = getIndex(param);
+        if(index < 0)
+          return;
+        beginEntry(eEntryDeleteAllKeys, index);
+        endEntry();
+      }
+
+      void Journal::recordState(Instance &param)
+      {
+        int index = getIndex(param);
+        if(index < 0)
+          return;
+        beginEntry(eEntryState, index);
+        writeState(_log, param);
+        endEntry();
+      }
+
+      void Journal::beginBlock()
+      {
+        ++_blockDepth;
+      }
+
+      void Journal::endBlock()
+      {
+        if(_blockDepth == 0)
+          return;
+        if(--_blockDepth == 0 && _position > 0 && (_blockEnds.empty() || _blockEnds.back() != _position))
+          _blockEnds.push_back(_position);
+      }
+
+      void Journal::checkpoint()
+      {
+        if(_position != _size)
+          return;
+        if(!_checkpoints.empty() && _checkpoints.back().position == _position)
+          return;
+
+        Checkpoint checkpoint;
+        checkpoint.position = _position;
+        checkpoint.offset = _offset;
+        for(size_t i = 0; i < _params.size(); ++i) {
+          writeVarint(checkpoint.state, i);
+          writeState(checkpoint.state, *_params[i]);
+        }
+        _checkpoints.push_back(checkpoint);
+
+        // the log after a checkpoint only refers back to it
+        _bases.assign(_params.size(), Base());
+      }
+
+      void Journal::applyState(const unsigned char *&data, Instance &param)
+      {
+        KeyframeParam *keyframes = dynamic_cast<KeyframeParam*>(&param);
+        if(keyframes && getNumKeys(param) > 0)
+          keyframes->deleteAllKeys();
+
+        Base base;
+        unsigned int nKeys = unsigned(readVarint(data));
+        if(nKeys == 0)
+          applyValue(data, param, 0, base);
+        for(unsigned int i = 0; i < nKeys; ++i) {
+          base.time = readXor(data, base.time);
+          OfxTime time = bitsDouble(base.time);
+          applyValue(data, param, &time, base);
+        }
+      }
+
+      Instance *Journal::applyEntry(const unsigned char *&data)
+      {
+        EntryEnum kind = EntryEnum(*data++);
+        size_t index = size_t(readVarint(data));
+        Instance *param = _params[index];
+        Base &base = _bases[index];
+        KeyframeParam *keyframes = dynamic_cast<KeyframeParam*>(param);
+
+        switch(kind) {
+        case eEntryValue :
+          applyValue(data, *param, 0, base);
+          break;
+        case eEntryKey : {
+          base.time = readXor(data, base.time);
+          OfxTime time = bitsDouble(base.time);
+          applyValue(data, *param, &time, base);
+          break;
+        }
+        case eEntryDeleteKey :
+          base.time = readXor(data, base.time);
+          if(keyframes)
+            keyframes->deleteKey(bitsDouble(base.time));
+          break;
+        case eEntryDeleteAllKeys :
+          if(keyframes)
+            keyframes->deleteAllKeys();
+          break;
+        case eEntryState :
+          applyState(data, *param);
+          break;
+        }
+        return param;
+      }
+
+      OfxStatus Journal::setPosition(size_t position, std::vector<Instance*> *changed)
+      {
+        if(position > _size)
+          return kOfxStatErrValue;
+
+        std::vector<uint64_t> hashes;
+        if(changed) {
+          hashes.resize(_params.size());
+          for(size_t i = 0; i < _params.size(); ++i)
+            hashes[i] = _params[i]->getContentHash();
+        }
+
+        // the last checkpoint at or before the position
+        size_t c = _checkpoints.size() - 1;
+        while(c > 0 && _checkpoints[c].position > position)
+          --c;
+        const Checkpoint &checkpoint = _checkpoints[c];
+
+        // restore it in bulk
+        std::vector<bool> touched(_params.size(), false);
+        const unsigned char *data = checkpoint.state.empty() ? 0 : &checkpoint.state[0];
+        const unsigned char *end = data + checkpoint.state.size();
+        while(data < end) {
+          size_t index = size_t(readVarint(data));
+          applyState(data, *_params[index]);
+          touched[index] = true;
+        }
+
+        // then replay the log from there
+        _bases.assign(_params.size(), Base());
+        data = _log.empty() ? 0 : &_log[0];
+        const unsigned char *entry = data + checkpoint.offset;
+        for(size_t i = checkpoint.position; i < position; ++i) {
+          Instance *param = applyEntry(entry);
+          touched[_indices[param]] = true;
+        }
+        _position = position;
+        _offset = size_t(entry - data);
+
+        for(size_t i = 0; i < _params.size(); ++i) {
+          if(!touched[i])
+            continue;
+          _params[i]->invalidateHash();
+          if(changed && _params[i]->getContentHash() != hashes[i])
+            changed->push_back(_params[i]);
+        }
+
+        return kOfxStatOK;
+      }
+
+      bool Journal::undo(std::vector<Instance*> *changed)
+      {
+        if(_position == 0)
+          return false;
+        std::vector<size_t>::const_iterator it = std::lower_bound(_blockEnds.begin(), _blockEnds.end(), _position);
+        size_t target = it == _blockEnds.begin() ? 0 : *(it - 1);
+        return setPosition(target, changed) == kOfxStatOK;
+      }
+
+      bool Journal::redo(std::vector<Instance*> *changed)
+      {
+        if(_position >= _size)
+          return false;
+        std::vector<size_t>::const_iterator it = std::upper_bound(_blockEnds.begin(), _blockEnds.end(), _position);
+        size_t target = it == _blockEnds.end() ? _size : std::min(*it, _size);
+        return setPosition(target, changed) == kOfxStatOK;
+      }
+
+      size_t Journal::getMemoryUsage() const
+      {
+        size_t bytes = sizeof(*this) + _log.capacity() +
+          _params.capacity() * sizeof(Instance*) +
+          _indices.size() * (sizeof(Instance*) + sizeof(unsigned) + 4 * sizeof(void*)) +
+          _blockEnds.capacity() * sizeof(size_t);
+        for(size_t i = 0; i < _bases.size(); ++i)
+          bytes += sizeof(Base) + _bases[i].values.capacity() * sizeof(uint64_t);
+        for(size_t i = 0; i < _checkpoints.size(); ++i)
+          bytes += sizeof(Checkpoint) + _checkpoints[i].state.capacity();
+        return bytes;
+      }
+
+      void Journal::clear()
+      {
+        _params.clear();
+        _indices.clear();
+        _log.clear();
+        _size = _position = _offset = 0;
+        _bases.clear();
+        _checkpoints.clear();
+        _blockEnds.clear();
+        _blockDepth = 0;
+        checkpoint();
+      }
+
+    } // Param
+
+  } // Host
+
+} // OFX
@@ -0,0 +1,728 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+
+// ofx
+#include "ofxCore.h"
+#include "ofxParametricParam.h"
+
+// ofx host
+#include "ofxhPropertySuite.h"
+#include "ofxhParam.h"
+#include "ofxhParametricParam.h"
+#include "ofxhUtilities.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace ParametricParam {
+
+      /// property on parametric param descriptors holding the control points the plugin set
+      /// on them, as (curve index, key, value) triples, which instances start off with
+      static const char *const kDefaultControlPointsProp = "OfxHostParametricPropDefaultControlPoints";
+
+      /// control points closer than this are the same point, see parametricParamAddControlPoint
+      static const double kKeyTolerance = 1e-6;
+
+      /// key/value pairs of a curve
+      typedef std::vector<std::pair<double, double> > ControlPointList;
+
+      /// set a curve to go through the given points
+      static void makeCurve(Animation::Curve &curve, const std::vector<double> &keys, const std::vector<double> &values)
+      {
+        curve.deleteAllKeys();
+        for(size_t i = 0; i < keys.size(); ++i)
+          curve.setKey(keys[i], &values[i], Animation::eInterpolationSmooth);
+      }
+
+      /// evaluate a curve made by makeCurve, which is the identity if there are no points
+      static double evaluateCurve(const Animation::Curve &curve, double position)
+      {
+        if(!curve.isAnimating())
+          return position;
+        double value;
+        curve.getValue(position, &value);
+        return value;
+      }
+
+      //
+      // descriptors
+      //
+
+      /// get the default points of a curve off a descriptor, sorted by key
+      static ControlPointList getDefaultControlPoints(const Property::Set &properties, int curveIndex)
+      {
+        ControlPointList points;
+        if(!properties.fetchProperty(kDefaultControlPointsProp))
+          return points;
+
+        int n = properties.getDimension(kDefaultControlPointsProp);
+        if(n == 0)
+          return points;
+        std::vector<double> triples(n);
+        properties.getDoublePropertyN(kDefaultControlPointsProp, &triples[0], n);
+
+        for(int i = 0; i + 2 < n; i += 3) {
+          if(int(triples[i]) == curveIndex)
+            points.push_back(std::make_pair(triples[i + 1], triples[i + 2]));
+        }
+        std::sort(points.begin(), points.end());
+        return points;
+      }
+
+      /// set the default points of a curve on a descriptor
+      static void setDefaultControlPoints(Property::Set &properties, int curveIndex, const ControlPointList &points)
+      {
+        static const Property::PropSpec spec = {kDefaultControlPointsProp, Property::eDouble, 0, true, ""};
+        properties.createProperty(spec);
+
+        // keep the points of the other curves
+        std::vector<double> triples;
+        int n = properties.getDimension(kDefaultControlPointsProp);
+        if(n > 0) {
+          std::vector<double> old(n);
+          properties.getDoublePropertyN(kDefaultControlPointsProp, &old[0], n);
+          for(int i = 0; i + 2 < n; i += 3) {
+            if(int(old[i]) != curveIndex)
+              triples.insert(triples.end(), &old[i], &old[i] + 3);
+          }
+        }
+
+        for(size_t i = 0; i < points.size(); ++i) {
+          triples.push_back(curveIndex);
+          triples.push_back(points[i].first);
+          triples.push_back(points[i].second);
+        }
+
+        properties.setDoublePropertyN(kDefaultControlPointsProp, triples.empty() ? 0 : &triples[0], int(triples.size()));
+      }
+
+      /// check the curve index against the dimension of a descriptor
+      static bool isValidCurve(const Property::Set &properties, int curveIndex)
+      {
+        return curveIndex >= 0 && curveIndex < properties.getIntProperty(kOfxParamPropParametricDimension);
+      }
+
+      //
+      // ParametricInstance
+      //
+
+      thread_local ParametricInstance::ThreadCache ParametricInstance::_threadCaches[ParametricInstance::kThreadCaches];
+
+      /// get a generation no instance has had before, so a new instance at an old one's address does not match its thread caches
+      static uint64_t nextGeneration()
+      {
+        static std::atomic<uint64_t> generation(0);
+        return ++generation;
+      }
+
+      /// ctor, picks up the dimension and default points from the descriptor
+      ParametricInstance::ParametricInstance(Param::Descriptor& descriptor, Param::SetInstance* setInstance)
+        : Param::Instance(descriptor, setInstance)
+        , _lutSize(0)
+        , _generation(nextGeneration())
+      {
+        int dimension = std::max(_properties.getIntProperty(kOfxParamPropParametricDimension), 1);
+        _controlPoints.resize(dimension);
+        _caches.resize(dimension);
+
+        for(int i = 0; i < dimension; ++i) {
+          ControlPointList points = getDefaultControlPoints(_properties, i);
+          for(size_t j = 0; j < points.size(); ++j) {
+            double keyValue[2] = {points[j].first, points[j].second};
+            _controlPoints[i].push_back(Animation::Curve(2, keyValue));
+          }
+        }
+      }
+
+      /// get the key and value of the points of a curve at a time, sorted by key, with the index of each in _controlPoints
+      void ParametricInstance::getControlPoints(int curveIndex, OfxTime time, std::vector<double> &keys, std::vector<double> &values, std::vector<int> &indices) const
+      {
+        const std::vector<Animation::Curve> &points = _controlPoints[curveIndex];
+        int n = int(points.size());
+
+        std::vector<std::pair<double, int> > order(n);
+        std::vector<double> pointValues(n);
+        for(int i = 0; i < n; ++i) {
+          double keyValue[2];
+          points[i].getValue(time, keyValue);
+          order[i] = std::make_pair(keyValue[0], i);
+          pointValues[i] = keyValue[1];
+        }
+        std::stable_sort(order.begin(), order.end());
+
+        keys.resize(n);
+        values.resize(n);
+        indices.resize(n);
+        for(int i = 0; i < n; ++i) {
+          keys[i] = order[i].first;
+          indices[i] = order[i].second;
+          values[i] = pointValues[order[i].second];
+        }
+      }
+
+      /// set a point, keying it if asked to or if it is already animating, call with the mutex held
+      void ParametricInstance::setControlPoint(Animation::Curve &point, OfxTime time, double key, double value, bool addAnimationKey)
+      {
+        double keyValue[2] = {key, value};
+        if((addAnimationKey && getCanAnimate()) || point.isAnimating())
+          point.setKey(time, keyValue);
+        else
+          point.setDefault(keyValue);
+      }
+
+      /// put the points of a curve back in key order and drop its caches, call with the mutex held
+      void ParametricInstance::controlPointsChanged(int curveIndex, OfxTime time)
+      {
+        std::vector<double> keys, values;
+        std::vector<int> indices;
+        getControlPoints(curveIndex, time, keys, values, indices);
+
+        std::vector<Animation::Curve> sorted;
+        sorted.reserve(indices.size());
+        for(size_t i = 0; i < indices.size(); ++i)
+          sorted.push_back(_controlPoints[curveIndex][indices[i]]);
+        _controlPoints[curveIndex].swap(sorted);
+
+        clearCaches(curveIndex);
+      }
+
+      /// drop the cached times of a curve and move to a new generation, call with the mutex held
+      void ParametricInstance::clearCaches(int curveIndex)
+      {
+        CurveCaches &caches = _caches[curveIndex];
+        for(int i = 0; i < kCachedTimes; ++i)
+          caches.entries[i].reset();
+        _generation.store(nextGeneration(), std::memory_order_release);
+      }
+
+      /// get the curve at a time, from the cache if it is there, otherwise made and cached, call
+      /// without the mutex held, the reference is good until the thread's next call
+      const ParametricInstance::CurveCache &ParametricInstance::fetchCache(int curveIndex, OfxTime time)
+      {
+        // the last curve the thread used in this slot is still good if nothing changed since
+        ThreadCache &mine = _threadCaches[curveIndex % kThreadCaches];
+        if(mine.owner == this && mine.curveIndex == curveIndex && mine.time == time &&
+           mine.generation == _generation.load(std::memory_order_acquire))
+          return *mine.cache;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        CurveCaches &caches = _caches[curveIndex];
+        std::shared_ptr<const CurveCache> found;
+        for(int i = 0; i < kCachedTimes && !found; ++i)
+          if(caches.entries[i] && caches.entries[i]->time == time)
+            found = caches.entries[i];
+
+        if(!found) {
+          std::shared_ptr<CurveCache> cache = std::make_shared<CurveCache>();
+          std::vector<double> keys, values;
+          std::vector<int> indices;
+          getControlPoints(curveIndex, time, keys, values, indices);
+          makeCurve(cache->curve, keys, values);
+
+          double range[2] = {0., 1.};
+          _properties.getDoublePropertyN(kOfxParamPropParametricRange, range, 2);
+          if(_lutSize >= 2 && range[1] > range[0]) {
+            std::vector<double> positions(_lutSize);
+            double step = (range[1] - range[0]) / (_lutSize - 1);
+            for(int i = 0; i < _lutSize; ++i)
+              positions[i] = range[0] + i * step;
+
+            if(cache->curve.isAnimating()) {
+              cache->lut.resize(_lutSize);
+              cache->curve.getValues(&positions[0], _lutSize, &cache->lut[0]);
+            }
+            else {
+              cache->lut.swap(positions);
+            }
+            cache->lutMin = range[0];
+            cache->lutScale = 1. / step;
+          }
+          cache->time = time;
+
+          // replace the oldest time
+          found = cache;
+          caches.entries[caches.next] = found;
+          caches.next = (caches.next + 1) % kCachedTimes;
+        }
+
+        mine.owner = this;
+        mine.curveIndex = curveIndex;
+        mine.time = time;
+        mine.generation = _generation.load(std::memory_order_relaxed);
+        mine.cache = found;
+        return *found;
+      }
+
+      /// set the number of entries in the LUT baked for each curve
+      void ParametricInstance::setLUTSize(int size)
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _lutSize = std::max(size, 0);
+        for(int i = 0; i < getCurveCount(); ++i)
+          clearCaches(i);
+      }
+
+      /// get the number of entries in the LUT baked for each curve
+      int ParametricInstance::getLUTSize() const
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _lutSize;
+      }
+
+      /// evaluate a curve
+      OfxStatus ParametricInstance::getValue(int curveIndex, OfxTime time, double parametricPosition, double *returnValue)
+      {
+        if(curveIndex < 0 || curveIndex >= getCurveCount())
+          return kOfxStatErrBadIndex;
+
+        const CurveCache &cache = fetchCache(curveIndex, time);
+
+        // within the range, look it up
+        if(!cache.lut.empty()) {
+          int last = int(cache.lut.size()) - 1;
+          double position = (parametricPosition - cache.lutMin) * cache.lutScale;
+          if(position >= 0. && position <= last) {
+            int i = std::min(int(position), last - 1);
+            double s = position - i;
+            *returnValue = cache.lut[i] + s * (cache.lut[i + 1] - cache.lut[i]);
+            return kOfxStatOK;
+          }
+        }
+
+        *returnValue = evaluateCurve(cache.curve, parametricPosition);
+        return kOfxStatOK;
+      }
+
+      /// get the number of control points on a curve
+      OfxStatus ParametricInstance::getNControlPoints(int curveIndex, OfxTime /*time*/, int *returnValue)
+      {
+        if(curveIndex < 0 || curveIndex >= getCurveCount())
+          return kOfxStatErrBadIndex;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        *returnValue = int(_controlPoints[curveIndex].size());
+        return kOfxStatOK;
+      }
+
+      /// get the key and value of the nth control point of a curve at the time
+      OfxStatus ParametricInstance::getNthControlPoint(int curveIndex, OfxTime time, int nthCtl, double *key, double *value)
+      {
+        if(curveIndex < 0 || curveIndex >= getCurveCount())
+          return kOfxStatErrBadIndex;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(nthCtl < 0 || nthCtl >= int(_controlPoints[curveIndex].size()))
+          return kOfxStatErrBadIndex;
+
+        double keyValue[2];
+        _controlPoints[curveIndex][nthCtl].getValue(time, keyValue);
+        *key = keyValue[0];
+        *value = keyValue[1];
+        return kOfxStatOK;
+      }
+
+      /// modify the nth control point of a curve at the time
+      OfxStatus ParametricInstance::setNthControlPoint(int curveIndex, OfxTime time, int nthCtl, double key, double value, bool addAnimationKey)
+      {
+        if(curveIndex < 0 || curveIndex >= getCurveCount())
+          return kOfxStatErrBadIndex;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(nthCtl < 0 || nthCtl >= int(_controlPoints[curveIndex].size()))
+          return kOfxStatErrBadIndex;
+
+        setControlPoint(_controlPoints[curveIndex][nthCtl], time, key, value, addAnimationKey);
+        controlPointsChanged(curveIndex, time);
+        invalidateHash();
+        return kOfxStatOK;
+      }
+
+      /// add a control point to a curve, or set the one sufficiently close to key
+      OfxStatus ParametricInstance::addControlPoint(int curveIndex, OfxTime time, double key, double value, bool addAnimationKey)
+      {
+        if(curveIndex < 0 || curveIndex >= getCurveCount())
+          return kOfxStatErrBadIndex;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<double> keys, values;
+        std::vector<int> indices;
+        getControlPoints(curveIndex, time, keys, values, indices);
+
+        std::vector<double>::iterator it = std::lower_bound(keys.begin(), keys.end(), key - kKeyTolerance);
+        if(it != keys.end() && fabs(*it - key) <= kKeyTolerance) {
+          setControlPoint(_controlPoints[curveIndex][indices[it - keys.begin()]], time, key, value, addAnimationKey);
+        }
+        else {
+          _controlPoints[curveIndex].push_back(Animation::Curve(2));
+          setControlPoint(_controlPoints[curveIndex].back(), time, key, value, addAnimationKey);
+        }
+
+        controlPointsChanged(curveIndex, time);
+        invalidateHash();
+        return kOfxStatOK;
+      }
+
+      /// delete the nth control point of a curve
+      OfxStatus ParametricInstance::deleteControlPoint(int curveIndex, int nthCtl)
+      {
+        if(curveIndex < 0 || curveIndex >= getCurveCount())
+          return kOfxStatErrBadIndex;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<Animation::Curve> &points = _controlPoints[curveIndex];
+        if(nthCtl < 0 || nthCtl >= int(points.size()))
+          return kOfxStatErrBadIndex;
+
+        points.erase(points.begin() + nthCtl);
+        clearCaches(curveIndex);
+        invalidateHash();
+        return kOfxStatOK;
+      }
+
+      /// delete all the control points of a curve
+      OfxStatus ParametricInstance::deleteAllControlPoints(int curveIndex)
+      {
+        if(curveIndex < 0 || curveIndex >= getCurveCount())
+          return kOfxStatErrBadIndex;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _controlPoints[curveIndex].clear();
+        clearCaches(curveIndex);
+        invalidateHash();
+        return kOfxStatOK;
+      }
+
+      /// the hash is timed if any point is animating and the param invalidates on value changes
+      bool ParametricInstance::getHashIsTimed()
+      {
+        if(getCacheInvalidation() != kOfxParamInvalidateValueChange)
+          return false;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(size_t i = 0; i < _controlPoints.size(); ++i) {
+          for(size_t j = 0; j < _controlPoints[i].size(); ++j) {
+            if(_controlPoints[i][j].isAnimating())
+              return true;
+          }
+        }
+        return false;
+      }
+
+      /// hash of the points of all the curves at a time
+      uint64_t ParametricInstance::getValueHash(OfxTime time)
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint64_t hash = Param::hashBytes(0, 0);
+        std::vector<double> keys, values;
+        std::vector<int> indices;
+        for(int i = 0; i < getCurveCount(); ++i) {
+          getControlPoints(i, time, keys, values, indices);
+          int n = int(keys.size());
+          hash = Param::hashBytes(&n, sizeof(n), hash);
+          if(n) {
+            hash = Param::hashBytes(&keys[0], n * sizeof(double), hash);
+            hash = Param::hashBytes(&values[0], n * sizeof(double), hash);
+          }
+        }
+        return hash;
+      }
+
+      /// hash of the defaults and keys of all the points of all the curves
+      uint64_t ParametricInstance::getContentHash()
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint64_t hash = Param::hashBytes(0, 0);
+        for(int i = 0; i < getCurveCount(); ++i) {
+          int n = int(_controlPoints[i].size());
+          hash = Param::hashBytes(&n, sizeof(n), hash);
+          for(int j = 0; j < n; ++j) {
+            const Animation::Curve &point = _controlPoints[i][j];
+            unsigned int nKeys = 0;
+            point.getNumKeys(nKeys);
+            hash = Param::hashBytes(point.getDefault(), 2 * sizeof(double), hash);
+            hash = Param::hashBytes(&nKeys, sizeof(nKeys), hash);
+            for(unsigned int k = 0; k < nKeys; ++k) {
+              OfxTime time;
+              point.getKeyTime(int(k), time);
+              int interpolation = point.getKeyInterpolation(int(k));
+              hash = Param::hashBytes(&time, sizeof(time), hash);
+              hash = Param::hashBytes(point.getKeyValue(int(k)), 2 * sizeof(double), hash);
+              hash = Param::hashBytes(&interpolation, sizeof(interpolation), hash);
+            }
+          }
+        }
+        return hash;
+      }
+
+      //
+      // the suite, which works on instances and on descriptors, where the plugin sets the default curves
+      //
+
+      /// get the param behind a handle, NULL if it is not a parametric param
+      static Param::Base *getParametricParam(OfxParamHandle param)
+      {
+        Param::Base *base = reinterpret_cast<Param::Base*>(param);
+        if(!base || !base->verifyMagic() || base->getType() != kOfxParamTypeParametric)
+          return 0;
+        return base;
+      }
+
+      static OfxStatus parametricParamGetValue(OfxParamHandle param,
+                                               int curveIndex,
+                                               OfxTime time,
+                                               double parametricPosition,
+                                               double *returnValue)
+      {
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << "OFX: parametricParamGetValue - " << param << ' ' << curveIndex << ' ' << time << ' ' << parametricPosition << " ...";
+#       endif
+        OfxStatus stat = kOfxStatErrBadHandle;
+        if(Param::Base *base = getParametricParam(param)) {
+          if(ParametricInstance *instance = dynamic_cast<ParametricInstance*>(base)) {
+            stat = instance->getValue(curveIndex, time, parametricPosition, returnValue);
+          }
+          else if(!dynamic_cast<Param::Instance*>(base)) {
+            stat = kOfxStatErrBadIndex;
+            if(isValidCurve(base->getProperties(), curveIndex)) {
+              ControlPointList points = getDefaultControlPoints(base->getProperties(), curveIndex);
+              std::vector<double> keys, values;
+              for(size_t i = 0; i < points.size(); ++i) {
+                keys.push_back(points[i].first);
+                values.push_back(points[i].second);
+              }
+              Animation::Curve curve;
+              makeCurve(curve, keys, values);
+              *returnValue = evaluateCurve(curve, parametricPosition);
+              stat = kOfxStatOK;
+            }
+          }
+        }
+#       ifdef OFX_DEBUG_PARAMETERS
+        if (stat == kOfxStatOK) {
+          std::cout << ' ' << *returnValue;
+        }
+        std::cout << ' ' << StatStr(stat) << std::endl;
+#       endif
+        return stat;
+      }
+
+      static OfxStatus parametricParamGetNControlPoints(OfxParamHandle param,
+                                                        int curveIndex,
+                                                        double time,
+                                                        int *returnValue)
+      {
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << "OFX: parametricParamGetNControlPoints - " << param << ' ' << curveIndex << ' ' << time << " ...";
+#       endif
+        OfxStatus stat = kOfxStatErrBadHandle;
+        if(Param::Base *base = getParametricParam(param)) {
+          if(ParametricInstance *instance = dynamic_cast<ParametricInstance*>(base)) {
+            stat = instance->getNControlPoints(curveIndex, time, returnValue);
+          }
+          else if(!dynamic_cast<Param::Instance*>(base)) {
+            stat = kOfxStatErrBadIndex;
+            if(isValidCurve(base->getProperties(), curveIndex)) {
+              *returnValue = int(getDefaultControlPoints(base->getProperties(), curveIndex).size());
+              stat = kOfxStatOK;
+            }
+          }
+        }
+#       ifdef OFX_DEBUG_PARAMETERS
+        if (stat == kOfxStatOK) {
+          std::cout << ' ' << *returnValue;
+        }
+        std::cout << ' ' << StatStr(stat) << std::endl;
+#       endif
+        return stat;
+      }
+
+      static OfxStatus parametricParamGetNthControlPoint(OfxParamHandle param,
+                                                         int curveIndex,
+                                                         double time,
+                                                         int nthCtl,
+                                                         double *key,
+                                                         double *value)
+      {
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << "OFX: parametricParamGetNthControlPoint - " << param << ' ' << curveIndex << ' ' << time << ' ' << nthCtl << " ...";
+#       endif
+        OfxStatus stat = kOfxStatErrBadHandle;
+        if(Param::Base *base = getParametricParam(param)) {
+          if(ParametricInstance *instance = dynamic_cast<ParametricInstance*>(base)) {
+            stat = instance->getNthControlPoint(curveIndex, time, nthCtl, key, value);
+          }
+          else if(!dynamic_cast<Param::Instance*>(base)) {
+            stat = kOfxStatErrBadIndex;
+            if(isValidCurve(base->getProperties(), curveIndex)) {
+              ControlPointList points = getDefaultControlPoints(base->getProperties(), curveIndex);
+              if(nthCtl >= 0 && nthCtl < int(points.size())) {
+                *key = points[nthCtl].first;
+                *value = points[nthCtl].second;
+                stat = kOfxStatOK;
+              }
+            }
+          }
+        }
+#       ifdef OFX_DEBUG_PARAMETERS
+        if (stat == kOfxStatOK) {
+          std::cout << ' ' << *key << ' ' << *value;
+        }
+        std::cout << ' ' << StatStr(stat) << std::endl;
+#       endif
+        return stat;
+      }
+
+      static OfxStatus parametricParamSetNthControlPoint(OfxParamHandle param,
+                                                         int curveIndex,
+                                                         double time,
+                                                         int nthCtl,
+                                                         double key,
+                                                         double value,
+                                                         bool addAnimationKey)
+      {
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << "OFX: parametricParamSetNthControlPoint - " << param << ' ' << curveIndex << ' ' << time << ' ' << nthCtl << ' ' << key << ' ' << value << ' ' << addAnimationKey << " ...";
+#       endif
+        OfxStatus stat = kOfxStatErrBadHandle;
+        if(Param::Base *base = getParametricParam(param)) {
+          if(ParametricInstance *instance = dynamic_cast<ParametricInstance*>(base)) {
+            stat = instance->setNthControlPoint(curveIndex, time, nthCtl, key, value, addAnimationKey);
+          }
+          else if(!dynamic_cast<Param::Instance*>(base)) {
+            stat = kOfxStatErrBadIndex;
+            if(isValidCurve(base->getProperties(), curveIndex)) {
+              ControlPointList points = getDefaultControlPoints(base->getProperties(), curveIndex);
+              if(nthCtl >= 0 && nthCtl < int(points.size())) {
+                points[nthCtl] = std::make_pair(key, value);
+                std::sort(points.begin(), points.end());
+                setDefaultControlPoints(base->getProperties(), curveIndex, points);
+                stat = kOfxStatOK;
+              }
+            }
+          }
+        }
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << ' ' << StatStr(stat) << std::endl;
+#       endif
+        return stat;
+      }
+
+      static OfxStatus parametricParamAddControlPoint(OfxParamHandle param,
+                                                      int curveIndex,
+                                                      double time,
+                                                      double key,
+                                                      double value,
+                                                      bool addAnimationKey)
+      {
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << "OFX: parametricParamAddControlPoint - " << param << ' ' << curveIndex << ' ' << time << ' ' << key << ' ' << value << ' ' << addAnimationKey << " ...";
+#       endif
+        OfxStatus stat = kOfxStatErrBadHandle;
+        if(Param::Base *base = getParametricParam(param)) {
+          if(ParametricInstance *instance = dynamic_cast<ParametricInstance*>(base)) {
+            stat = instance->addControlPoint(curveIndex, time, key, value, addAnimationKey);
+          }
+          else if(!dynamic_cast<Param::Instance*>(base)) {
+            stat = kOfxStatErrBadIndex;
+            if(isValidCurve(base->getProperties(), curveIndex)) {
+              ControlPointList points = getDefaultControlPoints(base->getProperties(), curveIndex);
+              ControlPointList::iterator it = points.begin();
+              while(it != points.end() && it->first < key - kKeyTolerance)
+                ++it;
+              if(it != points.end() && fabs(it->first - key) <= kKeyTolerance)
+                *it = std::make_pair(key, value);
+              else
+                points.insert(it, std::make_pair(key, value));
+              setDefaultControlPoints(base->getProperties(), curveIndex, points);
+              stat = kOfxStatOK;
+            }
+          }
+        }
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << ' ' << StatStr(stat) << std::endl;
+#       endif
+        return stat;
+      }
+
+      static OfxStatus parametricParamDeleteControlPoint(OfxParamHandle param,
+                                                         int curveIndex,
+                                                         int nthCtl)
+      {
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << "OFX: parametricParamDeleteControlPoint - " << param << ' ' << curveIndex << ' ' << nthCtl << " ...";
+#       endif
+        OfxStatus stat = kOfxStatErrBadHandle;
+        if(Param::Base *base = getParametricParam(param)) {
+          if(ParametricInstance *instance = dynamic_cast<ParametricInstance*>(base)) {
+            stat = instance->deleteControlPoint(curveIndex, nthCtl);
+          }
+          else if(!dynamic_cast<Param::Instance*>(base)) {
+            stat = kOfxStatErrBadIndex;
+            if(isValidCurve(base->getProperties(), curveIndex)) {
+              ControlPointList points = getDefaultControlPoints(base->getProperties(), curveIndex);
+              if(nthCtl >= 0 && nthCtl < int(points.size())) {
+                points.erase(points.begin() + nthCtl);
+                setDefaultControlPoints(base->getProperties(), curveIndex, points);
+                stat = kOfxStatOK;
+              }
+            }
+          }
+        }
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << ' ' << StatStr(stat) << std::endl;
+#       endif
+        return stat;
+      }
+
+      static OfxStatus parametricParamDeleteAllControlPoints(OfxParamHandle param,
+                                                             int curveIndex)
+      {
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << "OFX: parametricParamDeleteAllControlPoints - " << param << ' ' << curveIndex << " ...";
+#       endif
+        OfxStatus stat = kOfxStatErrBadHandle;
+        if(Param::Base *base = getParametricParam(param)) {
+          if(ParametricInstance *instance = dynamic_cast<ParametricInstance*>(base)) {
+            stat = instance->deleteAllControlPoints(curveIndex);
+          }
+          else if(!dynamic_cast<Param::Instance*>(base)) {
+            stat = kOfxStatErrBadIndex;
+            if(isValidCurve(base->getProperties(), curveIndex)) {
+              setDefaultControlPoints(base->getProperties(), curveIndex, ControlPointList());
+              stat = kOfxStatOK;
+            }
+          }
+        }
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << ' ' << StatStr(stat) << std::endl;
+#       endif
+        return stat;
+      }
+
+      static const OfxParametricParameterSuiteV1 gParametricParameterSuiteV1 = {
+        parametricParamGetValue,
+        parametricParamGetNControlPoints,
+        parametricParamGetNthControlPoint,
+        parametricParamSetNthControlPoint,
+        parametricParamAddControlPoint,
+        parametricParamDeleteControlPoint,
+        parametricParamDeleteAllControlPoints
+      };
+
+      /// fetch the parametric param suite
+      const void *GetSuite(int version) {
+        if(version == 1)
+          return &gParametricParameterSuiteV1;
+        return NULL;
+      }
+
+    } // ParametricParam
+
+  } // Host
+
+} // OFX
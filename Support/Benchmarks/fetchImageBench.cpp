@@ -0,0 +1,120 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+  Times OFX::Clip::fetchImage, which wraps the image the host hands back in an OFX::Image,
+  against the property suite of the host support library. Once on images with only the
+  individual image properties, and once on HostSupport images, which also have the packed
+  kOfxImagePropPackedDescriptor, so the fetch takes a single property call. As the library
+  finds out whether the host has packed descriptors on the first fetch, each is timed in
+  a process of its own, which is what running with no mode does.
+
+  fetchImageBench [individual|packed [fetches]]
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "ofxsBenchmark.h"
+#include "ofxhPropertySuite.h"
+#include "ofxhClip.h"
+
+namespace OFX {
+  namespace Plugin {
+    void getPluginIDs(OFX::PluginFactoryArray &) {}
+  }
+}
+
+/// the image clipGetImage hands back
+static OfxPropertySetHandle gImage;
+
+static OfxStatus clipGetImage(OfxImageClipHandle, OfxTime, const OfxRectD *, OfxPropertySetHandle *imageHandle)
+{
+  *imageHandle = gImage;
+  return kOfxStatOK;
+}
+
+/// a clip with no effect or host clip behind it, as fetchImage only calls the suite
+class BenchClip : public OFX::Clip {
+public :
+  explicit BenchClip(OfxPropertySetHandle props) : OFX::Clip(0, "Source", 0, props, 0) {}
+};
+
+/// the image properties of a host without the packed descriptor
+static const OFX::Host::Property::PropSpec gImageProps[] = {
+  { kOfxPropType,                         OFX::Host::Property::eString,  1, false, kOfxTypeImage },
+  { kOfxImageEffectPropPixelDepth,        OFX::Host::Property::eString,  1, true,  kOfxBitDepthNone },
+  { kOfxImageEffectPropComponents,        OFX::Host::Property::eString,  1, true,  kOfxImageComponentNone },
+  { kOfxImageEffectPropPreMultiplication, OFX::Host::Property::eString,  1, true,  kOfxImageOpaque },
+  { kOfxImageEffectPropRenderScale,       OFX::Host::Property::eDouble,  2, true,  "1.0" },
+  { kOfxImagePropPixelAspectRatio,        OFX::Host::Property::eDouble,  1, true,  "1.0" },
+  { kOfxImagePropBounds,                  OFX::Host::Property::eInt,     4, true,  "0" },
+  { kOfxImagePropRegionOfDefinition,      OFX::Host::Property::eInt,     4, true,  "0" },
+  { kOfxImagePropRowBytes,                OFX::Host::Property::eInt,     1, true,  "0" },
+  { kOfxImagePropField,                   OFX::Host::Property::eString,  1, true,  kOfxImageFieldNone },
+  { kOfxImagePropUniqueIdentifier,        OFX::Host::Property::eString,  1, true,  "" },
+  { kOfxImagePropData,                    OFX::Host::Property::ePointer, 1, true,  0 },
+  OFX::Host::Property::propSpecEnd
+};
+
+/// describe a 1920x1080 float RGBA frame
+static void setImageProps(OFX::Host::Property::Set &props)
+{
+  static float pixels[4];
+  int bounds[4] = {0, 0, 1920, 1080};
+  props.setStringProperty(kOfxImageEffectPropPixelDepth, kOfxBitDepthFloat);
+  props.setStringProperty(kOfxImageEffectPropComponents, kOfxImageComponentRGBA);
+  props.setStringProperty(kOfxImageEffectPropPreMultiplication, kOfxImagePreMultiplied);
+  props.setStringProperty(kOfxImagePropField, kOfxImageFieldNone);
+  props.setStringProperty(kOfxImagePropUniqueIdentifier, "frame_0001_source");
+  props.setIntPropertyN(kOfxImagePropBounds, bounds, 4);
+  props.setIntPropertyN(kOfxImagePropRegionOfDefinition, bounds, 4);
+  props.setIntProperty(kOfxImagePropRowBytes, 1920 * 4 * sizeof(float));
+  props.setPointerProperty(kOfxImagePropData, pixels);
+}
+
+/// time fetching and deleting an image, in ns a fetch
+static void run(const char *name, OfxPropertySetHandle image, int fetches)
+{
+  gImage = image;
+  OFX::Host::Property::Set clipProps;
+  BenchClip clip(clipProps.getHandle());
+
+  long check = 0;
+  double ms = OFX::Benchmark::bestOf(5, [&] {
+      for(int i = 0; i < fetches; ++i) {
+        OFX::Image *image = clip.fetchImage(i);
+        check += image->getBounds().x2 + image->getPixelComponentCount() + image->getPixelDepth();
+        delete image;
+      }
+    });
+  printf("%-32s %7.1f ns a fetch (check %ld)\n", name, ms * 1e6 / fetches, check);
+}
+
+int main(int argc, char **argv)
+{
+  if(argc < 2) {
+    std::string self = argv[0];
+    return system((self + " individual").c_str()) || system((self + " packed").c_str());
+  }
+  int fetches = argc > 2 ? atoi(argv[2]) : 1000000;
+
+  OFX::Benchmark::setUpHost();
+  OFX::Private::gEffectSuite->clipGetImage = clipGetImage;
+  OFX::Private::gPropSuite = (OfxPropertySuiteV1 *) OFX::Host::Property::GetSuite(1);
+  OFX::PropertySet::propDisableLogging();
+
+  if(strcmp(argv[1], "packed") == 0) {
+    OFX::Host::ImageEffect::Image packed;
+    setImageProps(packed);
+    run("packed image descriptor", packed.getHandle(), fetches);
+  }
+  else {
+    OFX::Host::Property::Set individual(gImageProps);
+    setImageProps(individual);
+    run("individual image properties", individual.getHandle(), fetches);
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+  Times the Invert plugin's processor in GB/s, of bytes read plus written, against memcpy,
+  on 3840x2160 RGBA frames of bytes, shorts, halfs and floats: inverting all channels into
+  another image, all channels in place, and only red, green and blue. It checks the in place
+  render matches the other. As the kernel level is picked once a process, each level is
+  timed in a process of its own, which is what running with no level does.
+
+  invertBench [scalar|sse2|native]
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "ofxsBenchmark.h"
+#include "../Plugins/Invert/invert.cpp"
+
+template <class PIX, int max>
+static void run(const char *depthName, const char *depth)
+{
+  const OfxRectI bounds = {0, 0, 3840, 2160};
+  std::vector<PIX> src, dst, reference;
+  OFX::Image *srcImg = OFX::Benchmark::makeImage(src, bounds, 4, depth);
+  OFX::Image *dstImg = OFX::Benchmark::makeImage(dst, bounds, 4, depth);
+  for(size_t i = 0; i < src.size(); ++i)
+    src[i] = PIX(float(max) * float(i % 1013) / 1013.f);
+  OFX::ImageEffect &effect = OFX::Benchmark::effect();
+  double gigabytes = 2.0 * src.size() * sizeof(PIX) / 1e9;
+
+  double memcpyMs = OFX::Benchmark::bestOf(7, [&] {memcpy(&dst[0], &src[0], src.size() * sizeof(PIX));});
+
+  ImageInverter<PIX, 4, max> inverter(effect);
+  inverter.setDstImg(dstImg);
+  inverter.setSrcImg(srcImg);
+  inverter.setRenderWindow(bounds);
+  double invertMs = OFX::Benchmark::bestOf(7, [&] {inverter.process();});
+  reference = dst;
+
+  // the source and destination being the same image, as a host rendering in place would have them
+  ImageInverter<PIX, 4, max> inPlace(effect);
+  inPlace.setDstImg(dstImg);
+  inPlace.setSrcImg(dstImg);
+  inPlace.setRenderWindow(bounds);
+  dst = src;
+  inPlace.process();
+  bool same = memcmp(&dst[0], &reference[0], dst.size() * sizeof(PIX)) == 0;
+  double inPlaceMs = OFX::Benchmark::bestOf(7, [&] {inPlace.process();});
+
+  inverter.setChannels(true, true, true, false);
+  double rgbMs = OFX::Benchmark::bestOf(7, [&] {inverter.process();});
+
+  printf("%-6s memcpy %5.1f GB/s, invert %5.1f GB/s, in place %5.1f GB/s%s, rgb only %5.1f GB/s\n",
+         depthName, gigabytes * 1e3 / memcpyMs, gigabytes * 1e3 / invertMs, gigabytes * 1e3 / inPlaceMs,
+         same ? "" : " DIFFERS", gigabytes * 1e3 / rgbMs);
+
+  delete srcImg;
+  delete dstImg;
+}
+
+int main(int argc, char **argv)
+{
+  if(argc < 2) {
+    std::string self = argv[0];
+    return system((self + " scalar").c_str()) || system((self + " sse2").c_str()) || system((self + " native").c_str());
+  }
+  if(strcmp(argv[1], "native") != 0)
+    setenv("OFX_SIMD_LEVEL", argv[1], 1);
+
+  OFX::Benchmark::setUpHost();
+  OFX::Benchmark::threadCount() = 1;
+
+  static const char *const levelNames[] = {"scalar", "sse2", "avx2"};
+  printf("==== %s kernels, 3840x2160 RGBA, 1 thread\n", levelNames[OFX::Simd::getLevel()]);
+  run<unsigned char, 255>("byte", kOfxBitDepthByte);
+  run<unsigned short, 65535>("short", kOfxBitDepthShort);
+  run<OFX::Simd::Half, 1>("half", kOfxBitDepthHalf);
+  run<float, 1>("float", kOfxBitDepthFloat);
+  return 0;
+}
@@ -0,0 +1,159 @@
+#ifndef _ofxsBenchmark_h_
+#define _ofxsBenchmark_h_
+
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+/** @file ofxsBenchmark.h
+
+Stand ins for the host, shared by the benchmarks of the support library and its plugins.
+
+Each benchmark is a standalone program that drives the library's processors directly,
+rather than a plugin loaded by a host, so only the suites the processors call are
+provided: an image effect suite whose abort only aborts when told to and whose image
+memory is the heap, and a thread suite running std::threads. Images wrap buffers owned by the benchmark.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ofxsImageEffect.h"
+#include "ofxsSupportPrivate.h"
+#include "ofxImageDescriptor.h"
+
+namespace OFX {
+  namespace Benchmark {
+
+    /** @brief number of threads the stand in thread suite runs, the machine's core count unless set */
+    inline unsigned int &threadCount()
+    {
+      static unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+      return count;
+    }
+
+    /** @brief index of the calling thread within the multiThread call it is part of */
+    inline unsigned int &threadIndex()
+    {
+      static thread_local unsigned int index = 0;
+      return index;
+    }
+
+    /** @brief whether the stand in abort tells processors to stop, false unless set */
+    inline bool &aborting()
+    {
+      static bool abort = false;
+      return abort;
+    }
+
+    namespace Private {
+      inline int abort(OfxImageEffectHandle) {return aborting();}
+      inline OfxStatus clipReleaseImage(OfxPropertySetHandle) {return kOfxStatOK;}
+      inline OfxStatus imageMemoryAlloc(OfxImageEffectHandle, size_t nBytes, OfxImageMemoryHandle *memory) {*memory = (OfxImageMemoryHandle) new char[nBytes]; return kOfxStatOK;}
+      inline OfxStatus imageMemoryFree(OfxImageMemoryHandle memory) {delete [] (char *) memory; return kOfxStatOK;}
+      inline OfxStatus imageMemoryLock(OfxImageMemoryHandle memory, void **data) {*data = memory; return kOfxStatOK;}
+      inline OfxStatus imageMemoryUnlock(OfxImageMemoryHandle) {return kOfxStatOK;}
+
+      inline OfxStatus multiThread(OfxThreadFunctionV1 func, unsigned int nThreads, void *customArg)
+      {
+        std::vector<std::thread> threads;
+        for(unsigned int i = 0; i < nThreads; ++i)
+          threads.push_back(std::thread([=] {threadIndex() = i; func(i, nThreads, customArg);}));
+        for(unsigned int i = 0; i < nThreads; ++i)
+          threads[i].join();
+        return kOfxStatOK;
+      }
+      inline OfxStatus multiThreadNumCPUs(unsigned int *nCPUs) {*nCPUs = threadCount(); return kOfxStatOK;}
+      inline OfxStatus multiThreadIndex(unsigned int *index) {*index = threadIndex(); return kOfxStatOK;}
+      inline int multiThreadIsSpawnedThread() {return 0;}
+      inline OfxStatus mutexCreate(OfxMutexHandle *mutex, int) {*mutex = (OfxMutexHandle) new std::recursive_mutex; return kOfxStatOK;}
+      inline OfxStatus mutexDestroy(const OfxMutexHandle mutex) {delete (std::recursive_mutex *) mutex; return kOfxStatOK;}
+      inline OfxStatus mutexLock(const OfxMutexHandle mutex) {((std::recursive_mutex *) mutex)->lock(); return kOfxStatOK;}
+      inline OfxStatus mutexUnLock(const OfxMutexHandle mutex) {((std::recursive_mutex *) mutex)->unlock(); return kOfxStatOK;}
+      inline OfxStatus mutexTryLock(const OfxMutexHandle mutex) {return ((std::recursive_mutex *) mutex)->try_lock() ? kOfxStatOK : kOfxStatFailed;}
+    };
+
+    /** @brief point the library at the stand in suites, call before anything else */
+    inline void setUpHost()
+    {
+      static OfxImageEffectSuiteV1 effectSuite;
+      memset(&effectSuite, 0, sizeof(effectSuite));
+      effectSuite.abort = Private::abort;
+      effectSuite.clipReleaseImage = Private::clipReleaseImage;
+      effectSuite.imageMemoryAlloc = Private::imageMemoryAlloc;
+      effectSuite.imageMemoryFree = Private::imageMemoryFree;
+      effectSuite.imageMemoryLock = Private::imageMemoryLock;
+      effectSuite.imageMemoryUnlock = Private::imageMemoryUnlock;
+      OFX::Private::gEffectSuite = &effectSuite;
+
+      static OfxMultiThreadSuiteV1 threadSuite = {
+        Private::multiThread, Private::multiThreadNumCPUs, Private::multiThreadIndex, Private::multiThreadIsSpawnedThread,
+        Private::mutexCreate, Private::mutexDestroy, Private::mutexLock, Private::mutexUnLock, Private::mutexTryLock
+      };
+      OFX::Private::gThreadSuite = &threadSuite;
+    }
+
+    /** @brief The effect the processors are made with. Processors only pass it to abort, which the
+        stand in suite does not look at, so no real effect is needed and this is zeroed memory. */
+    inline ImageEffect &effect()
+    {
+      static char memory[4096];
+      return *reinterpret_cast<ImageEffect *>(memory);
+    }
+
+    /** @brief An image around pixels the benchmark owns, which has no property set */
+    class BufferImage : public Image {
+    public :
+      BufferImage(const OfxImageDescriptorV1 &descriptor) : Image(0, false, &descriptor) {}
+    };
+
+    /** @brief wrap an image around pixels, sized here to fill the bounds, which the caller keeps alive */
+    template <class PIX>
+    Image *makeImage(std::vector<PIX> &pixels, const OfxRectI &bounds, int nComponents, const char *pixelDepth)
+    {
+      int width = bounds.x2 - bounds.x1;
+      pixels.resize(size_t(width) * (bounds.y2 - bounds.y1) * nComponents);
+
+      OfxImageDescriptorV1 descriptor;
+      descriptor.data = pixels.empty() ? 0 : &pixels[0];
+      descriptor.bounds = bounds;
+      descriptor.regionOfDefinition = bounds;
+      descriptor.rowBytes = int(width * nComponents * sizeof(PIX));
+      descriptor.pixelAspectRatio = 1;
+      descriptor.renderScale.x = descriptor.renderScale.y = 1;
+      descriptor.components = nComponents == 4 ? kOfxImageComponentRGBA : nComponents == 3 ? kOfxImageComponentRGB : kOfxImageComponentAlpha;
+      descriptor.pixelDepth = pixelDepth;
+      descriptor.preMultiplication = kOfxImagePreMultiplied;
+      descriptor.field = kOfxImageFieldNone;
+      descriptor.uniqueIdentifier = "";
+      return new BufferImage(descriptor);
+    }
+
+    /** @brief fill pixels with a repeating ramp from 0 to max */
+    template <class PIX>
+    void fillRamp(std::vector<PIX> &pixels, float max)
+    {
+      for(size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = PIX(max * float(i % 1013) / 1013.f);
+    }
+
+    /** @brief the fastest of several runs of a function, in milliseconds */
+    template <class FUNC>
+    double bestOf(int runs, FUNC func)
+    {
+      double best = 1e30;
+      for(int i = 0; i < runs; ++i) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        func();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+      }
+      return best;
+    }
+
+  };
+};
+
+#endif
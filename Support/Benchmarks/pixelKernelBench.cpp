@@ -0,0 +1,163 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+  Times the processors ported to the OFX::Simd pixel kernels, OFX::ImageBlender and the
+  Basic plugin's gain, against the pixel at a time loops they replaced, on 3840x2160 RGBA
+  frames of bytes, shorts and floats, and checks that both write the same bytes. As the
+  kernel level is picked once a process, each level is timed in a process of its own,
+  which is what running with no level does. invertBench times the Invert plugin's port.
+
+  pixelKernelBench [scalar|sse2|native [threads]]
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "ofxsBenchmark.h"
+#include "../Plugins/Basic/basic.cpp"
+#include "ofxsImageBlender.H"
+
+/// OFX::ImageBlender as it was before the port, fetching each pixel's address
+template <class PIX, int nComponents>
+class OldImageBlender : public OFX::ImageBlenderBase {
+public :
+  OldImageBlender(OFX::ImageEffect &instance) : OFX::ImageBlenderBase(instance) {}
+
+  void multiThreadProcessImages(OfxRectI procWindow)
+  {
+    float blend = _blend;
+    float blendComp = 1.0f - blend;
+
+    for(int y = procWindow.y1; y < procWindow.y2; y++) {
+      PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
+
+      for(int x = procWindow.x1; x < procWindow.x2; x++) {
+        PIX *fromPix = (PIX *) (_fromImg ? _fromImg->getPixelAddress(x, y) : 0);
+        PIX *toPix   = (PIX *) (_toImg   ? _toImg->getPixelAddress(x, y)   : 0);
+
+        if(fromPix && toPix) {
+          for(int c = 0; c < nComponents; c++)
+            dstPix[c] = PIX((toPix[c] - fromPix[c]) * blend + fromPix[c]);
+        }
+        else if(fromPix) {
+          for(int c = 0; c < nComponents; c++)
+            dstPix[c] = PIX(fromPix[c] * blendComp);
+        }
+        else if(toPix) {
+          for(int c = 0; c < nComponents; c++)
+            dstPix[c] = PIX(toPix[c] * blend);
+        }
+        else {
+          for(int c = 0; c < nComponents; c++)
+            dstPix[c] = PIX(0);
+        }
+        dstPix += nComponents;
+      }
+    }
+  }
+};
+
+/// the Basic plugin's unmasked gain as it was before the port
+template <class PIX, int nComponents, int max>
+class OldImageScaler : public ImageScalerBase {
+public :
+  OldImageScaler(OFX::ImageEffect &instance) : ImageScalerBase(instance) {}
+
+  void multiThreadProcessImages(OfxRectI procWindow)
+  {
+    float scales[4] = {(float)_rScale, (float)_gScale, (float)_bScale, (float)_aScale};
+
+    for(int y = procWindow.y1; y < procWindow.y2; y++) {
+      PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
+
+      for(int x = procWindow.x1; x < procWindow.x2; x++) {
+        PIX *srcPix = (PIX *) (_srcImg ? _srcImg->getPixelAddress(x, y) : 0);
+
+        for(int c = 0; c < nComponents; c++) {
+          float v = srcPix ? srcPix[c] * scales[c] : 0.f;
+          dstPix[c] = max == 1 ? PIX(v) : PIX(Clamp(v, 0, max));
+        }
+        dstPix += nComponents;
+      }
+    }
+  }
+};
+
+/// time a processor writing into dst, and whether it wrote what the reference did
+template <class PIX>
+static void report(const char *name, OFX::ImageProcessor &processor, const std::vector<PIX> &dst, const std::vector<PIX> &reference)
+{
+  double ms = OFX::Benchmark::bestOf(5, [&] {processor.process();});
+  bool same = reference.empty() || memcmp(&dst[0], &reference[0], dst.size() * sizeof(PIX)) == 0;
+  printf("  %-12s %7.2f ms%s\n", name, ms, same ? "" : "  DIFFERS from the old loop");
+}
+
+template <class PIX, int max>
+static void run(const char *depthName, const char *depth)
+{
+  const OfxRectI bounds = {0, 0, 3840, 2160};
+  std::vector<PIX> from, to, dst, reference;
+  OFX::Image *fromImg = OFX::Benchmark::makeImage(from, bounds, 4, depth);
+  OFX::Image *toImg = OFX::Benchmark::makeImage(to, bounds, 4, depth);
+  OFX::Image *dstImg = OFX::Benchmark::makeImage(dst, bounds, 4, depth);
+  OFX::Benchmark::fillRamp(from, float(max));
+  OFX::Benchmark::fillRamp(to, float(max) * 0.5f);
+  OFX::ImageEffect &effect = OFX::Benchmark::effect();
+
+  printf("%s\n", depthName);
+
+  OldImageBlender<PIX, 4> oldBlend(effect);
+  OFX::ImageBlender<PIX, 4> blend(effect);
+  OFX::ImageBlenderBase *blenders[] = {&oldBlend, &blend};
+  for(int i = 0; i < 2; ++i) {
+    blenders[i]->setDstImg(dstImg);
+    blenders[i]->setFromImg(fromImg);
+    blenders[i]->setToImg(toImg);
+    blenders[i]->setBlend(0.3f);
+    blenders[i]->setRenderWindow(bounds);
+  }
+  report("old blend", oldBlend, dst, reference);
+  reference = dst;
+  report("blend", blend, dst, reference);
+
+  OldImageScaler<PIX, 4, max> oldGain(effect);
+  ImageScaler<PIX, 4, max, PIX> gain(effect);
+  ImageScalerBase *scalers[] = {&oldGain, &gain};
+  for(int i = 0; i < 2; ++i) {
+    scalers[i]->setDstImg(dstImg);
+    scalers[i]->setSrcImg(fromImg);
+    scalers[i]->setScales(1.2f, 0.9f, 1.5f, 1.f);
+    scalers[i]->setRenderWindow(bounds);
+  }
+  reference.clear();
+  report("old gain", oldGain, dst, reference);
+  reference = dst;
+  report("gain", gain, dst, reference);
+
+  delete fromImg;
+  delete toImg;
+  delete dstImg;
+}
+
+int main(int argc, char **argv)
+{
+  if(argc < 2) {
+    std::string self = argv[0];
+    return system((self + " scalar").c_str()) || system((self + " sse2").c_str()) || system((self + " native").c_str());
+  }
+  if(strcmp(argv[1], "native") != 0)
+    setenv("OFX_SIMD_LEVEL", argv[1], 1);
+
+  OFX::Benchmark::setUpHost();
+  OFX::Benchmark::threadCount() = argc > 2 ? std::max(1, atoi(argv[2])) : 1;
+
+  static const char *const levelNames[] = {"scalar", "sse2", "avx2"};
+  printf("==== %s kernels, %u threads, 3840x2160 RGBA\n", levelNames[OFX::Simd::getLevel()], OFX::Benchmark::threadCount());
+  run<unsigned char, 255>("byte", kOfxBitDepthByte);
+  run<unsigned short, 65535>("short", kOfxBitDepthShort);
+  run<float, 1>("float", kOfxBitDepthFloat);
+  return 0;
+}
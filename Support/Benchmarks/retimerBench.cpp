@@ -0,0 +1,143 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+  Times the Retimer plugin rendering a 4x slow motion sequence of 1920x1080 RGBA frames of
+  bytes and floats, with and without the source frames it keeps across sequential renders,
+  and checks the two end on the same frame. Each output frame fetches its source frames from a stand
+  in host, as the plugin's render does, from one of two hosts: one that hands over frames it
+  already has, and one that renders each frame it is asked for, as cheaply as writing it once.
+  The cache copies every frame it misses, so it only pays when fetching a frame costs more.
+
+  retimerBench
+*/
+
+#include <cstdio>
+
+#include "ofxsBenchmark.h"
+#include "../Plugins/Retimer/retimer.cpp"
+
+/// the stand in host's source clip, frames of a ramp offset by the frame's time
+template <class PIX>
+class SourceClip {
+  OfxRectI _bounds;
+  const char *_depth;
+  bool _renders;
+  float _max;
+  std::vector<std::vector<PIX> > _frames;
+
+public :
+  SourceClip(const OfxRectI &bounds, const char *depth, bool renders, float max, int nFrames)
+    : _bounds(bounds), _depth(depth), _renders(renders), _max(max), _frames(nFrames)
+  {
+    if(!renders)
+      for(int i = 0; i < nFrames; ++i)
+        render(i);
+  }
+
+  /// the frame at a time, rendered now if the host renders frames when asked
+  OFX::Image *fetchImage(double time)
+  {
+    int frame = int(time);
+    if(_renders)
+      render(frame);
+    OfxImageDescriptorV1 descriptor;
+    descriptor.data = &_frames[frame][0];
+    descriptor.bounds = _bounds;
+    descriptor.regionOfDefinition = _bounds;
+    descriptor.rowBytes = int((_bounds.x2 - _bounds.x1) * 4 * sizeof(PIX));
+    descriptor.pixelAspectRatio = 1;
+    descriptor.renderScale.x = descriptor.renderScale.y = 1;
+    descriptor.components = kOfxImageComponentRGBA;
+    descriptor.pixelDepth = _depth;
+    descriptor.preMultiplication = kOfxImagePreMultiplied;
+    descriptor.field = kOfxImageFieldNone;
+    descriptor.uniqueIdentifier = "";
+    return new OFX::Benchmark::BufferImage(descriptor);
+  }
+
+private :
+  void render(int frame)
+  {
+    std::vector<PIX> &pixels = _frames[frame];
+    pixels.resize(size_t(_bounds.x2 - _bounds.x1) * (_bounds.y2 - _bounds.y1) * 4);
+    for(size_t i = 0; i < pixels.size(); ++i)
+      pixels[i] = PIX(_max * float((i + frame * 97) % 1013) / 1013.f);
+  }
+};
+
+/// renders the output frames of a sequence as RetimerPlugin::setupAndProcess does, keeping source frames if asked
+template <class PIX>
+static void renderSequence(SourceClip<PIX> &clip, OFX::Image &dst, const OfxRectI &window, int nFrames, bool cached)
+{
+  OFX::ImageEffect &effect = OFX::Benchmark::effect();
+  OfxPointD renderScale = {1, 1};
+  SourceFrameCache cache;
+
+  for(int t = 0; t < nFrames; ++t) {
+    double fromTime, toTime, blend;
+    framesNeeded(t / 4.0, OFX::eFieldNone, &fromTime, &toTime, &blend);
+
+    std::vector<std::shared_ptr<const CachedFrame> > used;
+    std::shared_ptr<const OFX::Image> fromImg, toImg;
+    for(int i = 0; i < (blend != 0 ? 2 : 1); ++i) {
+      double time = i == 0 ? fromTime : toTime;
+      std::shared_ptr<const OFX::Image> image;
+      if(!cached)
+        image.reset(clip.fetchImage(time));
+      else {
+        std::shared_ptr<const CachedFrame> frame = cache.find(time, renderScale, window);
+        if(!frame) {
+          std::unique_ptr<OFX::Image> src(clip.fetchImage(time));
+          frame = std::make_shared<const CachedFrame>(*src, time, effect);
+        }
+        used.push_back(frame);
+        image = std::shared_ptr<const OFX::Image>(frame, &frame->getImage());
+      }
+      (i == 0 ? fromImg : toImg) = image;
+    }
+    if(cached)
+      cache.keep(used);
+
+    OFX::ImageBlender<PIX, 4> processor(effect);
+    processor.setDstImg(&dst);
+    processor.setFromImg(fromImg.get());
+    processor.setToImg(toImg.get());
+    processor.setRenderWindow(window);
+    processor.setBlend((float)blend);
+    processor.process();
+  }
+}
+
+template <class PIX, int max>
+static void run(const char *depthName, const char *depth)
+{
+  const OfxRectI bounds = {0, 0, 1920, 1080};
+  const int nFrames = 32, nSourceFrames = nFrames / 4 + 2;
+  std::vector<PIX> dst, withoutCache, withCache;
+  std::unique_ptr<OFX::Image> dstImg(OFX::Benchmark::makeImage(dst, bounds, 4, depth));
+
+  for(int renders = 0; renders < 2; ++renders) {
+    SourceClip<PIX> clip(bounds, depth, renders != 0, float(max), nSourceFrames);
+
+    // the last frame of the sequence blends between frames, so is checked
+    double withoutMs = OFX::Benchmark::bestOf(5, [&] {renderSequence(clip, *dstImg, bounds, nFrames, false);});
+    withoutCache = dst;
+    double withMs = OFX::Benchmark::bestOf(5, [&] {renderSequence(clip, *dstImg, bounds, nFrames, true);});
+    withCache = dst;
+    bool same = withoutCache == withCache;
+
+    printf("%-6s host %-8s without cache %6.2f ms/frame, with cache %6.2f ms/frame%s\n",
+           depthName, renders ? "renders" : "has them", withoutMs / nFrames, withMs / nFrames, same ? "" : " DIFFERS");
+  }
+}
+
+int main(int, char **)
+{
+  OFX::Benchmark::setUpHost();
+
+  printf("==== 4x slow motion, 1920x1080 RGBA, %u threads\n", OFX::Benchmark::threadCount());
+  run<unsigned char, 255>("byte", kOfxBitDepthByte);
+  run<float, 1>("float", kOfxBitDepthFloat);
+  return 0;
+}
@@ -0,0 +1,88 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+  Times OFX::ImageProcessor's eSchedulingBands against eSchedulingRowChunks on a 1920x1080
+  window whose rows cost different amounts: a top quarter costing sixteen times the rest,
+  a cost rising down the frame, an even cost, and an even cost with one thread held up
+  for 20ms as it starts, as if preempted. Rows sleep for their cost rather than spin, so
+  threads overlap as they would with a core each on machines with fewer cores.
+
+  rowChunksBench [threads]
+*/
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "ofxsBenchmark.h"
+#include "ofxsProcessing.H"
+
+namespace OFX {
+  namespace Plugin {
+    void getPluginIDs(OFX::PluginFactoryArray &) {}
+  }
+}
+
+enum WorkloadEnum {
+  eWorkloadTopHeavy,
+  eWorkloadRamp,
+  eWorkloadEven,
+  eWorkloadPreempted
+};
+
+static const char *const gWorkloadNames[] = {"top quarter heavy", "ramp", "even", "preempted"};
+
+/// a processor whose rows take a time set by the workload
+class UnbalancedProcessor : public OFX::ImageProcessor {
+  WorkloadEnum _workload;
+  std::atomic<bool> _preempted;
+
+public :
+  UnbalancedProcessor(OFX::ImageEffect &effect, WorkloadEnum workload)
+    : OFX::ImageProcessor(effect)
+    , _workload(workload)
+    , _preempted(false)
+  {}
+
+  void preProcess(void) {_preempted = false;}
+
+  void multiThreadProcessImages(OfxRectI window)
+  {
+    if(_workload == eWorkloadPreempted && OFX::Benchmark::threadIndex() == 0 && !_preempted.exchange(true))
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    long us = 0;
+    for(int y = window.y1; y < window.y2; ++y) {
+      switch(_workload) {
+      case eWorkloadTopHeavy : us += y < 270 ? 160 : 10; break;
+      case eWorkloadRamp     : us += 5 + (y * 40) / 1080; break;
+      case eWorkloadEven     : us += 25; break;
+      case eWorkloadPreempted: us += 20; break;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  }
+};
+
+int main(int argc, char **argv)
+{
+  OFX::Benchmark::setUpHost();
+  OFX::Benchmark::threadCount() = argc > 1 ? std::max(1, atoi(argv[1])) : 8;
+
+  printf("%u threads, 1920x1080\n", OFX::Benchmark::threadCount());
+  OfxRectI window = {0, 0, 1920, 1080};
+  for(int w = eWorkloadTopHeavy; w <= eWorkloadPreempted; ++w) {
+    UnbalancedProcessor processor(OFX::Benchmark::effect(), WorkloadEnum(w));
+    processor.setRenderWindow(window);
+
+    processor.setScheduling(OFX::ImageProcessor::eSchedulingBands);
+    double bands = OFX::Benchmark::bestOf(3, [&] {processor.process();});
+    processor.setScheduling(OFX::ImageProcessor::eSchedulingRowChunks);
+    double chunks = OFX::Benchmark::bestOf(3, [&] {processor.process();});
+
+    printf("%-18s bands %7.2f ms, row chunks %7.2f ms\n", gWorkloadNames[w], bands, chunks);
+  }
+  return 0;
+}
@@ -10,6 +10,7 @@
 #include <iostream>
 #endif
 #include <stdexcept>
+#include <atomic>
 #ifdef OFX_SUPPORTS_OPENGLRENDER
 #include "ofxOpenGLRender.h"
 #endif
@@ -109,6 +110,9 @@ namespace OFX {
   }
 
   namespace Private {        
+    /** @brief bumped whenever an effect instance is deleted, which drops every cached handle to instance lookup */
+    static std::atomic<unsigned int> gEffectInstanceGeneration(0);
+
     // Suite and host pointers
     OfxHost               *gHost = 0;
     OfxImageEffectSuiteV1 *gEffectSuite = 0;
@@ -338,6 +342,12 @@ namespace OFX {
     , _clipProps(props)
   {
     OFX::Validation::validateClipDescriptorProperties(props);
+
+    _propertyNames.components = std::string("OfxImageClipPropComponents_") + name;
+    _propertyNames.depth = std::string("OfxImageClipPropDepth_") + name;
+    _propertyNames.pixelAspectRatio = std::string("OfxImageClipPropPAR_") + name;
+    _propertyNames.regionOfInterest = std::string("OfxImageClipPropRoI_") + name;
+    _propertyNames.frameRange = std::string("OfxImageClipPropFrameRange_") + name;
   }
 
   /** @brief set the label properties */
@@ -715,27 +725,125 @@ namespace OFX {
     ClipDescriptor *clip = new ClipDescriptor(name, propSet);
 
     _definedClips[name] = clip;
-    _clipComponentsPropNames[name] = std::string("OfxImageClipPropComponents_") + name;
-    _clipDepthPropNames[name] = std::string("OfxImageClipPropDepth_") + name;
-    _clipPARPropNames[name] = std::string("OfxImageClipPropPAR_") + name;
-    _clipROIPropNames[name] = std::string("OfxImageClipPropRoI_") + name;
-    _clipFrameRangePropNames[name] = std::string("OfxImageClipPropFrameRange_") + name;
+    _clipComponentsPropNames[name] = clip->getPropertyNames().components;
+    _clipDepthPropNames[name] = clip->getPropertyNames().depth;
+    _clipPARPropNames[name] = clip->getPropertyNames().pixelAspectRatio;
+    _clipROIPropNames[name] = clip->getPropertyNames().regionOfInterest;
+    _clipFrameRangePropNames[name] = clip->getPropertyNames().frameRange;
     return clip;
   }
 
+  /** @brief the action property names of a defined clip, NULL if no clip of that name was defined */
+  const ClipPropertyNames *ImageEffectDescriptor::getClipPropertyNames(const std::string &name) const
+  {
+    std::map<std::string, ClipDescriptor *>::const_iterator search = _definedClips.find(name);
+    if(search == _definedClips.end())
+      return NULL;
+    return &search->second->getPropertyNames();
+  }
+
   ////////////////////////////////////////////////////////////////////////////////
   // wraps up an image  
+
+  /** @brief turns the components of an image straight from the host's string into an enum, without copying it */
+  static PixelComponentEnum mapCStrToPixelComponentEnum(const char *str)
+  {
+    if(strcmp(str, kOfxImageComponentRGBA) == 0) return ePixelComponentRGBA;
+    if(strcmp(str, kOfxImageComponentAlpha) == 0) return ePixelComponentAlpha;
+    if(strcmp(str, kOfxImageComponentRGB) == 0) return ePixelComponentRGB;
+    if(strcmp(str, kOfxImageComponentNone) == 0) return ePixelComponentNone;
+    return ePixelComponentCustom;
+  }
+
+  /** @brief turns the depth of an image straight from the host's string into an enum */
+  static BitDepthEnum mapCStrToBitDepthEnum(const char *str)
+  {
+    if(strcmp(str, kOfxBitDepthFloat) == 0) return eBitDepthFloat;
+    if(strcmp(str, kOfxBitDepthByte) == 0) return eBitDepthUByte;
+    if(strcmp(str, kOfxBitDepthShort) == 0) return eBitDepthUShort;
+    if(strcmp(str, kOfxBitDepthHalf) == 0) return eBitDepthHalf;
+    if(strcmp(str, kOfxBitDepthNone) == 0) return eBitDepthNone;
+    return eBitDepthCustom;
+  }
+
+  /** @brief turns the premultiplication of an image straight from the host's string into an enum */
+  static PreMultiplicationEnum mapCStrToPreMultiplicationEnum(const char *str)
+  {
+    if(strcmp(str, kOfxImagePreMultiplied) == 0) return eImagePreMultiplied;
+    if(strcmp(str, kOfxImageOpaque) == 0) return eImageOpaque;
+    if(strcmp(str, kOfxImageUnPreMultiplied) == 0) return eImageUnPreMultiplied;
+    throw std::invalid_argument(str);
+  }
+
+  /** @brief turns the field of an image straight from the host's string into an enum */
+  static FieldEnum mapCStrToImageFieldEnum(const char *str)
+  {
+    if(strcmp(str, kOfxImageFieldNone) == 0) return eFieldNone;
+    if(strcmp(str, kOfxImageFieldBoth) == 0) return eFieldBoth;
+    if(strcmp(str, kOfxImageFieldLower) == 0) return eFieldLower;
+    if(strcmp(str, kOfxImageFieldUpper) == 0) return eFieldUpper;
+    OFX::Log::error(true, "Unknown field state '%s' reported on an image", str);
+    return eFieldNone;
+  }
+
   ImageBase::ImageBase(OfxPropertySetHandle props)
     : _imageProps(props)
+    , _uniqueIDFetched(false)
   {
     OFX::Validation::validateImageBaseProperties(props);
+    fetchProperties();
+  }
 
-    // and fetch all the properties
+  ImageBase::ImageBase(OfxPropertySetHandle props, bool validate, const OfxImageDescriptorV1 *descriptor)
+    : _imageProps(props)
+    , _uniqueIDFetched(false)
+  {
+    if(validate)
+      OFX::Validation::validateImageBaseProperties(props);
+
+    if(descriptor)
+      setFromDescriptor(*descriptor);
+    else
+      fetchProperties();
+  }
+
+  /** @brief fetch the properties, with a single call for each of them */
+  void ImageBase::fetchProperties()
+  {
     _rowBytes         = _imageProps.propGetInt(kOfxImagePropRowBytes);
-    _pixelAspectRatio = _imageProps.propGetDouble(kOfxImagePropPixelAspectRatio);;
-      
-    std::string str  = _imageProps.propGetString(kOfxImageEffectPropComponents);
-    _pixelComponents = mapStrToPixelComponentEnum(str);
+    _pixelAspectRatio = _imageProps.propGetDouble(kOfxImagePropPixelAspectRatio);
+    _imageProps.propGetIntN(kOfxImagePropRegionOfDefinition, &_regionOfDefinition.x1, 4);
+    _imageProps.propGetIntN(kOfxImagePropBounds, &_bounds.x1, 4);
+    _imageProps.propGetDoubleN(kOfxImageEffectPropRenderScale, &_renderScale.x, 2);
+
+    setPixelFormat(_imageProps.propGetCString(kOfxImageEffectPropComponents),
+                   _imageProps.propGetCString(kOfxImageEffectPropPixelDepth));
+    _preMultiplication = mapCStrToPreMultiplicationEnum(_imageProps.propGetCString(kOfxImageEffectPropPreMultiplication));
+    _field = mapCStrToImageFieldEnum(_imageProps.propGetCString(kOfxImagePropField));
+  }
+
+  /** @brief set the properties from the host's packed descriptor */
+  void ImageBase::setFromDescriptor(const OfxImageDescriptorV1 &descriptor)
+  {
+    _rowBytes           = descriptor.rowBytes;
+    _pixelAspectRatio   = descriptor.pixelAspectRatio;
+    _regionOfDefinition = descriptor.regionOfDefinition;
+    _bounds             = descriptor.bounds;
+    _renderScale        = descriptor.renderScale;
+
+    setPixelFormat(descriptor.components, descriptor.pixelDepth);
+    _preMultiplication = mapCStrToPreMultiplicationEnum(descriptor.preMultiplication);
+    _field = mapCStrToImageFieldEnum(descriptor.field);
+
+    // the descriptor lives as long as the image, so the ID is as cheap to take now as later
+    _uniqueID = descriptor.uniqueIdentifier ? descriptor.uniqueIdentifier : "";
+    _uniqueIDFetched = true;
+  }
+
+  /** @brief set the components and depth, and the sizes that follow from them */
+  void ImageBase::setPixelFormat(const char *components, const char *depth)
+  {
+    _pixelComponents = mapCStrToPixelComponentEnum(components);
 
     switch (_pixelComponents) {
       case ePixelComponentAlpha:
@@ -756,8 +864,7 @@ namespace OFX {
         break;
     }
 
-    str = _imageProps.propGetString(kOfxImageEffectPropPixelDepth);
-    _pixelDepth = mapStrToBitDepthEnum(str);
+    _pixelDepth = mapCStrToBitDepthEnum(depth);
 
     // compute bytes per pixel
     _pixelBytes = _pixelComponentCount;
@@ -771,42 +878,16 @@ namespace OFX {
     case eBitDepthFloat  : _pixelBytes *= 4; break;
     case eBitDepthCustom : _pixelBytes *= 0; break;
     }
+  }
 
-    str = _imageProps.propGetString(kOfxImageEffectPropPreMultiplication);
-    _preMultiplication =  mapStrToPreMultiplicationEnum(str);
-
-    _regionOfDefinition.x1 = _imageProps.propGetInt(kOfxImagePropRegionOfDefinition, 0);
-    _regionOfDefinition.y1 = _imageProps.propGetInt(kOfxImagePropRegionOfDefinition, 1);
-    _regionOfDefinition.x2 = _imageProps.propGetInt(kOfxImagePropRegionOfDefinition, 2);
-    _regionOfDefinition.y2 = _imageProps.propGetInt(kOfxImagePropRegionOfDefinition, 3);
-
-    _bounds.x1 = _imageProps.propGetInt(kOfxImagePropBounds, 0);
-    _bounds.y1 = _imageProps.propGetInt(kOfxImagePropBounds, 1);
-    _bounds.x2 = _imageProps.propGetInt(kOfxImagePropBounds, 2);
-    _bounds.y2 = _imageProps.propGetInt(kOfxImagePropBounds, 3);
-
-    str = _imageProps.propGetString(kOfxImagePropField);
-    if(str == kOfxImageFieldNone) {
-      _field = eFieldNone;
-    }
-    else if(str == kOfxImageFieldBoth) {
-      _field = eFieldBoth;
-    }
-    else if(str == kOfxImageFieldLower) {
-      _field = eFieldLower;
-    }
-    else if(str == kOfxImageFieldUpper) {
-      _field = eFieldLower;
-    }
-    else {
-      OFX::Log::error(true, "Unknown field state '%s' reported on an image", str.c_str());
-      _field = eFieldNone;
+  /** @brief the unique ID of this image, fetched the first time it is asked for as few plugins want it */
+  const std::string& ImageBase::getUniqueIdentifier(void) const
+  {
+    if(!_uniqueIDFetched) {
+      _uniqueID = _imageProps.propGetCString(kOfxImagePropUniqueIdentifier);
+      _uniqueIDFetched = true;
     }
-
-    _uniqueID = _imageProps.propGetString(kOfxImagePropUniqueIdentifier);
-
-    _renderScale.x = _imageProps.propGetDouble(kOfxImageEffectPropRenderScale, 0);
-    _renderScale.y = _imageProps.propGetDouble(kOfxImageEffectPropRenderScale, 1);
+    return _uniqueID;
   }
 
   ImageBase::~ImageBase()
@@ -825,9 +906,20 @@ namespace OFX {
     _pixelData = _imageProps.propGetPointer(kOfxImagePropData);
   }
 
+  Image::Image(OfxPropertySetHandle props, bool validate, const OfxImageDescriptorV1 *descriptor)
+    : ImageBase(props, validate, descriptor)
+  {
+    if(validate)
+      OFX::Validation::validateImageProperties(props);
+
+    _pixelData = descriptor ? descriptor->data : _imageProps.propGetPointer(kOfxImagePropData);
+  }
+
   Image::~Image()
   {
-    OFX::Private::gEffectSuite->clipReleaseImage(_imageProps.propSetHandle());
+    // images wrapping the plugin's own pixels have no handle to release
+    if(_imageProps.propSetHandle())
+      OFX::Private::gEffectSuite->clipReleaseImage(_imageProps.propSetHandle());
   }
 
 #ifdef OFX_SUPPORTS_OPENGLRENDER
@@ -878,19 +970,63 @@ namespace OFX {
     return (const void *) pix;
   }
 
+  /** @brief clip [x1, x2) on row y to the bounds, setting everything but the span's data */
+  template <class DATA>
+  static bool clipRowSpan(ImageRowSpanT<DATA> &span, const OfxRectI &bounds, int pixelBytes, int y, int x1, int x2)
+  {
+    x2 = std::max(x1, x2);
+    span.data = 0;
+    if(y < bounds.y1 || y >= bounds.y2 || pixelBytes == 0 || x2 <= bounds.x1 || x1 >= bounds.x2) {
+      span.x1 = span.x2 = x2;
+      span.left = x2 - x1;
+      span.right = 0;
+      return false;
+    }
+    span.x1 = std::max(x1, bounds.x1);
+    span.x2 = std::min(x2, bounds.x2);
+    span.left = span.x1 - x1;
+    span.right = x2 - span.x2;
+    return true;
+  }
+
+  ImageRowSpan Image::getRowSpan(int y, int x1, int x2)
+  {
+    ImageRowSpan span;
+    if(clipRowSpan(span, _bounds, _pixelBytes, y, x1, x2))
+      span.data = ((char *) _pixelData) + (size_t)(y - _bounds.y1) * _rowBytes + (size_t)(span.x1 - _bounds.x1) * _pixelBytes;
+    return span;
+  }
+
+  ConstImageRowSpan Image::getRowSpan(int y, int x1, int x2) const
+  {
+    ConstImageRowSpan span;
+    if(clipRowSpan(span, _bounds, _pixelBytes, y, x1, x2))
+      span.data = ((const char *) _pixelData) + (size_t)(y - _bounds.y1) * _rowBytes + (size_t)(span.x1 - _bounds.x1) * _pixelBytes;
+    return span;
+  }
+
   ////////////////////////////////////////////////////////////////////////////////
   // clip instance
 
   /** @brief hidden constructor */
-  Clip::Clip(ImageEffect *effect, const std::string &name, OfxImageClipHandle handle, OfxPropertySetHandle props)
+  Clip::Clip(ImageEffect *effect, const std::string &name, OfxImageClipHandle handle, OfxPropertySetHandle props, const ClipPropertyNames *propertyNames)
     : _clipName(name)
     , _clipProps(props)
     , _clipHandle(handle)
     , _effect(effect)
+    , _propertyNames(propertyNames)
   {
     OFX::Validation::validateClipInstanceProperties(_clipProps);
   }
 
+  /** @brief names of the action properties for this clip, throws if the clip was never defined */
+  const ClipPropertyNames &Clip::getPropertyNames(void) const
+  {
+    if(!_propertyNames)
+      throw(Exception::PropertyUnknownToHost(_clipName.c_str()));
+    return *_propertyNames;
+  }
+
   /** @brief fetch the label */
   void Clip::getLabel(std::string &label) const
   {
@@ -1111,6 +1247,31 @@ namespace OFX {
     return bounds;
   }
 
+  /** @brief whether the host puts packed descriptors on its images, -1 until an image has been fetched */
+  static std::atomic<int> gHostPackedImageDescriptors(-1);
+
+  /** @brief get the packed descriptor the host put on an image, if it supports them */
+  static const OfxImageDescriptorV1 *fetchPackedImageDescriptor(OfxPropertySetHandle imageHandle)
+  {
+    if(gHostPackedImageDescriptors.load(std::memory_order_relaxed) == 0)
+      return NULL;
+
+    // go straight to the suite, a host without them is not an error
+    void *descriptor = NULL;
+    OfxStatus stat = OFX::Private::gPropSuite->propGetPointer(imageHandle, kOfxImagePropPackedDescriptor, 0, &descriptor);
+    if(stat != kOfxStatOK)
+      descriptor = NULL;
+    gHostPackedImageDescriptors.store(descriptor != NULL, std::memory_order_relaxed);
+    return (const OfxImageDescriptorV1 *) descriptor;
+  }
+
+  /** @brief wrap up an image fetched from this clip */
+  Image *Clip::makeImage(OfxPropertySetHandle imageHandle)
+  {
+    // the validation skips sets of a shape it has already checked, so this is cheap after the first image
+    return new Image(imageHandle, true, fetchPackedImageDescriptor(imageHandle));
+  }
+
   /** @brief fetch an image */
   Image *Clip::fetchImage(double t)
   {
@@ -1122,7 +1283,7 @@ namespace OFX {
     else
       throwSuiteStatusException(stat);
 
-    return new Image(imageHandle);
+    return makeImage(imageHandle);
   }
 
   /** @brief fetch an image, with a specific region in cannonical coordinates */
@@ -1136,7 +1297,7 @@ namespace OFX {
     else
       throwSuiteStatusException(stat);
 
-    return new Image(imageHandle);
+    return makeImage(imageHandle);
   }
 
 #ifdef OFX_SUPPORTS_OPENGLRENDER
@@ -1161,7 +1322,9 @@ namespace OFX {
     : _effectHandle(handle)
     , _effectProps(0)
     , _context(eContextNone)
+    , _descriptor(NULL)
     , _progressStartSuccess(false)
+    , _renderParamSnapshots(false)
   {
     // get the property handle
     _effectProps = OFX::Private::fetchEffectProps(handle);
@@ -1187,8 +1350,9 @@ namespace OFX {
   /** @brief dtor */
   ImageEffect::~ImageEffect()
   {
-    // clobber the instance data property on the effect handle
+    // clobber the instance data property on the effect handle, and any cached lookups of it
     _effectProps.propSetPointer(kOfxPropInstanceData, 0);
+    ++OFX::Private::gEffectInstanceGeneration;
 
     // delete any clip instances we may have constructed
     std::map<std::string, Clip *>::iterator iter;
@@ -1200,6 +1364,16 @@ namespace OFX {
     }
   }
 
+  /** @brief set the descriptor, and resolve the property names of any clips the plugin fetched while being made */
+  void ImageEffect::setDescriptor(const ImageEffectDescriptor *desc)
+  {
+    _descriptor = desc;
+
+    std::map<std::string, Clip *>::iterator iter;
+    for(iter = _fetchedClips.begin(); iter != _fetchedClips.end(); ++iter)
+      iter->second->_propertyNames = desc->getClipPropertyNames(iter->first);
+  }
+
   /** @brief the context this effect was instantiate in */
   ContextEnum ImageEffect::getContext(void) const
   {
@@ -1343,8 +1517,8 @@ namespace OFX {
     OfxStatus stat = OFX::Private::gEffectSuite->clipGetHandle(_effectHandle, name.c_str(), &clipHandle, &propHandle);
     throwSuiteStatusException(stat);
 
-    // and make one
-    Clip *newClip = new Clip(this, name, clipHandle, propHandle);
+    // and make one, with the property names made when its descriptor was defined
+    Clip *newClip = new Clip(this, name, clipHandle, propHandle, _descriptor ? _descriptor->getClipPropertyNames(name) : NULL);
 
     // add it in
     _fetchedClips[name] = newClip;
@@ -1600,19 +1774,11 @@ namespace OFX {
   ////////////////////////////////////////////////////////////////////////////////
   // Class used to set the clip preferences of the effect. */ 
 
-  const std::string& ClipPreferencesSetter::extractValueForName(const StringStringMap& m, const std::string& name)
-  {
-    StringStringMap::const_iterator it = m.find(name);
-    if(it==m.end())
-      throw(Exception::PropertyUnknownToHost(name.c_str()));
-    return it->second;
-  }
-
   /** @brief, force the host to set a clip's mapped component type to be \em comps.  */
   void ClipPreferencesSetter::setClipComponents(Clip &clip, PixelComponentEnum comps)
   {
     doneSomething_ = true;
-    const std::string& propName = extractValueForName(clipComponentPropNames_, clip.name());
+    const std::string& propName = clip.getPropertyNames().components;
 
     switch(comps) 
     {
@@ -1637,7 +1803,7 @@ namespace OFX {
   void ClipPreferencesSetter::setClipBitDepth(Clip &clip, BitDepthEnum bitDepth)
   {
     doneSomething_ = true;
-    const std::string& propName = extractValueForName(clipDepthPropNames_, clip.name());
+    const std::string& propName = clip.getPropertyNames().depth;
 
     switch(bitDepth) 
     {
@@ -1665,7 +1831,7 @@ namespace OFX {
   void ClipPreferencesSetter::setPixelAspectRatio(Clip &clip, double PAR)
   {
     doneSomething_ = true;
-    const std::string& propName = extractValueForName(clipPARPropNames_, clip.name());
+    const std::string& propName = clip.getPropertyNames().pixelAspectRatio;
     outArgs_.propSetDouble(propName.c_str(), PAR);
   }
 
@@ -1971,9 +2137,27 @@ namespace OFX {
     }
 
 
-    /** @brief fetches our pointer out of the props on the handle */
+    /** @brief a handle's effect instance, as cached by one thread */
+    struct EffectPointerCacheEntry {
+      OfxImageEffectHandle handle;
+      ImageEffect         *instance;
+      unsigned int         generation;
+    };
+
+    /** @brief number of handles each thread remembers, a power of two */
+    static const int kEffectPointerCacheSize = 8;
+
+    /** @brief each thread's cache of handles to instances, so it needs no locking */
+    static thread_local EffectPointerCacheEntry gEffectPointerCache[kEffectPointerCacheSize];
+
+    /** @brief fetches our pointer out of the props on the handle, or from the calling thread's cache of them */
     ImageEffect *retrieveImageEffectPointer(OfxImageEffectHandle handle) 
     {
+      unsigned int generation = gEffectInstanceGeneration.load(std::memory_order_acquire);
+      EffectPointerCacheEntry &entry = gEffectPointerCache[(reinterpret_cast<uintptr_t>(handle) >> 4) & (kEffectPointerCacheSize - 1)];
+      if(entry.handle == handle && entry.generation == generation && handle)
+        return entry.instance;
+
       ImageEffect *instance;
 
       // get the prop set on the handle
@@ -1991,6 +2175,13 @@ namespace OFX {
 
       // need to throw something here
 
+      // remember it, unless it is still being made
+      if(instance) {
+        entry.handle = handle;
+        entry.instance = instance;
+        entry.generation = generation;
+      }
+
       // and dance to the music
       return instance;
     }
@@ -1998,24 +2189,24 @@ namespace OFX {
     /** @brief Checks the handles passed into the plugin's main entry point */
     static
     void
-      checkMainHandles(const std::string &action,  const void *handle, 
+      checkMainHandles(const char *action,  const void *handle, 
       OfxPropertySetHandle inArgsHandle,  OfxPropertySetHandle outArgsHandle,
       bool handleCanBeNull, bool inArgsCanBeNull, bool outArgsCanBeNull)
     {
       if(handleCanBeNull)
-        OFX::Log::warning(handle != 0, "Handle passed to '%s' is not null.", action.c_str());
+        OFX::Log::warning(handle != 0, "Handle passed to '%s' is not null.", action);
       else
-        OFX::Log::error(handle == 0, "'Handle passed to '%s' is null.", action.c_str());
+        OFX::Log::error(handle == 0, "'Handle passed to '%s' is null.", action);
 
       if(inArgsCanBeNull)
-        OFX::Log::warning(inArgsHandle != 0, "'inArgs' Handle passed to '%s' is not null.", action.c_str());
+        OFX::Log::warning(inArgsHandle != 0, "'inArgs' Handle passed to '%s' is not null.", action);
       else
-        OFX::Log::error(inArgsHandle == 0, "'inArgs' handle passed to '%s' is null.", action.c_str());
+        OFX::Log::error(inArgsHandle == 0, "'inArgs' handle passed to '%s' is null.", action);
 
       if(outArgsCanBeNull)
-        OFX::Log::warning(outArgsHandle != 0, "'outArgs' Handle passed to '%s' is not null.", action.c_str());
+        OFX::Log::warning(outArgsHandle != 0, "'outArgs' Handle passed to '%s' is not null.", action);
       else
-        OFX::Log::error(outArgsHandle == 0, "'outArgs' handle passed to '%s' is null.", action.c_str());
+        OFX::Log::error(outArgsHandle == 0, "'outArgs' handle passed to '%s' is null.", action);
 
       // validate the property sets on the arguments
       OFX::Validation::validateActionArgumentsProperties(action, inArgsHandle, outArgsHandle);
@@ -2033,13 +2224,9 @@ namespace OFX {
     {
       args.time = inArgs.propGetDouble(kOfxPropTime);
 
-      args.renderScale.x = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 0);
-      args.renderScale.y = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 1);
+      inArgs.propGetDoubleN(kOfxImageEffectPropRenderScale, &args.renderScale.x, 2);
 
-      args.renderWindow.x1 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 0);
-      args.renderWindow.y1 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 1);
-      args.renderWindow.x2 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 2);
-      args.renderWindow.y2 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 3);
+      inArgs.propGetIntN(kOfxImageEffectPropRenderWindow, &args.renderWindow.x1, 4);
 
 #ifdef OFX_SUPPORTS_OPENGLRENDER
       // Don't throw an exception if the following inArgs are not present.
@@ -2079,8 +2266,21 @@ namespace OFX {
       // get the arguments 
       getRenderActionArguments(args, inArgs);
 
-      // and call the plugin client render code
-      effectInstance->render(args);
+      // and call the plugin client render code, in a param snapshot if it asked for one
+      if(!effectInstance->getRenderParamSnapshots()) {
+        effectInstance->render(args);
+        return;
+      }
+
+      effectInstance->beginParamSnapshot(args.time);
+      try {
+        effectInstance->render(args);
+      }
+      catch(...) {
+        effectInstance->endParamSnapshot(args.time);
+        throw;
+      }
+      effectInstance->endParamSnapshot(args.time);
     }
 
     /** @brief Library side render begin sequence render action, fetches relevant properties and calls the client code */
@@ -2090,6 +2290,9 @@ namespace OFX {
     {
       ImageEffect *effectInstance = retrieveImageEffectPointer(handle);
 
+      // a new sequence takes fresh param snapshots
+      effectInstance->dropParamSnapshots();
+
       BeginSequenceRenderArguments args;
 
       args.frameRange.min = inArgs.propGetDouble(kOfxImageEffectPropFrameRange, 0);
@@ -2097,8 +2300,7 @@ namespace OFX {
 
       args.frameStep      = inArgs.propGetDouble(kOfxImageEffectPropFrameStep, 0);
 
-      args.renderScale.x = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 0);
-      args.renderScale.y = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 1);
+      inArgs.propGetDoubleN(kOfxImageEffectPropRenderScale, &args.renderScale.x, 2);
 
 #ifdef OFX_SUPPORTS_OPENGLRENDER
       // Don't throw an exception if the following inArgs are not present.
@@ -2124,8 +2326,7 @@ namespace OFX {
 
       EndSequenceRenderArguments args;
 
-      args.renderScale.x = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 0);
-      args.renderScale.y = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 1);
+      inArgs.propGetDoubleN(kOfxImageEffectPropRenderScale, &args.renderScale.x, 2);
 
 #ifdef OFX_SUPPORTS_OPENGLRENDER
       // Don't throw an exception if the following inArgs are not present.
@@ -2149,13 +2350,9 @@ namespace OFX {
     {
       args.time = inArgs.propGetDouble(kOfxPropTime);
 
-      args.renderScale.x = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 0);
-      args.renderScale.y = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 1);
+      inArgs.propGetDoubleN(kOfxImageEffectPropRenderScale, &args.renderScale.x, 2);
 
-      args.renderWindow.x1 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 0);
-      args.renderWindow.y1 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 1);
-      args.renderWindow.x2 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 2);
-      args.renderWindow.y2 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 3);
+      inArgs.propGetIntN(kOfxImageEffectPropRenderWindow, &args.renderWindow.x1, 4);
 
       std::string str = inArgs.propGetString(kOfxImageEffectPropFieldToRender);
       try {
@@ -2201,8 +2398,7 @@ namespace OFX {
       ImageEffect *effectInstance = retrieveImageEffectPointer(handle);
       RegionOfDefinitionArguments args;
 
-      args.renderScale.x = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 0);
-      args.renderScale.y = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 1);
+      inArgs.propGetDoubleN(kOfxImageEffectPropRenderScale, &args.renderScale.x, 2);
 
       args.time = inArgs.propGetDouble(kOfxPropTime);
 
@@ -2223,19 +2419,17 @@ namespace OFX {
     /** @brief Library side get regions of interest function */
     static
     bool
-      regionsOfInterestAction(OfxImageEffectHandle handle, OFX::PropertySet inArgs, OFX::PropertySet &outArgs, const char* plugname)
+      regionsOfInterestAction(OfxImageEffectHandle handle, OFX::PropertySet inArgs, OFX::PropertySet &outArgs)
     {
       /** @brief local class to set the roi of a clip */
       class LOCAL ActualROISetter : public OFX::RegionOfInterestSetter {
         OFX::PropertySet &outArgs_;
         bool doneSomething_;
-        const std::map<std::string, std::string>& clipROIPropNames_;
       public :
         /** @brief ctor */
-        ActualROISetter(OFX::PropertySet &args, const std::map<std::string, std::string>& clipROIPropNames) 
+        ActualROISetter(OFX::PropertySet &args) 
           : outArgs_(args)
           , doneSomething_(false) 
-          , clipROIPropNames_(clipROIPropNames)
         { }
 
         /** @brief did we set something ? */
@@ -2244,18 +2438,11 @@ namespace OFX {
         /** @brief set the RoI of the clip */
         virtual void setRegionOfInterest(const Clip &clip, const OfxRectD &roi)
         {
-          std::map<std::string, std::string>::const_iterator it = clipROIPropNames_.find(clip.name());
-          if(it==clipROIPropNames_.end())
-            throw(Exception::PropertyUnknownToHost(clip.name().c_str()));
-
-          // construct the name of the property
-          const std::string& propName = it->second;
+          // the name of the property was made when the clip was defined
+          const std::string& propName = clip.getPropertyNames().regionOfInterest;
 
           // and set it
-          outArgs_.propSetDouble(propName.c_str(), roi.x1, 0);
-          outArgs_.propSetDouble(propName.c_str(), roi.y1, 1);
-          outArgs_.propSetDouble(propName.c_str(), roi.x2, 2);
-          outArgs_.propSetDouble(propName.c_str(), roi.y2, 3);      
+          outArgs_.propSetDoubleN(propName.c_str(), &roi.x1, 4);
 
           // and record the face we have done something
           doneSomething_ = true;
@@ -2267,18 +2454,14 @@ namespace OFX {
       RegionsOfInterestArguments args;
 
       // fetch in arguments from the prop handle
-      args.renderScale.x = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 0);
-      args.renderScale.y = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 1);
+      inArgs.propGetDoubleN(kOfxImageEffectPropRenderScale, &args.renderScale.x, 2);
 
-      args.regionOfInterest.x1 = inArgs.propGetDouble(kOfxImageEffectPropRegionOfInterest, 0);
-      args.regionOfInterest.y1 = inArgs.propGetDouble(kOfxImageEffectPropRegionOfInterest, 1);
-      args.regionOfInterest.x2 = inArgs.propGetDouble(kOfxImageEffectPropRegionOfInterest, 2);
-      args.regionOfInterest.y2 = inArgs.propGetDouble(kOfxImageEffectPropRegionOfInterest, 3);
+      inArgs.propGetDoubleN(kOfxImageEffectPropRegionOfInterest, &args.regionOfInterest.x1, 4);
 
       args.time = inArgs.propGetDouble(kOfxPropTime);
         
       // make a roi setter object
-      ActualROISetter setRoIs(outArgs, gEffectDescriptors[plugname][effectInstance->getContext()]->getClipROIPropNames());
+      ActualROISetter setRoIs(outArgs);
 
       // and call the plugin client code
       effectInstance->getRegionsOfInterest(args, setRoIs);
@@ -2292,24 +2475,31 @@ namespace OFX {
     /** @brief Library side frames needed action */
     static
     bool
-      framesNeededAction(OfxImageEffectHandle handle, OFX::PropertySet inArgs, OFX::PropertySet &outArgs, const char* plugname)
+      framesNeededAction(OfxImageEffectHandle handle, OFX::PropertySet inArgs, OFX::PropertySet &outArgs)
     {
       /** @brief local class to set the frames needed from a clip */
       class LOCAL ActualSetter : public OFX::FramesNeededSetter {
-        OFX::PropertySet &outArgs_;                                  /**< @brief property set to set values in */
-        std::map<std::string, std::vector<OfxRangeD> > frameRanges_;  /**< @brief map holding a bunch of frame ranges, one for each clip */
-        const std::map<std::string, std::string>& _clipFrameRangePropNames;
+        typedef std::pair<const Clip *, std::vector<double> > ClipRanges;
+        OFX::PropertySet &outArgs_;            /**< @brief property set to set values in */
+        std::vector<ClipRanges> frameRanges_;  /**< @brief the flattened frame ranges of each clip, in the order first set */
       public :
         /** @brief ctor */
-        ActualSetter(OFX::PropertySet &args, const std::map<std::string, std::string>& clipFrameRangePropNames) 
-          : outArgs_(args), _clipFrameRangePropNames(clipFrameRangePropNames) 
+        ActualSetter(OFX::PropertySet &args) 
+          : outArgs_(args)
         { }
 
         /** @brief set the RoI of the clip */
         virtual void setFramesNeeded(const Clip &clip, const OfxRangeD &range) 
         {
-          // insert this into the vector which is in the map
-          frameRanges_[clip.name()].push_back(range);
+          // effects have a handful of clips, so a linear search on the clip's address beats a map keyed on its name
+          std::vector<ClipRanges>::iterator i = frameRanges_.begin();
+          while(i != frameRanges_.end() && i->first != &clip)
+            ++i;
+          if(i == frameRanges_.end())
+            i = frameRanges_.insert(i, ClipRanges(&clip, std::vector<double>()));
+
+          i->second.push_back(range.min);
+          i->second.push_back(range.max);
         }
 
         /** @brief write frameRanges_ back to the property set */
@@ -2317,29 +2507,17 @@ namespace OFX {
         {
           bool didSomething = false;
 
-          std::map<std::string, std::vector<OfxRangeD> >::iterator i;
+          std::vector<ClipRanges>::iterator i;
 
           for(i = frameRanges_.begin(); i != frameRanges_.end(); ++i) {
-            if(i->first != kOfxImageEffectOutputClipName) {
+            if(i->first->name() != kOfxImageEffectOutputClipName) {
               didSomething = true;
 
-              // Make the property name we are setting
-              const std::map<std::string, std::string>::const_iterator it = _clipFrameRangePropNames.find(i->first);
-              if(it==_clipFrameRangePropNames.end())
-                throw(Exception::PropertyUnknownToHost(i->first.c_str()));
-
-              const std::string& propName = it->second;
-
-              // fetch the list of frame ranges
-              std::vector<OfxRangeD> &clipRange = i->second;
-              std::vector<OfxRangeD>::iterator j;
-              int n = 0;
+              // the name of the property was made when the clip was defined
+              const std::string& propName = i->first->getPropertyNames().frameRange;
 
               // and set 'em
-              for(j = clipRange.begin(); j < clipRange.end(); ++j) {
-                outArgs_.propSetDouble(propName.c_str(), j->min, n++);
-                outArgs_.propSetDouble(propName.c_str(), j->max, n++);
-              }
+              outArgs_.propSetDoubleN(propName.c_str(), &i->second[0], int(i->second.size()));
             }
           }
 
@@ -2356,7 +2534,7 @@ namespace OFX {
       args.time = inArgs.propGetDouble(kOfxPropTime);
 
       // make a roi setter object
-      ActualSetter setFrames(outArgs, gEffectDescriptors[plugname][effectInstance->getContext()]->getClipFrameRangePropNames());
+      ActualSetter setFrames(outArgs);
 
       // and call the plugin client code
       effectInstance->getFramesNeeded(args, setFrames);
@@ -2394,14 +2572,13 @@ namespace OFX {
     /** @brief Library side get regions of interest function */
     static
     bool
-      clipPreferencesAction(OfxImageEffectHandle handle, OFX::PropertySet &outArgs, const char* plugname)
+      clipPreferencesAction(OfxImageEffectHandle handle, OFX::PropertySet &outArgs)
     {
       // fetch our effect pointer 
       ImageEffect *effectInstance = retrieveImageEffectPointer(handle);
 
       // set up our clip preferences setter
-      ImageEffectDescriptor* desc = gEffectDescriptors[plugname][effectInstance->getContext()];
-      ClipPreferencesSetter prefs(outArgs, desc->getClipDepthPropNames(), desc->getClipComponentPropNames(), desc->getClipPARPropNames());
+      ClipPreferencesSetter prefs(outArgs);
 
       // and call the plug-in client code
       effectInstance->getClipPreferences(prefs);
@@ -2433,14 +2610,16 @@ namespace OFX {
     {
       ImageEffect *effectInstance = retrieveImageEffectPointer(handle);
 
+      // whatever changed, the param snapshots may be stale now
+      effectInstance->dropParamSnapshots();
+
       InstanceChangedArgs args;
 
       // why did it change
       std::string reasonStr = inArgs.propGetString(kOfxPropChangeReason);
       args.reason = mapToInstanceChangedReason(reasonStr);
       args.time = inArgs.propGetDouble(kOfxPropTime);
-      args.renderScale.x = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 0);
-      args.renderScale.y = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 1);
+      inArgs.propGetDoubleN(kOfxImageEffectPropRenderScale, &args.renderScale.x, 2);
 
       // what changed
       std::string changedType = inArgs.propGetString(kOfxPropType);
@@ -2474,6 +2653,134 @@ namespace OFX {
     }
 
 
+    /** @brief the actions mainEntryStr dispatches */
+    enum ActionEnum {
+      eActionUnknown,
+      eActionLoad,
+      eActionUnload,
+      eActionDescribe,
+      eActionDescribeInContext,
+      eActionCreateInstance,
+      eActionDestroyInstance,
+      eActionRender,
+      eActionBeginSequenceRender,
+      eActionEndSequenceRender,
+      eActionIsIdentity,
+      eActionGetRegionOfDefinition,
+      eActionGetRegionsOfInterest,
+      eActionGetFramesNeeded,
+      eActionGetClipPreferences,
+      eActionPurgeCaches,
+      eActionSyncPrivateData,
+      eActionGetTimeDomain,
+      eActionBeginInstanceChanged,
+      eActionInstanceChanged,
+      eActionEndInstanceChanged,
+      eActionBeginInstanceEdit,
+      eActionEndInstanceEdit,
+      eActionOpenGLContextAttached,
+      eActionOpenGLContextDetached
+    };
+
+    /** @brief an action's name and enum */
+    struct ActionName {
+      const char *name;
+      ActionEnum  action;
+    };
+
+    /** @brief all the actions mainEntryStr dispatches */
+    static const ActionName gActionNames[] = {
+      { kOfxActionLoad, eActionLoad },
+      { kOfxActionUnload, eActionUnload },
+      { kOfxActionDescribe, eActionDescribe },
+      { kOfxImageEffectActionDescribeInContext, eActionDescribeInContext },
+      { kOfxActionCreateInstance, eActionCreateInstance },
+      { kOfxActionDestroyInstance, eActionDestroyInstance },
+      { kOfxImageEffectActionRender, eActionRender },
+      { kOfxImageEffectActionBeginSequenceRender, eActionBeginSequenceRender },
+      { kOfxImageEffectActionEndSequenceRender, eActionEndSequenceRender },
+      { kOfxImageEffectActionIsIdentity, eActionIsIdentity },
+      { kOfxImageEffectActionGetRegionOfDefinition, eActionGetRegionOfDefinition },
+      { kOfxImageEffectActionGetRegionsOfInterest, eActionGetRegionsOfInterest },
+      { kOfxImageEffectActionGetFramesNeeded, eActionGetFramesNeeded },
+      { kOfxImageEffectActionGetClipPreferences, eActionGetClipPreferences },
+      { kOfxActionPurgeCaches, eActionPurgeCaches },
+      { kOfxActionSyncPrivateData, eActionSyncPrivateData },
+      { kOfxImageEffectActionGetTimeDomain, eActionGetTimeDomain },
+      { kOfxActionBeginInstanceChanged, eActionBeginInstanceChanged },
+      { kOfxActionInstanceChanged, eActionInstanceChanged },
+      { kOfxActionEndInstanceChanged, eActionEndInstanceChanged },
+      { kOfxActionBeginInstanceEdit, eActionBeginInstanceEdit },
+      { kOfxActionEndInstanceEdit, eActionEndInstanceEdit },
+#ifdef OFX_SUPPORTS_OPENGLRENDER
+      { kOfxActionOpenGLContextAttached, eActionOpenGLContextAttached },
+      { kOfxActionOpenGLContextDetached, eActionOpenGLContextDetached },
+#endif
+    };
+
+    /** @brief A perfect hash table of the action names. The seed of the hash is picked when
+        the table is made, so that no two names land in the same slot, so finding an action
+        is a hash of its name and one strcmp to confirm it. */
+    class ActionTable {
+      static const int kSize = 64; ///< a power of two, comfortably more than the number of actions
+
+      unsigned int       _seed;
+      const ActionName  *_slots[kSize];
+
+      /** @brief FNV-1a of the string, from a basis offset by the seed */
+      static unsigned int hash(const char *str, unsigned int seed)
+      {
+        unsigned int h = 2166136261u ^ seed;
+        for(; *str; ++str)
+          h = (h ^ (unsigned char)*str) * 16777619u;
+        return h;
+      }
+
+    public :
+      ActionTable()
+        : _seed(0)
+      {
+        int nActions = int(sizeof(gActionNames) / sizeof(gActionNames[0]));
+        for(;; ++_seed) {
+          std::fill(_slots, _slots + kSize, (const ActionName *) 0);
+          int i = 0;
+          for(; i < nActions; ++i) {
+            const ActionName *&slot = _slots[hash(gActionNames[i].name, _seed) & (kSize - 1)];
+            if(slot)
+              break;
+            slot = &gActionNames[i];
+          }
+          if(i == nActions)
+            break;
+        }
+      }
+
+      /** @brief the enum of an action, eActionUnknown if it isn't one we dispatch */
+      ActionEnum find(const char *action) const
+      {
+        if(!action)
+          return eActionUnknown;
+        const ActionName *slot = _slots[hash(action, _seed) & (kSize - 1)];
+        return slot && strcmp(slot->name, action) == 0 ? slot->action : eActionUnknown;
+      }
+    };
+
+    /** @brief turn an action string into its enum */
+    static ActionEnum mapActionToEnum(const char *action)
+    {
+      static const ActionTable table;
+      return table.find(action);
+    }
+
+    /** @brief find the factory of a plugin, for the actions that need it */
+    static OFX::PluginFactory *fetchPluginFactory(const char *plugname)
+    {
+      OfxPlugInfoMap::iterator it = plugInfoMap.find(plugname);
+      if(it==plugInfoMap.end())
+        throw;
+      return it->second._factory;
+    }
+
     /** @brief The main entry point for the plugin
     */
     OfxStatus mainEntryStr(const char    *actionRaw,
@@ -2488,12 +2795,6 @@ namespace OFX {
       OfxStatus stat = kOfxStatReplyDefault;
       try {
 
-        OfxPlugInfoMap::iterator it = plugInfoMap.find(plugname);
-        if(it==plugInfoMap.end())
-          throw;
-
-        OFX::PluginFactory* factory = it->second._factory;
-
         // Cast the raw handle to be an image effect handle, because that is what it is
         OfxImageEffectHandle handle = (OfxImageEffectHandle) handleRaw;
 
@@ -2501,36 +2802,35 @@ namespace OFX {
         OFX::PropertySet inArgs(inArgsRaw);
         OFX::PropertySet outArgs(outArgsRaw);
 
-        // turn the action into a std::string
-        std::string action(actionRaw);
-
         // figure the actions
-        if (action == kOfxActionLoad) {
+        switch(mapActionToEnum(actionRaw)) {
+        case eActionLoad : {
           // call the support load function, param-less
           OFX::Private::loadAction(); 
 
           // call the plugin side load action, param-less
-          factory->load();
+          fetchPluginFactory(plugname)->load();
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
 
-        // figure the actions
-        else if (action == kOfxActionUnload) {
+        case eActionUnload : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, true, true, true);
 
           // call the plugin side unload action, param-less, should be called, eve if the stat above failed!
-          factory->unload();
+          fetchPluginFactory(plugname)->unload();
 
           // call the support unload function, param-less
           OFX::Private::unloadAction(plugname); 
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
 
-        else if(action == kOfxActionDescribe) {
+        case eActionDescribe : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // make the plugin descriptor
@@ -2541,15 +2841,16 @@ namespace OFX {
 
           //  and pass it to the plugin to do something with it
 
-          factory->describe(*desc);
+          fetchPluginFactory(plugname)->describe(*desc);
 
           // add it to our map
           gEffectDescriptors[plugname][eContextNone] = desc;
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionDescribeInContext) {
+        case eActionDescribeInContext : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // make the plugin descriptor and pass it to the plugin to do something with it
@@ -2563,15 +2864,16 @@ namespace OFX {
           OFX::Validation::validatePluginDescriptorProperties(fetchEffectProps(handle));
 
           // call plugin describe in context
-          factory->describeInContext(*desc, context);
+          fetchPluginFactory(plugname)->describeInContext(*desc, context);
 
           // add it to our map
           gEffectDescriptors[plugname][context] = desc;
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxActionCreateInstance) {
+        case eActionCreateInstance : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch the effect props to figure the context
@@ -2582,16 +2884,24 @@ namespace OFX {
           ContextEnum context = mapToContextEnum(str);
 
           // make the image effect instance for this context
-          ImageEffect *instance = factory->createInstance(handle, context);
-          (void)instance;
+          ImageEffect *instance = fetchPluginFactory(plugname)->createInstance(handle, context);
+
+          // point it at its descriptor now, so later actions need not look it up by name and context
+          EffectDescriptorMap::const_iterator descs = gEffectDescriptors.find(plugname);
+          if(descs != gEffectDescriptors.end()) {
+            EffectContextMap::const_iterator desc = descs->second.find(context);
+            if(desc != descs->second.end())
+              instance->setDescriptor(desc->second);
+          }
 
           // validate the plugin handle's properties
           OFX::Validation::validatePluginInstanceProperties(fetchEffectProps(handle));
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxActionDestroyInstance) {
+        case eActionDestroyInstance : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2602,8 +2912,9 @@ namespace OFX {
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionRender) {
+        case eActionRender : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the render action skin
@@ -2611,55 +2922,63 @@ namespace OFX {
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionBeginSequenceRender) {
+        case eActionBeginSequenceRender : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the begin render action skin
           beginSequenceRenderAction(handle, inArgs);
+          break;
         }
-        else if(action == kOfxImageEffectActionEndSequenceRender) {
+        case eActionEndSequenceRender : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the begin render action skin
           endSequenceRenderAction(handle, inArgs);
+          break;
         }
-        else if(action == kOfxImageEffectActionIsIdentity) {
+        case eActionIsIdentity : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, false);
 
           // call the identity action, if it is, return OK
           if(isIdentityAction(handle, inArgs, outArgs))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionGetRegionOfDefinition) {
+        case eActionGetRegionOfDefinition : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, false);
 
           // call the rod action, return OK if it does something
           if(regionOfDefinitionAction(handle, inArgs, outArgs))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionGetRegionsOfInterest) {
+        case eActionGetRegionsOfInterest : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, false);
 
           // call the RoI action, return OK if it does something
-          if(regionsOfInterestAction(handle, inArgs, outArgs, plugname))
+          if(regionsOfInterestAction(handle, inArgs, outArgs))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionGetFramesNeeded) {
+        case eActionGetFramesNeeded : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, false);
 
           // call the frames needed action, return OK if it does something
-          if(framesNeededAction(handle, inArgs, outArgs, plugname))
+          if(framesNeededAction(handle, inArgs, outArgs))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionGetClipPreferences) {
+        case eActionGetClipPreferences : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, false);
 
           // call the frames needed action, return OK if it does something
-          if(clipPreferencesAction(handle, outArgs, plugname))
+          if(clipPreferencesAction(handle, outArgs))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxActionPurgeCaches) {
+        case eActionPurgeCaches : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2667,8 +2986,9 @@ namespace OFX {
 
           // purge 'em
           instance->purgeCaches();
+          break;
         }
-        else if(action == kOfxActionSyncPrivateData) {
+        case eActionSyncPrivateData : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2676,33 +2996,38 @@ namespace OFX {
 
           // and sync it
           instance->syncPrivateData();
+          break;
         }
-        else if(action == kOfxImageEffectActionGetTimeDomain) {
+        case eActionGetTimeDomain : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, false);
 
           // call the instance changed action
           if(getTimeDomainAction(handle, outArgs))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxActionBeginInstanceChanged) {
+        case eActionBeginInstanceChanged : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the instance changed action
           beginInstanceChangedAction(handle, inArgs);
+          break;
         }
-        else if(action == kOfxActionInstanceChanged) {
+        case eActionInstanceChanged : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the instance changed action
           instanceChangedAction(handle, inArgs);
+          break;
         }
-        else if(action == kOfxActionEndInstanceChanged) {
+        case eActionEndInstanceChanged : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the instance changed action
           endInstanceChangedAction(handle, inArgs);
+          break;
         }
-        else if(action == kOfxActionBeginInstanceEdit) {
+        case eActionBeginInstanceEdit : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2710,8 +3035,9 @@ namespace OFX {
 
           // call the begin edit function
           instance->beginEdit();
+          break;
         }
-        else if(action == kOfxActionEndInstanceEdit) {
+        case eActionEndInstanceEdit : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2719,9 +3045,10 @@ namespace OFX {
 
           // call the end edit function
           instance->endEdit();
+          break;
         }
 #ifdef OFX_SUPPORTS_OPENGLRENDER
-        else if(action == kOfxActionOpenGLContextAttached) {
+        case eActionOpenGLContextAttached : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2729,8 +3056,9 @@ namespace OFX {
 
           // call the context attached function
           instance->contextAttached();
+          break;
         }
-        else if(action == kOfxActionOpenGLContextDetached) {
+        case eActionOpenGLContextDetached : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2738,13 +3066,15 @@ namespace OFX {
 
           // call the context detached function
           instance->contextDetached();
+          break;
         }
 #endif
-        else if(actionRaw) {
-          OFX::Log::error(true, "Unknown action '%s'.", actionRaw);
-        }
-        else {
-          OFX::Log::error(true, "Requested action was a null pointer.");
+        default :
+          if(actionRaw)
+            OFX::Log::error(true, "Unknown action '%s'.", actionRaw);
+          else
+            OFX::Log::error(true, "Requested action was a null pointer.");
+          break;
         }
       }
 
@@ -10,6 +10,41 @@
 /** @brief The core 'OFX Support' namespace, used by plugin implementations. All code for these are defined in the common support libraries. */
 namespace OFX {  
 
+  namespace Private {
+    /** @brief most values a snapshotted param has, an RGBA param */
+    static const int kParamSnapshotSlotSize = 4;
+
+    /** @brief the most snapshots a param set keeps, at different times */
+    static const int kMaxParamSnapshots = 4;
+
+    /** @brief The values of a param set's params at one time, see ParamSet::beginParamSnapshot. It is filled in
+        once, when it is made, and only read from then on, so every thread rendering at that time shares it. */
+    struct ParamSnapshot {
+      double time;
+      std::vector<double> values; // kParamSnapshotSlotSize per slot
+      std::vector<char> valid;    // one per slot
+    };
+
+    /** @brief a snapshot a thread has begun */
+    struct ActiveParamSnapshot {
+      const ParamSet *paramSet;
+      std::shared_ptr<const ParamSnapshot> snapshot;
+      int depth;                  // number of begins not yet ended
+    };
+
+    /** @brief the snapshots begun on this thread. Only ever touched by its own thread, so needs no lock */
+    static thread_local std::vector<ActiveParamSnapshot> tParamSnapshots;
+
+    /** @brief this thread's snapshot of a param set at a time, NULL if it has none */
+    static ActiveParamSnapshot *findParamSnapshot(const ParamSet *paramSet, double time)
+    {
+      for(size_t i = 0; i < tParamSnapshots.size(); ++i)
+        if(tParamSnapshots[i].paramSet == paramSet && tParamSnapshots[i].snapshot->time == time)
+          return &tParamSnapshots[i];
+      return NULL;
+    }
+  }
+
   /** @brief dummy page positioning parameter to be passed to @ref OFX::PageParamDescriptor::addChild */
   DummyParamDescriptor PageParamDescriptor::gSkipRow(kOfxParamPageSkipRow);
 
@@ -1300,6 +1335,7 @@ namespace OFX {
   /** @brief hidden constructor */
   ValueParam::ValueParam(const ParamSet *paramSet, const std::string &name, ParamTypeEnum type, OfxParamHandle handle)
     : Param(paramSet, name, type, handle)
+    , _snapshotSlot(paramSet->_nSnapshotSlots++)
   {
   }
 
@@ -1308,6 +1344,37 @@ namespace OFX {
   {
   }
 
+  /** @brief fetch n values at time t from this thread's snapshot of the param set at that time, false if there are none to be had */
+  bool ValueParam::getSnapshotValues(double t, double *v, int n)
+  {
+    if(Private::tParamSnapshots.empty())
+      return false;
+
+    Private::ActiveParamSnapshot *active = Private::findParamSnapshot(_paramSet, t);
+    if(!active || _snapshotSlot >= (int)active->snapshot->valid.size() || !active->snapshot->valid[_snapshotSlot])
+      return false;
+    const double *values = &active->snapshot->values[_snapshotSlot * Private::kParamSnapshotSlotSize];
+    std::copy(values, values + n, v);
+    return true;
+  }
+
+  /** @brief fetch n values at time t from this thread's snapshot of the param set at that time, false if there are none to be had */
+  bool ValueParam::getSnapshotValues(double t, int *v, int n)
+  {
+    double d[Private::kParamSnapshotSlotSize];
+    if(!getSnapshotValues(t, d, n))
+      return false;
+    for(int i = 0; i < n; ++i)
+      v[i] = (int)d[i];
+    return true;
+  }
+
+  /** @brief forget the param set's snapshots, called as the param is changed */
+  void ValueParam::dropSnapshotValues(void)
+  {
+    _paramSet->dropParamSnapshots();
+  }
+
   /** @brief Set's whether the value of the param is significant (ie: affects the rendered image) */
   void 
     ValueParam::setEvaluateOnChange(bool v)
@@ -1405,6 +1472,7 @@ namespace OFX {
   void 
     ValueParam::deleteKeyAtTime(double time)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramDeleteKey) throwHostMissingSuiteException("paramDeleteKey");
     OfxStatus stat = OFX::Private::gParamSuite->paramDeleteKey(_paramHandle, time);
     if(stat == kOfxStatFailed) return; // if no key at time, fail quietly
@@ -1415,6 +1483,7 @@ namespace OFX {
   void 
     ValueParam::deleteAllKeys(void)
   { 
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramDeleteAllKeys) throwHostMissingSuiteException("paramDeleteAllKeys");
     OfxStatus stat = OFX::Private::gParamSuite->paramDeleteAllKeys(_paramHandle);
     throwSuiteStatusException(stat); 
@@ -1423,6 +1492,7 @@ namespace OFX {
   /** @brief copy parameter from another, including any animation etc... */
   void ValueParam::copyFrom(const ValueParam& from, OfxTime dstOffset, const OfxRangeD *frameRange)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramCopy) throwHostMissingSuiteException("paramCopy");
     OfxStatus stat = OFX::Private::gParamSuite->paramCopy(_paramHandle, from._paramHandle, dstOffset, frameRange);
     throwSuiteStatusException(stat);
@@ -1487,13 +1557,23 @@ namespace OFX {
   /** @brief get the value at a time */
   void IntParam::getValueAtTime(double t, int &v)
   {
+    if(getSnapshotValues(t, &v, 1))
+      return;
     OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &v);
     throwSuiteStatusException(stat);
   }
 
+  /** @brief get the values at many times in one go */
+  void IntParam::getValuesAtTimes(const double *times, int nTimes, int *values)
+  {
+    for(int i = 0; i < nTimes; ++i)
+      getValueAtTime(times[i], values[i]);
+  }
+
   /** @brief set value */
   void IntParam::setValue(int v)
   {
+    dropSnapshotValues();
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValue(_paramHandle, v);
     throwSuiteStatusException(stat);
   }
@@ -1501,6 +1581,7 @@ namespace OFX {
   /** @brief set the value at a time, implicitly adds a keyframe */
   void IntParam::setValueAtTime(double t, int v)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramSetValueAtTime) throwHostMissingSuiteException("paramSetValueAtTime");
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValueAtTime(_paramHandle, t, v);
     throwSuiteStatusException(stat);
@@ -1584,13 +1665,25 @@ namespace OFX {
   /** @brief get the value at a time */
   void Int2DParam::getValueAtTime(double t, int &x, int &y)
   {
-    OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &x, &y);
-    throwSuiteStatusException(stat);
+    int v[2];
+    if(!getSnapshotValues(t, v, 2)) {
+      OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &v[0], &v[1]);
+      throwSuiteStatusException(stat);
+    }
+    x = v[0]; y = v[1];
+  }
+
+  /** @brief get the values at many times in one go */
+  void Int2DParam::getValuesAtTimes(const double *times, int nTimes, OfxPointI *values)
+  {
+    for(int i = 0; i < nTimes; ++i)
+      getValueAtTime(times[i], values[i].x, values[i].y);
   }
 
   /** @brief set value */
   void Int2DParam::setValue(int x, int y)
   {
+    dropSnapshotValues();
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValue(_paramHandle, x, y);
     throwSuiteStatusException(stat);
   }
@@ -1598,6 +1691,7 @@ namespace OFX {
   /** @brief set the value at a time, implicitly adds a keyframe */
   void Int2DParam::setValueAtTime(double t, int x, int y)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramSetValueAtTime) throwHostMissingSuiteException("paramSetValueAtTime");
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValueAtTime(_paramHandle, t, x, y);
     throwSuiteStatusException(stat);
@@ -1692,13 +1786,25 @@ namespace OFX {
   /** @brief get the value at a time */
   void Int3DParam::getValueAtTime(double t, int &x, int &y, int &z)
   {
-    OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &x, &y, &z);
-    throwSuiteStatusException(stat);
+    int v[3];
+    if(!getSnapshotValues(t, v, 3)) {
+      OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &v[0], &v[1], &v[2]);
+      throwSuiteStatusException(stat);
+    }
+    x = v[0]; y = v[1]; z = v[2];
+  }
+
+  /** @brief get the values at many times in one go */
+  void Int3DParam::getValuesAtTimes(const double *times, int nTimes, Ofx3DPointI *values)
+  {
+    for(int i = 0; i < nTimes; ++i)
+      getValueAtTime(times[i], values[i].x, values[i].y, values[i].z);
   }
 
   /** @brief set value */
   void Int3DParam::setValue(int x, int y, int z)
   {
+    dropSnapshotValues();
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValue(_paramHandle, x, y, z);
     throwSuiteStatusException(stat);
   }
@@ -1706,6 +1812,7 @@ namespace OFX {
   /** @brief set the value at a time, implicitly adds a keyframe */
   void Int3DParam::setValueAtTime(double t, int x, int y, int z)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramSetValueAtTime) throwHostMissingSuiteException("paramSetValueAtTime");
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValueAtTime(_paramHandle, t, x, y, z);
     throwSuiteStatusException(stat);
@@ -1859,13 +1966,23 @@ namespace OFX {
   /** @brief get the value at a time */
   void DoubleParam::getValueAtTime(double t, double &v)
   {
+    if(getSnapshotValues(t, &v, 1))
+      return;
     OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &v);
     throwSuiteStatusException(stat);
   }
 
+  /** @brief get the values at many times in one go */
+  void DoubleParam::getValuesAtTimes(const double *times, int nTimes, double *values)
+  {
+    for(int i = 0; i < nTimes; ++i)
+      getValueAtTime(times[i], values[i]);
+  }
+
   /** @brief set value */
   void DoubleParam::setValue(double v)
   {
+    dropSnapshotValues();
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValue(_paramHandle, v);
     throwSuiteStatusException(stat);
   }
@@ -1873,6 +1990,7 @@ namespace OFX {
   /** @brief set the value at a time, implicitly adds a keyframe */
   void DoubleParam::setValueAtTime(double t, double v)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramSetValueAtTime) throwHostMissingSuiteException("paramSetValueAtTime");
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValueAtTime(_paramHandle, t, v);
     throwSuiteStatusException(stat);
@@ -1972,13 +2090,25 @@ namespace OFX {
   /** @brief get the value at a time */
   void Double2DParam::getValueAtTime(double t, double &x, double &y)
   {
-    OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &x, &y);
-    throwSuiteStatusException(stat);
+    double v[2];
+    if(!getSnapshotValues(t, v, 2)) {
+      OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &v[0], &v[1]);
+      throwSuiteStatusException(stat);
+    }
+    x = v[0]; y = v[1];
+  }
+
+  /** @brief get the values at many times in one go */
+  void Double2DParam::getValuesAtTimes(const double *times, int nTimes, OfxPointD *values)
+  {
+    for(int i = 0; i < nTimes; ++i)
+      getValueAtTime(times[i], values[i].x, values[i].y);
   }
 
   /** @brief set value */
   void Double2DParam::setValue(double x, double y)
   {
+    dropSnapshotValues();
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValue(_paramHandle, x, y);
     throwSuiteStatusException(stat);
   }
@@ -1986,6 +2116,7 @@ namespace OFX {
   /** @brief set the value at a time, implicitly adds a keyframe */
   void Double2DParam::setValueAtTime(double t, double x, double y)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramSetValueAtTime) throwHostMissingSuiteException("paramSetValueAtTime");
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValueAtTime(_paramHandle, t, x, y);
     throwSuiteStatusException(stat);
@@ -2096,13 +2227,25 @@ namespace OFX {
   /** @brief get the value at a time */
   void Double3DParam::getValueAtTime(double t, double &x, double &y, double &z)
   {
-    OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &x, &y, &z);
-    throwSuiteStatusException(stat);
+    double v[3];
+    if(!getSnapshotValues(t, v, 3)) {
+      OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &v[0], &v[1], &v[2]);
+      throwSuiteStatusException(stat);
+    }
+    x = v[0]; y = v[1]; z = v[2];
+  }
+
+  /** @brief get the values at many times in one go */
+  void Double3DParam::getValuesAtTimes(const double *times, int nTimes, Ofx3DPointD *values)
+  {
+    for(int i = 0; i < nTimes; ++i)
+      getValueAtTime(times[i], values[i].x, values[i].y, values[i].z);
   }
 
   /** @brief set value */
   void Double3DParam::setValue(double x, double y, double z)
   {
+    dropSnapshotValues();
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValue(_paramHandle, x, y, z);
     throwSuiteStatusException(stat);
   }
@@ -2110,6 +2253,7 @@ namespace OFX {
   /** @brief set the value at a time, implicitly adds a keyframe */
   void Double3DParam::setValueAtTime(double t, double x, double y, double z)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramSetValueAtTime) throwHostMissingSuiteException("paramSetValueAtTime");
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValueAtTime(_paramHandle, t, x, y, z);
     throwSuiteStatusException(stat);
@@ -2165,13 +2309,25 @@ namespace OFX {
   /** @brief get the value at a time */
   void RGBParam::getValueAtTime(double t, double &r, double &g, double &b)
   {
-    OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &r, &g, &b);
-    throwSuiteStatusException(stat);
+    double v[3];
+    if(!getSnapshotValues(t, v, 3)) {
+      OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &v[0], &v[1], &v[2]);
+      throwSuiteStatusException(stat);
+    }
+    r = v[0]; g = v[1]; b = v[2];
+  }
+
+  /** @brief get the values at many times in one go */
+  void RGBParam::getValuesAtTimes(const double *times, int nTimes, OfxRGBColourD *values)
+  {
+    for(int i = 0; i < nTimes; ++i)
+      getValueAtTime(times[i], values[i].r, values[i].g, values[i].b);
   }
 
   /** @brief set value */
   void RGBParam::setValue(double r, double g, double b)
   {
+    dropSnapshotValues();
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValue(_paramHandle, r, g, b);
     throwSuiteStatusException(stat);
   }
@@ -2179,6 +2335,7 @@ namespace OFX {
   /** @brief set the value at a time, implicitly adds a keyframe */
   void RGBParam::setValueAtTime(double t, double r, double g, double b)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramSetValueAtTime) throwHostMissingSuiteException("paramSetValueAtTime");
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValueAtTime(_paramHandle, t, r, g, b);
     throwSuiteStatusException(stat);
@@ -2221,13 +2378,25 @@ namespace OFX {
   /** @brief get the value at a time */
   void RGBAParam::getValueAtTime(double t, double &r, double &g, double &b, double &a)
   {
-    OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &r, &g, &b, &a);
-    throwSuiteStatusException(stat);
+    double v[4];
+    if(!getSnapshotValues(t, v, 4)) {
+      OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &v[0], &v[1], &v[2], &v[3]);
+      throwSuiteStatusException(stat);
+    }
+    r = v[0]; g = v[1]; b = v[2]; a = v[3];
+  }
+
+  /** @brief get the values at many times in one go */
+  void RGBAParam::getValuesAtTimes(const double *times, int nTimes, OfxRGBAColourD *values)
+  {
+    for(int i = 0; i < nTimes; ++i)
+      getValueAtTime(times[i], values[i].r, values[i].g, values[i].b, values[i].a);
   }
 
   /** @brief set value */
   void RGBAParam::setValue(double r, double g, double b, double a)
   {
+    dropSnapshotValues();
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValue(_paramHandle, r, g, b, a);
     throwSuiteStatusException(stat);
   }
@@ -2235,6 +2404,7 @@ namespace OFX {
   /** @brief set the value at a time, implicitly adds a keyframe */
   void RGBAParam::setValueAtTime(double t, double r, double g, double b, double a)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramSetValueAtTime) throwHostMissingSuiteException("paramSetValueAtTime");
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValueAtTime(_paramHandle, t, r, g, b, a);
     throwSuiteStatusException(stat);
@@ -2328,14 +2498,17 @@ namespace OFX {
   void BooleanParam::getValueAtTime(double t, bool &v)
   {
     int iVal;
-    OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &iVal);
-    throwSuiteStatusException(stat);
+    if(!getSnapshotValues(t, &iVal, 1)) {
+      OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &iVal);
+      throwSuiteStatusException(stat);
+    }
     v = iVal != 0;
   }
 
   /** @brief set value */
   void BooleanParam::setValue(bool v)
   {
+    dropSnapshotValues();
     int iVal = v;
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValue(_paramHandle, iVal);
     throwSuiteStatusException(stat);
@@ -2344,6 +2517,7 @@ namespace OFX {
   /** @brief set the value at a time, implicitly adds a keyframe */
   void BooleanParam::setValueAtTime(double t, bool v)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramSetValueAtTime) throwHostMissingSuiteException("paramSetValueAtTime");
     int iVal = v;
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValueAtTime(_paramHandle, t, iVal);
@@ -2382,6 +2556,8 @@ namespace OFX {
   /** @brief get the value at a time */
   void ChoiceParam::getValueAtTime(double t, int &v)
   {
+    if(getSnapshotValues(t, &v, 1))
+      return;
     OfxStatus stat = OFX::Private::gParamSuite->paramGetValueAtTime(_paramHandle, t, &v);
     throwSuiteStatusException(stat);
   }
@@ -2389,6 +2565,7 @@ namespace OFX {
   /** @brief set value */
   void ChoiceParam::setValue(int v)
   {
+    dropSnapshotValues();
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValue(_paramHandle, v);
     throwSuiteStatusException(stat);
   }
@@ -2396,6 +2573,7 @@ namespace OFX {
   /** @brief set the value at a time, implicitly adds a keyframe */
   void ChoiceParam::setValueAtTime(double t, int v)
   {
+    dropSnapshotValues();
     if(!OFX::Private::gParamSuite->paramSetValueAtTime) throwHostMissingSuiteException("paramSetValueAtTime");
     OfxStatus stat = OFX::Private::gParamSuite->paramSetValueAtTime(_paramHandle, t, v);
     throwSuiteStatusException(stat);
@@ -2717,6 +2895,7 @@ namespace OFX {
   /** @brief hidden ctor */
   ParamSet::ParamSet(void)
     : _paramSetHandle(0)
+    , _nSnapshotSlots(0)
   {
   }
 
@@ -2752,6 +2931,104 @@ namespace OFX {
     }
   }
 
+  /** @brief Start serving getValueAtTime(time) calls on this set's params from a snapshot on this thread */
+  void ParamSet::beginParamSnapshot(double time)
+  {
+    if(Private::ActiveParamSnapshot *active = Private::findParamSnapshot(this, time)) {
+      ++active->depth;
+      return;
+    }
+
+    Private::ActiveParamSnapshot active = {this, fetchParamSnapshot(time), 1};
+    Private::tParamSnapshots.push_back(active);
+  }
+
+  /** @brief Stop serving getValueAtTime(time) calls from this thread's snapshot */
+  void ParamSet::endParamSnapshot(double time)
+  {
+    for(size_t i = 0; i < Private::tParamSnapshots.size(); ++i) {
+      Private::ActiveParamSnapshot &active = Private::tParamSnapshots[i];
+      if(active.paramSet == this && active.snapshot->time == time) {
+        if(--active.depth == 0)
+          Private::tParamSnapshots.erase(Private::tParamSnapshots.begin() + i);
+        return;
+      }
+    }
+  }
+
+  /** @brief Forget the snapshots taken so far, so the next ones are taken from the host again */
+  void ParamSet::dropParamSnapshots(void) const
+  {
+    std::lock_guard<std::mutex> lock(_snapshotMutex);
+    _snapshots.clear();
+  }
+
+  /** @brief the snapshot at a time, taking it from the host if there is none yet */
+  std::shared_ptr<const Private::ParamSnapshot> ParamSet::fetchParamSnapshot(double time) const
+  {
+    // held while a snapshot is taken, so threads starting to render at the same time wait for it rather than take their own
+    std::lock_guard<std::mutex> lock(_snapshotMutex);
+    for(size_t i = 0; i < _snapshots.size(); ++i)
+      if(_snapshots[i]->time == time)
+        return _snapshots[i];
+
+    std::shared_ptr<Private::ParamSnapshot> snapshot = std::make_shared<Private::ParamSnapshot>();
+    snapshot->time = time;
+    snapshot->valid.resize(_nSnapshotSlots, 0);
+    snapshot->values.resize(snapshot->valid.size() * Private::kParamSnapshotSlotSize);
+
+    // the value of every value param fetched so far, read as ints or doubles depending on its type
+    std::map<std::string, Param *>::const_iterator iter;
+    for(iter = _fetchedParams.begin(); iter != _fetchedParams.end(); ++iter) {
+      const ValueParam *param = dynamic_cast<const ValueParam *>(iter->second);
+      if(!param || param->_snapshotSlot >= (int)snapshot->valid.size())
+        continue;
+
+      OfxParamHandle handle = param->_paramHandle;
+      double *d = &snapshot->values[param->_snapshotSlot * Private::kParamSnapshotSlotSize];
+      int i[3] = {0, 0, 0};
+      OfxStatus stat;
+      switch(param->getType()) {
+      case eIntParam :
+      case eBooleanParam :
+      case eChoiceParam :
+        stat = OFX::Private::gParamSuite->paramGetValueAtTime(handle, time, &i[0]);
+        std::copy(i, i + 1, d);
+        break;
+      case eInt2DParam :
+        stat = OFX::Private::gParamSuite->paramGetValueAtTime(handle, time, &i[0], &i[1]);
+        std::copy(i, i + 2, d);
+        break;
+      case eInt3DParam :
+        stat = OFX::Private::gParamSuite->paramGetValueAtTime(handle, time, &i[0], &i[1], &i[2]);
+        std::copy(i, i + 3, d);
+        break;
+      case eDoubleParam :
+        stat = OFX::Private::gParamSuite->paramGetValueAtTime(handle, time, &d[0]);
+        break;
+      case eDouble2DParam :
+        stat = OFX::Private::gParamSuite->paramGetValueAtTime(handle, time, &d[0], &d[1]);
+        break;
+      case eDouble3DParam :
+      case eRGBParam :
+        stat = OFX::Private::gParamSuite->paramGetValueAtTime(handle, time, &d[0], &d[1], &d[2]);
+        break;
+      case eRGBAParam :
+        stat = OFX::Private::gParamSuite->paramGetValueAtTime(handle, time, &d[0], &d[1], &d[2], &d[3]);
+        break;
+      default :
+        continue;
+      }
+      // a param the host fails on is left out, so reading it goes to the host and throws there
+      snapshot->valid[param->_snapshotSlot] = stat == kOfxStatOK;
+    }
+
+    if((int)_snapshots.size() == Private::kMaxParamSnapshots)
+      _snapshots.erase(_snapshots.begin());
+    _snapshots.push_back(snapshot);
+    return snapshot;
+  }
+
   /** @brief calls the raw OFX routine to fetch a param */
   void ParamSet::fetchRawParam(const std::string &name, ParamTypeEnum paramType, OfxParamHandle &handle) const
   {
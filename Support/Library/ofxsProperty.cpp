@@ -9,7 +9,7 @@ namespace OFX {
 
   static
   void throwPropertyException(OfxStatus stat,
-    const std::string &propName)
+    const char *propName)
   {
     switch (stat) 
     {
@@ -23,7 +23,7 @@ namespace OFX {
     case kOfxStatErrUnknown :
     case kOfxStatErrUnsupported : // unsupported implies unknow here
       if(OFX::PropertySet::getThrowOnUnsupportedProperties()) // are we suppressing this?
-        throw OFX::Exception::PropertyUnknownToHost(propName.c_str());
+        throw OFX::Exception::PropertyUnknownToHost(propName);
       break;
 
     case kOfxStatErrMemory :
@@ -31,7 +31,7 @@ namespace OFX {
       break;
 
     case kOfxStatErrValue :
-      throw  OFX::Exception::PropertyValueIllegalToHost(propName.c_str());
+      throw  OFX::Exception::PropertyValueIllegalToHost(propName);
       break;
 
     case kOfxStatErrBadHandle :
@@ -174,6 +174,21 @@ namespace OFX {
     return value != NULL ?  std::string(value) : std::string();
   }
 
+  /** @brief Get a string property without copying it */
+  const char *PropertySet::propGetCString(const char* property, int idx, bool throwOnFailure) const
+  {
+    assert(_propHandle != 0);
+    char *value = NULL;
+    OfxStatus stat = gPropSuite->propGetString(_propHandle, property, idx, &value);
+    OFX::Log::error(stat != kOfxStatOK, "Failed on getting string property %s[%d], host returned status %s;", 
+      property, idx, mapStatusToString(stat));
+    if(throwOnFailure)
+      throwPropertyException(stat, property);
+
+    if(_gPropLogging > 0) Log::print("Retrieved string property %s[%d], was given %s.",  property, idx, value);
+    return value != NULL ? value : "";
+  }
+
   /** @brief Get single double property */
   double PropertySet::propGetDouble(const char* property, int idx, bool throwOnFailure) const
   {
@@ -203,6 +218,32 @@ namespace OFX {
     if(_gPropLogging > 0) Log::print("Retrieved int property %s[%d], was given %d.",  property, idx, value);
     return value;
   }
+
+  /** @brief Get a multiple dimension double property */
+  void PropertySet::propGetDoubleN(const char* property, double *values, int count, bool throwOnFailure) const
+  {
+    assert(_propHandle != 0);
+    OfxStatus stat = gPropSuite->propGetDoubleN(_propHandle, property, count, values);
+    OFX::Log::error(stat != kOfxStatOK, "Failed on getting double property %s[0..%d], host returned status %s;", 
+      property, count-1, mapStatusToString(stat));
+    if(throwOnFailure)
+      throwPropertyException(stat, property); 
+
+    if(_gPropLogging > 0) Log::print("Retrieved double property %s[0..%d].",  property, count-1);
+  }
+
+  /** @brief Get a multiple dimension int property */
+  void PropertySet::propGetIntN(const char* property, int *values, int count, bool throwOnFailure) const
+  {
+    assert(_propHandle != 0);
+    OfxStatus stat = gPropSuite->propGetIntN(_propHandle, property, count, values);
+    OFX::Log::error(stat != kOfxStatOK, "Failed on getting int property %s[0..%d], host returned status %s;", 
+      property, count-1, mapStatusToString(stat));
+    if(throwOnFailure)
+      throwPropertyException(stat, property); 
+
+    if(_gPropLogging > 0) Log::print("Retrieved int property %s[0..%d].",  property, count-1);
+  }
     
   std::list<std::string> PropertySet::propGetNString(const char* property, bool throwOnFailure) const
   {
@@ -9,6 +9,7 @@ This file contains headers for classes that are used to validate property sets a
 
 #include "ofxsSupportPrivate.h"
 #include <stdarg.h>
+#include <stdlib.h>
 #ifdef OFX_SUPPORTS_OPENGLRENDER
 #include "ofxOpenGLRender.h"
 #endif
@@ -24,6 +25,13 @@ This file contains headers for classes that are used to validate property sets a
 #endif
 
 //#define kOfxsDisableValidation
+
+/** @brief environment variable setting how often a property set whose shape has already been validated is fully validated again.
+
+1 validates every set fully every time, 0 never validates a shape again until the plugin is reloaded. Defaults to 256.
+*/
+#define kValidationSamplePeriodEnvVar "OFX_VALIDATION_SAMPLE_PERIOD"
+
 /** @brief OFX namespace
 */
 namespace OFX {
@@ -32,6 +40,12 @@ namespace OFX {
   namespace Validation {
 
 #ifndef kOfxsDisableValidation
+    /** @brief bumped on each load, so a new host has every property set shape validated again */
+    static std::atomic<unsigned int> gValidationGeneration(1);
+
+    /** @brief how often an already validated shape is fully validated again, 0 for never */
+    static unsigned int gValidationSamplePeriod = 256;
+
     /** @brief Set the vector by getting dimension things specified by ilk from the argp list, used by PropertyDescription ctor */
     static void
       setVectorFromVarArgs(OFX::PropertyTypeEnum ilk,
@@ -194,6 +208,9 @@ namespace OFX {
     */
     PropertySetDescription::PropertySetDescription(const char *setName, ...) // PropertyDescription *v, int nV)
       : _setName(setName)
+      , _validatedGeneration(0)
+      , _validatedSignature(0)
+      , _validationCount(0)
     {
 
       // go through the var args to extract defaults to check against and values to set to
@@ -237,6 +254,27 @@ namespace OFX {
       _descriptions.push_back(desc);
       if(deleteOnDestruction)
         _deleteThese.push_back(desc);
+
+      // the shape has changed, so validate the next set fully
+      _validatedGeneration = 0;
+    }
+
+    /** @brief a cheap signature of the shape of the property set, a hash of the dimensions of its described array properties */
+    int
+      PropertySetDescription::signature(PropertySet &propSet) const
+    {
+      unsigned int sig = 2166136261u;
+
+      PropertySet::propDisableLogging();
+      for(size_t i = 0; i < _descriptions.size(); ++i) {
+        if(_descriptions[i]->_dimension != 1) {
+          int dimension = propSet.propGetDimension(_descriptions[i]->_name.c_str(), false);
+          sig = (sig ^ (unsigned int)dimension) * 16777619u;
+        }
+      }
+      PropertySet::propEnableLogging();
+
+      return (int)sig;
     }
 
     /** @brief Validate all the properties in the set */
@@ -245,6 +283,15 @@ namespace OFX {
       bool checkDefaults,
       bool logOrdinaryMessages)
     {
+      // skip sets whose shape was fully validated since the last load, unless this call is sampled
+      unsigned int generation = gValidationGeneration.load(std::memory_order_acquire);
+      int sig = signature(propSet);
+      if(_validatedGeneration.load(std::memory_order_acquire) == generation && _validatedSignature.load(std::memory_order_relaxed) == sig) {
+        unsigned int count = ++_validationCount;
+        if(gValidationSamplePeriod == 0 || count % gValidationSamplePeriod != 0)
+          return;
+      }
+
       OFX::Log::print("START validating properties of %s.", _setName.c_str());
       OFX::Log::indent();
 
@@ -260,6 +307,10 @@ namespace OFX {
 
       OFX::Log::outdent();
       OFX::Log::print("STOP property validation of %s.", _setName.c_str());
+
+      // remember the shape we validated
+      _validatedSignature.store(sig, std::memory_order_relaxed);
+      _validatedGeneration.store(generation, std::memory_order_release);
     }
 
 
@@ -1122,13 +1173,14 @@ namespace OFX {
 
     /** @brief Validates action in/out arguments */
     void
-      validateActionArgumentsProperties(const std::string &action, PropertySet inArgs, PropertySet outArgs)
+      validateActionArgumentsProperties(const char *actionName, PropertySet inArgs, PropertySet outArgs)
     {
 #ifdef kOfxsDisableValidation
-    (void)action;
+    (void)actionName;
     (void)inArgs;
     (void)outArgs;
 #else
+      std::string action(actionName);
       if(action == kOfxActionInstanceChanged) {
         gInstanceChangedInArgPropSet.validate(inArgs);
       }
@@ -1250,6 +1302,15 @@ namespace OFX {
       initialise(void)
     {
 #ifndef kOfxsDisableValidation
+      // a new load may be a new host, so validate every shape again
+      if(++gValidationGeneration == 0)
+        ++gValidationGeneration;
+
+      // how often to sample full validations
+      const char *period = getenv(kValidationSamplePeriodEnvVar);
+      if(period)
+        gValidationSamplePeriod = (unsigned int) atoi(period);
+
       static bool beenInitialised = false;
       if(!beenInitialised && getImageEffectHostDescription()) {
         beenInitialised = true;
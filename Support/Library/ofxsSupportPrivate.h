@@ -8,6 +8,7 @@
 #include "ofxsImageEffect.h"
 #include "ofxsLog.h"
 #include "ofxsMultiThread.h"
+#include <atomic>
 
 /** @brief Namespace private to the ofx support library.
 */
@@ -157,6 +158,18 @@ namespace OFX {
       /** @brief The descriptions of each property */
       std::vector<PropertyDescription *> _deleteThese;
 
+      /** @brief the validation generation in which a property set was last fully validated against this, 0 if never */
+      std::atomic<unsigned int> _validatedGeneration;
+
+      /** @brief the signature of the property set that was last fully validated */
+      std::atomic<int> _validatedSignature;
+
+      /** @brief number of validations asked for, used to sample full validations */
+      std::atomic<unsigned int> _validationCount;
+
+      /** @brief a cheap signature of the shape of the property set, a hash of the dimensions of its described array properties */
+      int signature(PropertySet &propSet) const;
+
     public :
       /** @brief constructor. 
 
@@ -171,7 +184,12 @@ namespace OFX {
       /** @brief add another property in */
       void addProperty(PropertyDescription *desc, bool deleteOnDestruction = true);
 
-      /** @brief See if all properties exist and have the correct dimensions */
+      /** @brief See if all properties exist and have the correct dimensions.
+
+      A set is fully validated the first time after each load of the plugin, after which only its signature is checked,
+      apart from every 256th call, which is fully validated again. The OFX_VALIDATION_SAMPLE_PERIOD environment variable
+      changes that period, 1 fully validates every call, and 0 never validates a shape again until the plugin is reloaded.
+      */
       void validate(PropertySet &propSet, bool checkDefaults = true, bool logOrdinaryMessages = false); 
     };
 
@@ -212,7 +230,7 @@ namespace OFX {
 
     /** @brief Validates action in/out arguments */
     void
-      validateActionArgumentsProperties(const std::string &action, PropertySet inArgs, PropertySet outArgs);
+      validateActionArgumentsProperties(const char *action, PropertySet inArgs, PropertySet outArgs);
 
     /** @brief Validates parameter properties */
     void
@@ -16,6 +16,8 @@
 #include "ofxsMultiThread.h"
 
 #include "../include/ofxsProcessing.H"
+#include "../include/ofxsSimd.H"
+#include "../include/ofxsPixelDispatch.H"
 
 ////////////////////////////////////////////////////////////////////////////////
 // a dumb interact that just draw's a square you can drag
@@ -107,8 +109,8 @@ public :
 
 };
 
-// template to do the RGBA processing
-template <class PIX, int nComponents, int max>
+// template to do the RGBA processing, with masks of MASKPIX components
+template <class PIX, int nComponents, int max, class MASKPIX>
 class ImageScaler : public ImageScalerBase {
 public :
   // ctor
@@ -116,6 +118,67 @@ public :
     : ImageScalerBase(instance)
   {}
 
+  // scales whole runs of components, for when there is no mask
+  struct GainKernel {
+    template <class V> OFXS_SIMD_INLINE void operator()(V &v, const V &scale) const {v *= scale;}
+  };
+
+  // process without a mask, a row at a time with SIMD
+  void processUnmasked(OfxRectI procWindow, const float *scales)
+  {
+    OFX::ImageRowSpan noSrc = {0, procWindow.x2, procWindow.x2, procWindow.x2 - procWindow.x1, 0};
+
+    for(int y = procWindow.y1; y < procWindow.y2; y++) {
+      if(_effect.abort()) break;
+
+      PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
+
+      // the span of the row the source has pixels in is scaled, the rest is black and transparent
+      OFX::ImageRowSpan src = _srcImg ? _srcImg->getRowSpan(y, procWindow.x1, procWindow.x2) : noSrc;
+
+      std::fill(dstPix, dstPix + src.left * nComponents, PIX(0));
+      dstPix += src.left * nComponents;
+
+      if(src.data) {
+        OFX::Simd::transform(GainKernel(), dstPix, (const PIX *) src.data, (src.x2 - src.x1) * nComponents, scales, nComponents);
+        dstPix += (src.x2 - src.x1) * nComponents;
+      }
+
+      std::fill(dstPix, dstPix + src.right * nComponents, PIX(0));
+    }
+  }
+
+  // scale n pixels, modulated by the first component of each mask pixel, or by maskScale if there is no mask pixel
+  void scalePixels(PIX *dstPix, const PIX *srcPix, const MASKPIX *maskPix, int maskComponents, float maskScale, int n, const float *scales)
+  {
+    for(int i = 0; i < n; i++) {
+      // figure the scale factor from the mask pixel
+      if(maskPix) {
+        maskScale = float(*maskPix)/float(OFX::PixelDepthTraits<MASKPIX>::max);
+        maskPix += maskComponents;
+      }
+
+      for(int c = 0; c < nComponents; c++) {
+        float v;
+
+        // scale the component up by the scale factor, modulated by the maskScale
+        if(maskScale != 1.0f) 
+          v = srcPix[c] * (1.0f + (scales[c] - 1.0f) * maskScale);
+        else
+          v = srcPix[c] * scales[c];
+
+        if(max == 1)  // implies floating point and so no clamping
+          dstPix[c] = PIX(v);
+        else  // integer based and we need to clamp
+          dstPix[c] = PIX(Clamp(v, 0, max));
+      }
+
+      // increment the pixels
+      dstPix += nComponents;
+      srcPix += nComponents;
+    }
+  }
+
   // and do some processing
   void multiThreadProcessImages(OfxRectI procWindow)
   {
@@ -125,56 +188,47 @@ public :
     scales[2] = (float)_bScale;
     scales[3] = (float)_aScale;
 
-    float maskScale = 1.0f;
+    if(!_doMasking) {
+      processUnmasked(procWindow, scales);
+      return;
+    }
+
+    OFX::ImageRowSpan noSrc = {0, procWindow.x2, procWindow.x2, procWindow.x2 - procWindow.x1, 0};
+    int maskComponents = _maskImg ? _maskImg->getPixelComponentCount() : 0;
 
     for(int y = procWindow.y1; y < procWindow.y2; y++) {
       if(_effect.abort()) break;
 
       PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
 
-      for(int x = procWindow.x1; x < procWindow.x2; x++) {
-
-        PIX *srcPix = (PIX *)  (_srcImg ? _srcImg->getPixelAddress(x, y) : 0);
-
-        // are we doing masking
-        if(_doMasking) {
-          // we do, get the pixel from the mask
-          if(!_maskImg)
-            maskScale = 1.0f;
-          else
-          {
-            PIX *maskPix = (PIX *)  (_maskImg ? _maskImg->getPixelAddress(x, y) : 0);
-            // figure the scale factor from that pixel
-            maskScale = maskPix != 0 ? float(*maskPix)/float(max) : 0.0f;
-          }
-        }
+      // no src pixel outside the source's span, be black and transparent
+      OFX::ImageRowSpan src = _srcImg ? _srcImg->getRowSpan(y, procWindow.x1, procWindow.x2) : noSrc;
+
+      std::fill(dstPix, dstPix + src.left * nComponents, PIX(0));
+      dstPix += src.left * nComponents;
 
-        // do we have a source image to scale up
-        if(srcPix) {
-          for(int c = 0; c < nComponents; c++) {
-            float v;
-
-            // scale the component up by the scale factor, modulated by the maskScale
-            if(maskScale != 1.0f) 
-              v = srcPix[c] * (1.0f + (scales[c] - 1.0f) * maskScale);
-            else
-              v = srcPix[c] * scales[c];
-
-            if(max == 1)  // implies floating point and so no clamping
-              dstPix[c] = PIX(v);
-            else  // integer based and we need to clamp
-              dstPix[c] = PIX(Clamp(v, 0, max));
-          }
+      if(src.data) {
+        const PIX *srcPix = (const PIX *) src.data;
+
+        if(!_maskImg) {
+          // no mask image means the mask is everywhere
+          scalePixels(dstPix, srcPix, 0, 0, 1.0f, src.x2 - src.x1, scales);
         }
         else {
-          // no src pixel here, be black and transparent
-          for(int c = 0; c < nComponents; c++) {
-            dstPix[c] = 0;
-          }
+          // and outside the mask's span it is nowhere
+          OFX::ImageRowSpan mask = _maskImg->getRowSpan(y, src.x1, src.x2);
+          int left = mask.left * nComponents;
+          int right = (mask.x2 - src.x1) * nComponents;
+
+          scalePixels(dstPix, srcPix, 0, 0, 0.0f, mask.left, scales);
+          scalePixels(dstPix + left, srcPix + left, (const MASKPIX *) mask.data, maskComponents, 0.0f, mask.x2 - mask.x1, scales);
+          scalePixels(dstPix + right, srcPix + right, 0, 0, 0.0f, mask.right, scales);
         }
-        // increment the dst pixel
-        dstPix += nComponents;
+
+        dstPix += (src.x2 - src.x1) * nComponents;
       }
+
+      std::fill(dstPix, dstPix + src.right * nComponents, PIX(0));
     }
   }
 };
@@ -289,6 +343,9 @@ BasicPlugin::setupAndProcess(ImageScalerBase &processor, const OFX::RenderArgume
 
     // Set it in the processor 
     processor.setMaskImg(mask.get());
+
+    // the mask may cover only part of the frame, so rows vary in cost, share them out as threads free up rather than in fixed bands
+    processor.setScheduling(OFX::ImageProcessor::eSchedulingRowChunks);
   }
 
   // get the scale parameter values...
@@ -340,61 +397,31 @@ BasicPlugin::getRegionsOfInterest(const OFX::RegionsOfInterestArguments &args, O
     rois.setRegionOfInterest(*maskClip_, args.regionOfInterest);
 }
 
+// instantiates and runs the processor for the pixel formats being rendered
+struct BasicRenderer {
+  BasicPlugin &plugin;
+  const OFX::RenderArguments &args;
+
+  template <class FORMAT, class MASKFORMAT> void operator()(FORMAT, MASKFORMAT) const
+  {
+    ImageScaler<typename FORMAT::Pixel, FORMAT::nComponents, FORMAT::max, typename MASKFORMAT::Pixel> processor(plugin);
+    plugin.setupAndProcess(processor, args);
+  }
+};
+
 // the overridden render function
 void
 BasicPlugin::render(const OFX::RenderArguments &args)
 {
-  // instantiate the render code based on the pixel depth of the dst clip
-  OFX::BitDepthEnum       dstBitDepth    = dstClip_->getPixelDepth();
-  OFX::PixelComponentEnum dstComponents  = dstClip_->getPixelComponents();
-
-  // do the rendering
-  if(dstComponents == OFX::ePixelComponentRGBA) {
-    switch(dstBitDepth) {
-case OFX::eBitDepthUByte : {      
-  ImageScaler<unsigned char, 4, 255> fred(*this);
-  setupAndProcess(fred, args);
-                           }
-                           break;
-
-case OFX::eBitDepthUShort : {
-  ImageScaler<unsigned short, 4, 65535> fred(*this);
-  setupAndProcess(fred, args);
-                            }                          
-                            break;
-
-case OFX::eBitDepthFloat : {
-  ImageScaler<float, 4, 1> fred(*this);
-  setupAndProcess(fred, args);
-                           }
-                           break;
-default :
-  OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  }
-  else {
-    switch(dstBitDepth) {
-case OFX::eBitDepthUByte : {
-  ImageScaler<unsigned char, 1, 255> fred(*this);
-  setupAndProcess(fred, args);
-                           }
-                           break;
-
-case OFX::eBitDepthUShort : {
-  ImageScaler<unsigned short, 1, 65535> fred(*this);
-  setupAndProcess(fred, args);
-                            }                          
-                            break;
-
-case OFX::eBitDepthFloat : {
-  ImageScaler<float, 1, 1> fred(*this);
-  setupAndProcess(fred, args);
-                           }                          
-                           break;
-default :
-  OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  } 
+  // the mask only matters if we have one
+  OFX::BitDepthEnum maskBitDepth = OFX::eBitDepthNone;
+  if(maskClip_ && maskClip_->isConnected())
+    maskBitDepth = maskClip_->getPixelDepth();
+
+  // instantiate the render code based on the pixel depth and components of the dst clip, and the depth of the mask
+  BasicRenderer renderer = {*this, args};
+  OFX::dispatchPixelFormats(OFX::StandardPixelFormats(), OFX::StandardMaskDepths(), renderer,
+                            dstClip_->getPixelDepth(), dstClip_->getPixelComponents(), maskBitDepth);
 }
 
 // overridden is identity
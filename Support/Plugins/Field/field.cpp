@@ -11,6 +11,7 @@
 #include "ofxsMultiThread.h"
 
 #include "../include/ofxsProcessing.H"
+#include "../include/ofxsPixelDispatch.H"
 
 
 // Base class for the RGBA and the Alpha processor
@@ -39,47 +40,47 @@ public :
     : FieldBase(instance, field)
   {}
 
+  // process n pixels, srcPix is NULL where there is no source
+  void processPixels(PIX *dstPix, const PIX *srcPix, int n)
+  {
+    for(int i = 0; i < n; i++) {
+      for(int c = 0; c < nComponents; c++) {
+        if((_field == OFX::eFieldLower) && (c==0))
+          dstPix[c] = max;
+        else if((_field == OFX::eFieldUpper) && (c==2))
+          dstPix[c] = max;
+        else if(srcPix)
+          dstPix[c] = max - srcPix[c];
+        else
+          dstPix[c] = 0; // no src pixel here, be black and transparent
+      }
+
+      // increment the pixels
+      dstPix += nComponents;
+      if(srcPix)
+        srcPix += nComponents;
+    }
+  }
+
   // and do some processing
   void multiThreadProcessImages(OfxRectI procWindow)
   {
     //eFieldLower only the spatially lower field is present
     //eFieldUpper only the spatially upper field is present
- 
+
+    OFX::ImageRowSpan noSrc = {0, procWindow.x2, procWindow.x2, procWindow.x2 - procWindow.x1, 0};
+
     for(int y = procWindow.y1; y < procWindow.y2; y++) {
       if(_effect.abort()) break;
 
       PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
+      OFX::ImageRowSpan src = _srcImg ? _srcImg->getRowSpan(y, procWindow.x1, procWindow.x2) : noSrc;
 
-      for(int x = procWindow.x1; x < procWindow.x2; x++) {
-
-        PIX *srcPix = (PIX *)  (_srcImg ? _srcImg->getPixelAddress(x, y) : 0);
-
-        // do we have a source image to scale up
-        if(srcPix) {
-          for(int c = 0; c < nComponents; c++) {
-            if((_field == OFX::eFieldLower) && (c==0))
-              dstPix[c] = max;
-            else if((_field == OFX::eFieldUpper) && (c==2))
-              dstPix[c] = max;
-            else
-              dstPix[c] = max - srcPix[c];
-          }
-        }
-        else {
-          // no src pixel here, be black and transparent
-          for(int c = 0; c < nComponents; c++) {
-            if((_field == OFX::eFieldLower) && (c==0))
-              dstPix[c] = max;
-            else if((_field == OFX::eFieldUpper) && (c==2))
-              dstPix[c] = max;
-            else
-              dstPix[c] = 0;
-          }
-        }
-
-        // increment the dst pixel
-        dstPix += nComponents;
-      }
+      processPixels(dstPix, 0, src.left);
+      dstPix += src.left * nComponents;
+      processPixels(dstPix, (const PIX *) src.data, src.x2 - src.x1);
+      dstPix += (src.x2 - src.x1) * nComponents;
+      processPixels(dstPix, 0, src.right);
     }
   }
 };
@@ -151,75 +152,28 @@ FieldPlugin::setupAndProcess(FieldBase &processor, const OFX::RenderArguments &a
   processor.process();
 }
 
+// instantiates and runs the processor for the pixel format being rendered
+struct FieldRenderer {
+  FieldPlugin &plugin;
+  const OFX::RenderArguments &args;
+
+  template <class FORMAT> void operator()(FORMAT) const
+  {
+    ImageFielder<typename FORMAT::Pixel, FORMAT::nComponents, FORMAT::max> processor(plugin, args.fieldToRender);
+    plugin.setupAndProcess(processor, args);
+  }
+};
+
 // the overridden render function
 void
 FieldPlugin::render(const OFX::RenderArguments &args)
 {
-  // instantiate the render code based on the pixel depth of the dst clip
-  OFX::BitDepthEnum       dstBitDepth    = dstClip_->getPixelDepth();
-  OFX::PixelComponentEnum dstComponents  = dstClip_->getPixelComponents();
-
   double time = args.time;
   std::cout << "Rendering at time " << time << std::endl;
-  OFX::FieldEnum field = args.fieldToRender;
 
-  // do the rendering
-  if(dstComponents == OFX::ePixelComponentRGBA) 
-  {
-    switch(dstBitDepth) 
-    {
-    case OFX::eBitDepthUByte : 
-    {      
-      ImageFielder<unsigned char, 4, 255> fred(*this, field);
-      setupAndProcess(fred, args);
-    }
-    break;
-    
-    case OFX::eBitDepthUShort : 
-    {
-      ImageFielder<unsigned short, 4, 65535> fred(*this, field);
-      setupAndProcess(fred, args);
-    }                          
-    break;
-    
-    case OFX::eBitDepthFloat : 
-    {
-      ImageFielder<float, 4, 1> fred(*this, field);
-      setupAndProcess(fred, args);
-    }
-    break;
-    default :
-      OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  }
-  else 
-  {
-    switch(dstBitDepth) 
-    {
-    case OFX::eBitDepthUByte : 
-    {
-      ImageFielder<unsigned char, 1, 255> fred(*this, field);
-      setupAndProcess(fred, args);
-    }
-    break;
-      
-    case OFX::eBitDepthUShort : 
-    {
-      ImageFielder<unsigned short, 1, 65535> fred(*this, field);
-      setupAndProcess(fred, args);
-    }                          
-    break;
-      
-    case OFX::eBitDepthFloat : 
-    {
-      ImageFielder<float, 1, 1> fred(*this, field);
-      setupAndProcess(fred, args);
-    }                          
-    break;
-    default :
-      OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  } 
+  // instantiate the render code based on the pixel depth and components of the dst clip
+  FieldRenderer renderer = {*this, args};
+  OFX::dispatchPixelFormats(OFX::StandardPixelFormats(), renderer, dstClip_->getPixelDepth(), dstClip_->getPixelComponents());
 }
 
 mDeclarePluginFactory(FieldExamplePluginFactory, {}, {});
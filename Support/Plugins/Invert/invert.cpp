@@ -6,26 +6,75 @@
 #endif
 
 #include <stdio.h>
+#include <algorithm>
 #include "ofxsImageEffect.h"
 #include "ofxsMultiThread.h"
 
 #include "../include/ofxsProcessing.H"
+#include "../include/ofxsSimd.H"
+#include "../include/ofxsPixelDispatch.H"
 
 
+// integer components are inverted by flipping their bits, which is the same as max - v
+template <class PIX>
+static void xorInvertComponents(PIX *dst, const PIX *src, int n, const bool *invert, int nComponents)
+{
+  PIX bits[4];
+  for(int c = 0; c < nComponents; c++)
+    bits[c] = invert[c] ? PIX(~PIX(0)) : PIX(0);
+  OFX::Simd::xorComponents(dst, src, n, bits, nComponents);
+}
+
+static void invertComponents(unsigned char *dst, const unsigned char *src, int n, const bool *invert, int nComponents)
+{
+  xorInvertComponents(dst, src, n, invert, nComponents);
+}
+
+static void invertComponents(unsigned short *dst, const unsigned short *src, int n, const bool *invert, int nComponents)
+{
+  xorInvertComponents(dst, src, n, invert, nComponents);
+}
+
+// inverts all components, or those flagged with 1 and copies those flagged with 0, without branching on the flag
+struct InvertKernel {
+  template <class V> OFXS_SIMD_INLINE void operator()(V &v) const {v = 1.f - v;}
+  template <class V> OFXS_SIMD_INLINE void operator()(V &v, const V &flag) const {v = flag + (1.f - 2.f * flag) * v;}
+};
+
+// float and half components are subtracted from 1
+template <class PIX>
+static void invertComponents(PIX *dst, const PIX *src, int n, const bool *invert, int nComponents)
+{
+  if(std::count(invert, invert + nComponents, true) == nComponents) {
+    OFX::Simd::transform(InvertKernel(), dst, src, n);
+    return;
+  }
+
+  float flags[4];
+  for(int c = 0; c < nComponents; c++)
+    flags[c] = invert[c] ? 1.f : 0.f;
+  OFX::Simd::transform(InvertKernel(), dst, src, n, flags, nComponents);
+}
+
 // Base class for the RGBA and the Alpha processor
 class InvertBase : public OFX::ImageProcessor {
 protected :
   OFX::Image *_srcImg;
+  bool        _invert[4];   // which of r, g, b and a to invert
 public :
   /** @brief no arg ctor */
   InvertBase(OFX::ImageEffect &instance)
     : OFX::ImageProcessor(instance)
     , _srcImg(0)
   {        
+    std::fill(_invert, _invert + 4, true);
   }
 
   /** @brief set the src image */
   void setSrcImg(OFX::Image *v) {_srcImg = v;}
+
+  /** @brief set which channels are inverted */
+  void setChannels(bool r, bool g, bool b, bool a) {_invert[0] = r; _invert[1] = g; _invert[2] = b; _invert[3] = a;}
 };
 
 // template to do the RGBA processing
@@ -40,31 +89,29 @@ public :
   // and do some processing
   void multiThreadProcessImages(OfxRectI procWindow)
   {
+    OFX::ImageRowSpan noSrc = {0, procWindow.x2, procWindow.x2, procWindow.x2 - procWindow.x1, 0};
+
+    // alpha only images have just the last channel
+    const bool *invert = _invert + 4 - nComponents;
+
     for(int y = procWindow.y1; y < procWindow.y2; y++) {
       if(_effect.abort()) break;
 
       PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
 
-      for(int x = procWindow.x1; x < procWindow.x2; x++) {
-
-        PIX *srcPix = (PIX *)  (_srcImg ? _srcImg->getPixelAddress(x, y) : 0);
-
-        // do we have a source image to scale up
-        if(srcPix) {
-          for(int c = 0; c < nComponents; c++) {
-            dstPix[c] = max - srcPix[c];
-          }
-        }
-        else {
-          // no src pixel here, be black and transparent
-          for(int c = 0; c < nComponents; c++) {
-            dstPix[c] = 0;
-          }
-        }
-
-        // increment the dst pixel
-        dstPix += nComponents;
+      // the span of the row the source has pixels in is inverted with SIMD, the rest is black and transparent,
+      // the source may be the same memory as dst, if the host renders in place
+      OFX::ImageRowSpan src = _srcImg ? _srcImg->getRowSpan(y, procWindow.x1, procWindow.x2) : noSrc;
+
+      std::fill(dstPix, dstPix + src.left * nComponents, PIX(0));
+      dstPix += src.left * nComponents;
+
+      if(src.data) {
+        invertComponents(dstPix, (const PIX *) src.data, (src.x2 - src.x1) * nComponents, invert, nComponents);
+        dstPix += (src.x2 - src.x1) * nComponents;
       }
+
+      std::fill(dstPix, dstPix + src.right * nComponents, PIX(0));
     }
   }
 };
@@ -77,20 +124,36 @@ protected :
   OFX::Clip *dstClip_;
   OFX::Clip *srcClip_;
 
+  OFX::BooleanParam *invertR_;
+  OFX::BooleanParam *invertG_;
+  OFX::BooleanParam *invertB_;
+  OFX::BooleanParam *invertA_;
+
 public :
   /** @brief ctor */
   InvertPlugin(OfxImageEffectHandle handle)
     : ImageEffect(handle)
     , dstClip_(0)
     , srcClip_(0)
+    , invertR_(0)
+    , invertG_(0)
+    , invertB_(0)
+    , invertA_(0)
   {
     dstClip_ = fetchClip(kOfxImageEffectOutputClipName);
     srcClip_ = fetchClip(kOfxImageEffectSimpleSourceClipName);
+    invertR_ = fetchBooleanParam("invertR");
+    invertG_ = fetchBooleanParam("invertG");
+    invertB_ = fetchBooleanParam("invertB");
+    invertA_ = fetchBooleanParam("invertA");
   }
 
   /* Override the render */
   virtual void render(const OFX::RenderArguments &args);
 
+  /* override is identity */
+  virtual bool isIdentity(const OFX::IsIdentityArguments &args, OFX::Clip * &identityClip, double &identityTime);
+
   /* set up and run a processor */
   void setupAndProcess(InvertBase &, const OFX::RenderArguments &args);
 };
@@ -132,65 +195,46 @@ InvertPlugin::setupAndProcess(InvertBase &processor, const OFX::RenderArguments
   // set the render window
   processor.setRenderWindow(args.renderWindow);
 
+  // set the channels to invert
+  processor.setChannels(invertR_->getValueAtTime(args.time), invertG_->getValueAtTime(args.time),
+                        invertB_->getValueAtTime(args.time), invertA_->getValueAtTime(args.time));
+
   // Call the base class process member, this will call the derived templated process code
   processor.process();
 }
 
+// if no channel is inverted, the output is the source
+bool
+InvertPlugin::isIdentity(const OFX::IsIdentityArguments &args, OFX::Clip * &identityClip, double &identityTime)
+{
+  if(invertR_->getValueAtTime(args.time) || invertG_->getValueAtTime(args.time) ||
+     invertB_->getValueAtTime(args.time) || invertA_->getValueAtTime(args.time))
+    return false;
+
+  identityClip = srcClip_;
+  identityTime = args.time;
+  return true;
+}
+
+// instantiates and runs the processor for the pixel format being rendered
+struct InvertRenderer {
+  InvertPlugin &plugin;
+  const OFX::RenderArguments &args;
+
+  template <class FORMAT> void operator()(FORMAT) const
+  {
+    ImageInverter<typename FORMAT::Pixel, FORMAT::nComponents, FORMAT::max> processor(plugin);
+    plugin.setupAndProcess(processor, args);
+  }
+};
+
 // the overridden render function
 void
 InvertPlugin::render(const OFX::RenderArguments &args)
 {
-  // instantiate the render code based on the pixel depth of the dst clip
-  OFX::BitDepthEnum       dstBitDepth    = dstClip_->getPixelDepth();
-  OFX::PixelComponentEnum dstComponents  = dstClip_->getPixelComponents();
-
-  // do the rendering
-  if(dstComponents == OFX::ePixelComponentRGBA) {
-    switch(dstBitDepth) {
-case OFX::eBitDepthUByte : {      
-  ImageInverter<unsigned char, 4, 255> fred(*this);
-  setupAndProcess(fred, args);
-                           }
-                           break;
-
-case OFX::eBitDepthUShort : {
-  ImageInverter<unsigned short, 4, 65535> fred(*this);
-  setupAndProcess(fred, args);
-                            }                          
-                            break;
-
-case OFX::eBitDepthFloat : {
-  ImageInverter<float, 4, 1> fred(*this);
-  setupAndProcess(fred, args);
-                           }
-                           break;
-default :
-  OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  }
-  else {
-    switch(dstBitDepth) {
-case OFX::eBitDepthUByte : {
-  ImageInverter<unsigned char, 1, 255> fred(*this);
-  setupAndProcess(fred, args);
-                           }
-                           break;
-
-case OFX::eBitDepthUShort : {
-  ImageInverter<unsigned short, 1, 65535> fred(*this);
-  setupAndProcess(fred, args);
-                            }                          
-                            break;
-
-case OFX::eBitDepthFloat : {
-  ImageInverter<float, 1, 1> fred(*this);
-  setupAndProcess(fred, args);
-                           }                          
-                           break;
-default :
-  OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  } 
+  // instantiate the render code based on the pixel depth and components of the dst clip
+  InvertRenderer renderer = {*this, args};
+  OFX::dispatchPixelFormats(OFX::StandardPixelFormats(), renderer, dstClip_->getPixelDepth(), dstClip_->getPixelComponents());
 }
 
 mDeclarePluginFactory(InvertExamplePluginFactory, {}, {});
@@ -208,6 +252,7 @@ void InvertExamplePluginFactory::describe(OFX::ImageEffectDescriptor &desc)
   // add supported pixel depths
   desc.addSupportedBitDepth(eBitDepthUByte);
   desc.addSupportedBitDepth(eBitDepthUShort);
+  desc.addSupportedBitDepth(eBitDepthHalf);
   desc.addSupportedBitDepth(eBitDepthFloat);
 
   // set a few flags
@@ -221,6 +266,15 @@ void InvertExamplePluginFactory::describe(OFX::ImageEffectDescriptor &desc)
 
 }
 
+// define a boolean param that switches inverting a channel
+static void
+defineChannelParam(OFX::ImageEffectDescriptor &desc, const std::string &name, const std::string &label)
+{
+  BooleanParamDescriptor *param = desc.defineBooleanParam(name);
+  param->setLabels(label, label, label);
+  param->setDefault(true);
+}
+
 void InvertExamplePluginFactory::describeInContext(OFX::ImageEffectDescriptor &desc, OFX::ContextEnum /*context*/)
 {
   // Source clip only in the filter context
@@ -238,6 +292,11 @@ void InvertExamplePluginFactory::describeInContext(OFX::ImageEffectDescriptor &d
   dstClip->addSupportedComponent(ePixelComponentAlpha);
   dstClip->setSupportsTiles(true);
 
+  // a switch for each channel
+  defineChannelParam(desc, "invertR", "Invert Red");
+  defineChannelParam(desc, "invertG", "Invert Green");
+  defineChannelParam(desc, "invertB", "Invert Blue");
+  defineChannelParam(desc, "invertA", "Invert Alpha");
 }
 
 OFX::ImageEffect* InvertExamplePluginFactory::createInstance(OfxImageEffectHandle handle, OFX::ContextEnum /*context*/)
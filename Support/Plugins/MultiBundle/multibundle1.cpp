@@ -16,6 +16,7 @@
 #include "ofxsImageEffect.h"
 #include "ofxsMultiThread.h"
 #include "../include/ofxsProcessing.H"
+#include "../include/ofxsPixelDispatch.H"
 
 #include "multibundle1.h"
 
@@ -83,12 +84,34 @@ public :
   }
 };
 
-template <class PIX, int nComponents, int max>
+template <class PIX, int nComponents, int max, class MASKPIX>
 class ImageScaler : public ImageScalerBase 
 {
 public :
   ImageScaler(OFX::ImageEffect &instance): ImageScalerBase(instance)
   {}
+  // process n pixels, modulated by the first component of each mask pixel, or by maskScale if there is no mask pixel
+  void gammaPixels(PIX *dstPix, const PIX *srcPix, const MASKPIX *maskPix, int maskComponents, float maskScale, int n, const float *scales)
+  {
+    for(int i = 0; i < n; i++) 
+    {
+      if(maskPix) 
+      {
+        maskScale = float(*maskPix)/float(OFX::PixelDepthTraits<MASKPIX>::max);
+        maskPix += maskComponents;
+      }
+      for(int c = 0; c < nComponents; c++) 
+      {
+        float v = (float)(pow((double)srcPix[c], (double)scales[c])) * maskScale + (1.0f - maskScale) * srcPix[c];
+        if(max == 1)
+          dstPix[c] = PIX(v);
+        else
+          dstPix[c] = PIX(Clamp(v, 0, max));
+      }
+      dstPix += nComponents;
+      srcPix += nComponents;
+    }
+  }
   void multiThreadProcessImages(OfxRectI procWindow)
   {
     float scales[4];
@@ -96,43 +119,34 @@ public :
     scales[1] = (float)_gScale;
     scales[2] = (float)_bScale;
     scales[3] = (float)_aScale;
-    float maskScale = 1.0f;
+    OFX::ImageRowSpan noSrc = {0, procWindow.x2, procWindow.x2, procWindow.x2 - procWindow.x1, 0};
+    int maskComponents = _maskImg ? _maskImg->getPixelComponentCount() : 0;
     for(int y = procWindow.y1; y < procWindow.y2; y++) 
     {
       if(_effect.abort()) 
         break;
       PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
-      for(int x = procWindow.x1; x < procWindow.x2; x++) 
+      OFX::ImageRowSpan src = _srcImg ? _srcImg->getRowSpan(y, procWindow.x1, procWindow.x2) : noSrc;
+      std::fill(dstPix, dstPix + src.left * nComponents, PIX(0));
+      dstPix += src.left * nComponents;
+      if(src.data) 
       {
-        PIX *srcPix = (PIX *)  (_srcImg ? _srcImg->getPixelAddress(x, y) : 0);
-        if(_doMasking) 
-        {
-          if(!_maskImg)
-            maskScale = 1.0f;
-          else
-          {
-            PIX *maskPix = (PIX *)  (_maskImg ? _maskImg->getPixelAddress(x, y) : 0);
-            maskScale = maskPix != 0 ? float(*maskPix)/float(max) : 0.0f;
-          }
-        }
-        if(srcPix) 
-        {
-          for(int c = 0; c < nComponents; c++) 
-          {
-            float v = (float)(pow((double)srcPix[c], (double)scales[c])) * maskScale + (1.0f - maskScale) * srcPix[c];
-            if(max == 1)
-              dstPix[c] = PIX(v);
-            else
-              dstPix[c] = PIX(Clamp(v, 0, max));
-          }
-        }
+        const PIX *srcPix = (const PIX *) src.data;
+        if(!_doMasking || !_maskImg)
+          gammaPixels(dstPix, srcPix, 0, 0, 1.0f, src.x2 - src.x1, scales);
         else 
         {
-          for(int c = 0; c < nComponents; c++)
-            dstPix[c] = 0;
+          // outside the mask's span the mask is nowhere
+          OFX::ImageRowSpan mask = _maskImg->getRowSpan(y, src.x1, src.x2);
+          int left = mask.left * nComponents;
+          int right = (mask.x2 - src.x1) * nComponents;
+          gammaPixels(dstPix, srcPix, 0, 0, 0.0f, mask.left, scales);
+          gammaPixels(dstPix + left, srcPix + left, (const MASKPIX *) mask.data, maskComponents, 0.0f, mask.x2 - mask.x1, scales);
+          gammaPixels(dstPix + right, srcPix + right, 0, 0, 0.0f, mask.right, scales);
         }
-        dstPix += nComponents;
+        dstPix += (src.x2 - src.x1) * nComponents;
       }
+      std::fill(dstPix, dstPix + src.right * nComponents, PIX(0));
     }
   }
 };
@@ -223,62 +237,25 @@ void GammaPlugin::getRegionsOfInterest(const OFX::RegionsOfInterestArguments &ar
     rois.setRegionOfInterest(*maskClip_, args.regionOfInterest);
 }
 
-void GammaPlugin::render(const OFX::RenderArguments &args)
+struct GammaRenderer 
 {
-  OFX::BitDepthEnum       dstBitDepth    = dstClip_->getPixelDepth();
-  OFX::PixelComponentEnum dstComponents  = dstClip_->getPixelComponents();
-  if(dstComponents == OFX::ePixelComponentRGBA) 
+  GammaPlugin &plugin;
+  const OFX::RenderArguments &args;
+  template <class FORMAT, class MASKFORMAT> void operator()(FORMAT, MASKFORMAT) const
   {
-    switch(dstBitDepth) 
-    {
-    case OFX::eBitDepthUByte :
-      {
-        ImageScaler<unsigned char, 4, 255> fred(*this);
-        setupAndProcess(fred, args);
-        break;
-      }
-    case OFX::eBitDepthUShort :
-      {
-        ImageScaler<unsigned short, 4, 65535> fred(*this);
-        setupAndProcess(fred, args);
-        break;
-      }
-    case OFX::eBitDepthFloat :
-      {
-        ImageScaler<float, 4, 1> fred(*this);
-        setupAndProcess(fred, args);
-        break;
-      }
-    default :
-      OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
+    ImageScaler<typename FORMAT::Pixel, FORMAT::nComponents, FORMAT::max, typename MASKFORMAT::Pixel> processor(plugin);
+    plugin.setupAndProcess(processor, args);
   }
-  else 
-  {
-    switch(dstBitDepth) 
-    {
-    case OFX::eBitDepthUByte :
-      {
-        ImageScaler<unsigned char, 1, 255> fred(*this);
-        setupAndProcess(fred, args);
-        break;
-      }
-    case OFX::eBitDepthUShort :
-      {
-        ImageScaler<unsigned short, 1, 65535> fred(*this);
-        setupAndProcess(fred, args);
-        break;
-      }
-    case OFX::eBitDepthFloat :
-      {
-        ImageScaler<float, 1, 1> fred(*this);
-        setupAndProcess(fred, args);
-        break;
-      }
-    default :
-      OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  } 
+};
+
+void GammaPlugin::render(const OFX::RenderArguments &args)
+{
+  OFX::BitDepthEnum maskBitDepth = OFX::eBitDepthNone;
+  if(maskClip_ && maskClip_->isConnected())
+    maskBitDepth = maskClip_->getPixelDepth();
+  GammaRenderer renderer = {*this, args};
+  OFX::dispatchPixelFormats(OFX::StandardPixelFormats(), OFX::StandardMaskDepths(), renderer,
+                            dstClip_->getPixelDepth(), dstClip_->getPixelComponents(), maskBitDepth);
 }
 
 bool GammaPlugin:: isIdentity(const OFX::IsIdentityArguments &args, OFX::Clip * &identityClip, double &identityTime)
@@ -15,6 +15,7 @@
 #include "ofxsImageEffect.h"
 #include "ofxsMultiThread.h"
 #include "../include/ofxsProcessing.H"
+#include "../include/ofxsPixelDispatch.H"
 
 #include "multibundle2.h"
 
@@ -177,62 +178,21 @@ bool DotExamplePlugin::getRegionOfDefinition(const OFX::RegionOfDefinitionArgume
   return true;
 }
 
-void DotExamplePlugin::render(const OFX::RenderArguments &args)
+struct DotRenderer 
 {
-  OFX::BitDepthEnum       dstBitDepth    = dstClip_->getPixelDepth();
-  OFX::PixelComponentEnum dstComponents  = dstClip_->getPixelComponents();
-  if(dstComponents == OFX::ePixelComponentRGBA) 
+  DotExamplePlugin &plugin;
+  const OFX::RenderArguments &args;
+  template <class FORMAT> void operator()(FORMAT) const
   {
-    switch(dstBitDepth) 
-    {
-    case OFX::eBitDepthUByte : 
-      {
-        DotGenerator<unsigned char, 4, 255> fred(*this);
-        setupAndProcess(fred, args);
-      }
-      break;
-    case OFX::eBitDepthUShort : 
-      {
-        DotGenerator<unsigned short, 4, 65535> fred(*this);
-        setupAndProcess(fred, args);
-      }
-      break;
-    case OFX::eBitDepthFloat : 
-      {
-        DotGenerator<float, 4, 1> fred(*this);
-        setupAndProcess(fred, args);
-      }
-      break;
-    default :
-      OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
+    DotGenerator<typename FORMAT::Pixel, FORMAT::nComponents, FORMAT::max> processor(plugin);
+    plugin.setupAndProcess(processor, args);
   }
-  else 
-  {
-    switch(dstBitDepth) 
-    {
-    case OFX::eBitDepthUByte : 
-      {
-        DotGenerator<unsigned char, 1, 255> fred(*this);
-        setupAndProcess(fred, args);
-      }
-      break;
-    case OFX::eBitDepthUShort : 
-      {
-        DotGenerator<unsigned short, 1, 65535> fred(*this);
-        setupAndProcess(fred, args);
-      }
-      break;
-    case OFX::eBitDepthFloat : 
-      {
-        DotGenerator<float, 1, 1> fred(*this);
-        setupAndProcess(fred, args);
-      }
-      break;
-    default :
-      OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  } 
+};
+
+void DotExamplePlugin::render(const OFX::RenderArguments &args)
+{
+  DotRenderer renderer = {*this, args};
+  OFX::dispatchPixelFormats(OFX::StandardPixelFormats(), renderer, dstClip_->getPixelDepth(), dstClip_->getPixelComponents());
 }
 
 
@@ -8,12 +8,139 @@
 #include "ofxsImageEffect.h"
 #include "ofxsMultiThread.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "../include/ofxsProcessing.H"
 #include "../include/ofxsImageBlender.H"
+#include "../include/ofxsPixelDispatch.H"
 
   namespace OFX {
   extern ImageEffectHostDescription gHostDescription;
   }
+////////////////////////////////////////////////////////////////////////////////
+/** @brief A copy of an image in pixels the plugin owns
+
+It has no property set, so it is kept to the plugin and only handed to the processors.
+*/
+class CopiedImage : public OFX::Image {
+public :
+    /** @brief ctor, wraps the copy of src the descriptor describes, taking what it leaves out from src */
+    CopiedImage(const OFX::Image &src, const OfxImageDescriptorV1 &descriptor)
+      : OFX::Image(0, false, &descriptor)
+    {
+        _preMultiplication = src.getPreMultiplication();
+        _field             = src.getField();
+        _uniqueID          = src.getUniqueIdentifier();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/** @brief A copy of a source frame in image memory, which outlives the render it was fetched in
+
+Images fetched from a clip have to be released before the action that fetched them returns,
+so the frame is copied, and the copy wrapped up as an image the processors can read.
+*/
+class CachedFrame {
+protected :
+    double            _time;              /**< @brief the time the frame was fetched at */
+    OFX::ImageMemory  _memory;            /**< @brief the copied pixels, locked while the frame lives */
+    std::unique_ptr<CopiedImage> _image;  /**< @brief the copy as an image */
+
+public :
+    /** @brief ctor, copies the pixels of src */
+    CachedFrame(const OFX::Image &src, double time, OFX::ImageEffect &effect)
+      : _time(time)
+      , _memory(size_t(src.getBounds().x2 - src.getBounds().x1) * src.getPixelBytes() * (src.getBounds().y2 - src.getBounds().y1), &effect)
+    {
+        // copy the rows, which are packed together in the copy
+        OfxRectI bounds = src.getBounds();
+        int rowBytes = (bounds.x2 - bounds.x1) * src.getPixelBytes();
+        char *data = (char *) _memory.lock();
+        for(int y = bounds.y1; y < bounds.y2; y++)
+            memcpy(data + size_t(y - bounds.y1) * rowBytes, src.getPixelAddress(bounds.x1, y), rowBytes);
+
+        // the strings are only read by the ctor, the premultiplication, field and ID are taken from src
+        OfxImageDescriptorV1 descriptor;
+        descriptor.data               = data;
+        descriptor.bounds             = bounds;
+        descriptor.regionOfDefinition = src.getRegionOfDefinition();
+        descriptor.rowBytes           = rowBytes;
+        descriptor.pixelAspectRatio   = src.getPixelAspectRatio();
+        descriptor.renderScale        = src.getRenderScale();
+        descriptor.components         = OFX::mapPixelComponentEnumToStr(src.getPixelComponents());
+        descriptor.pixelDepth         = OFX::mapBitDepthEnumToStr(src.getPixelDepth());
+        descriptor.preMultiplication  = kOfxImageUnPreMultiplied;
+        descriptor.field              = kOfxImageFieldNone;
+        descriptor.uniqueIdentifier   = 0;
+        _image.reset(new CopiedImage(src, descriptor));
+    }
+
+    /** @brief dtor */
+    ~CachedFrame()
+    {
+        _image.reset();
+        _memory.unlock();
+    }
+
+    /** @brief the copy */
+    const OFX::Image &getImage(void) const {return *_image;}
+
+    /** @brief can the copy stand in for the source frame at a time and scale, rendering a window */
+    bool matches(double time, OfxPointD renderScale, OfxRectI window) const
+    {
+        if(time != _time || renderScale.x != _image->getRenderScale().x || renderScale.y != _image->getRenderScale().y)
+            return false;
+
+        // the copy has all of the frame the window needs
+        OfxRectI bounds = _image->getBounds(), rod = _image->getRegionOfDefinition();
+        OfxRectI needed = {std::max(window.x1, rod.x1), std::max(window.y1, rod.y1), std::min(window.x2, rod.x2), std::min(window.y2, rod.y2)};
+        return needed.x1 >= needed.x2 || needed.y1 >= needed.y2 ||
+            (needed.x1 >= bounds.x1 && needed.y1 >= bounds.y1 && needed.x2 <= bounds.x2 && needed.y2 <= bounds.y2);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/** @brief The source frames of the last sequential render
+
+In a slow motion render, consecutive output frames blend between the same source frames, so keeping the
+frames of one render saves fetching them again for the next. Each frame kept is a copy, so this only pays
+when the host fetching a frame costs more than copying it, as Support/Benchmarks/retimerBench measures.
+Only sequential renders use it, as they are bracketed by begin and end sequence render actions, which
+clear it, so nothing upstream can change the source frames while they are kept.
+*/
+class SourceFrameCache {
+protected :
+    OFX::MultiThread::Mutex _mutex;
+    std::vector<std::shared_ptr<const CachedFrame> > _frames;
+
+public :
+    /** @brief a kept frame that can stand in for the source frame at a time and scale, NULL if none */
+    std::shared_ptr<const CachedFrame> find(double time, OfxPointD renderScale, OfxRectI window)
+    {
+        OFX::MultiThread::AutoMutex lock(_mutex);
+        for(size_t i = 0; i < _frames.size(); i++)
+            if(_frames[i]->matches(time, renderScale, window))
+                return _frames[i];
+        return std::shared_ptr<const CachedFrame>();
+    }
+
+    /** @brief keep just these frames */
+    void keep(const std::vector<std::shared_ptr<const CachedFrame> > &frames)
+    {
+        OFX::MultiThread::AutoMutex lock(_mutex);
+        _frames = frames;
+    }
+
+    /** @brief let go of all the frames, renders still using one keep it until they are done */
+    void clear(void)
+    {
+        OFX::MultiThread::AutoMutex lock(_mutex);
+        _frames.clear();
+    }
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 /** @brief The plugin that does our work */
 class RetimerPlugin : public OFX::ImageEffect {
@@ -26,6 +153,8 @@ protected :
     OFX::DoubleParam  *speed_;      /**< @brief only used in the filter context. */
     OFX::DoubleParam  *duration_;   /**< @brief how long the output should be as a proportion of input. General context only  */
 
+    SourceFrameCache   cache_;      /**< @brief the source frames of the last sequential render */
+
 public :
     /** @brief ctor */
     RetimerPlugin(OfxImageEffectHandle handle)
@@ -55,6 +184,16 @@ public :
     /* Override the render */
     virtual void render(const OFX::RenderArguments &args);
 
+    /* override is identity */
+    virtual bool isIdentity(const OFX::IsIdentityArguments &args, OFX::Clip * &identityClip, double &identityTime);
+
+    /* override the actions that invalidate the cached source frames */
+    virtual void purgeCaches(void);
+    virtual void beginSequenceRender(const OFX::BeginSequenceRenderArguments &args);
+    virtual void endSequenceRender(const OFX::EndSequenceRenderArguments &args);
+    virtual void changedParam(const OFX::InstanceChangedArgs &args, const std::string &paramName);
+    virtual void changedClip(const OFX::InstanceChangedArgs &args, const std::string &clipName);
+
     /** Override the get frames needed action */
     virtual void getFramesNeeded(const OFX::FramesNeededArguments &args, OFX::FramesNeededSetter &frames);
 
@@ -64,6 +203,14 @@ public :
     /* set up and run a processor */
     void
     setupAndProcess(OFX::ImageBlenderBase &, const OFX::RenderArguments &args);
+
+protected :
+    /* the time of the source the output at a time is made from */
+    double getSourceTime(double time);
+
+    /* fetch a source frame, from the cache in sequential renders, adding it to the frames the render used */
+    std::shared_ptr<const OFX::Image> fetchSourceFrame(double time, const OFX::RenderArguments &args,
+                                                       std::vector<std::shared_ptr<const CachedFrame> > &used);
 };
 
 
@@ -120,6 +267,40 @@ static void framesNeeded(double sourceTime, OFX::FieldEnum fieldToRender, double
     *blendp = blend;
 }
 
+// figure the frame we should be retiming from
+double
+RetimerPlugin::getSourceTime(double time)
+{
+    if(getContext() == OFX::eContextRetimer) {
+        // the host is specifying it, so fetch it from the kOfxImageEffectRetimerParamName pseudo-param
+        return sourceTime_->getValueAtTime(time);
+    }
+    else {
+        // we have our own param, which is a speed, so we integrate it to get the time we want
+        return speed_->integrate(0, time);
+    }
+}
+
+std::shared_ptr<const OFX::Image>
+RetimerPlugin::fetchSourceFrame(double time, const OFX::RenderArguments &args,
+                                std::vector<std::shared_ptr<const CachedFrame> > &used)
+{
+    if(!args.sequentialRenderStatus)
+        return std::shared_ptr<const OFX::Image>(srcClip_->fetchImage(time));
+
+    std::shared_ptr<const CachedFrame> frame = cache_.find(time, args.renderScale, args.renderWindow);
+    if(!frame) {
+        std::unique_ptr<OFX::Image> src(srcClip_->fetchImage(time));
+        if(!src.get())
+            return std::shared_ptr<const OFX::Image>();
+        frame = std::make_shared<const CachedFrame>(*src, time, *this);
+    }
+    used.push_back(frame);
+
+    // the image shares ownership of the frame it is in
+    return std::shared_ptr<const OFX::Image>(frame, &frame->getImage());
+}
+
 /* set up and run a processor */
 void
 RetimerPlugin::setupAndProcess(OFX::ImageBlenderBase &processor, const OFX::RenderArguments &args)
@@ -130,25 +311,23 @@ RetimerPlugin::setupAndProcess(OFX::ImageBlenderBase &processor, const OFX::Rend
     OFX::PixelComponentEnum    dstComponents  = dst->getPixelComponents();
   
     // figure the frame we should be retiming from
-    double sourceTime;
-    
-    if(getContext() == OFX::eContextRetimer) {
-        // the host is specifying it, so fetch it from the kOfxImageEffectRetimerParamName pseudo-param
-        sourceTime = sourceTime_->getValueAtTime(args.time);
-    }
-    else {
-        // we have our own param, which is a speed, so we integrate it to get the time we want
-        sourceTime = speed_->integrate(0, args.time);
-    }
+    double sourceTime = getSourceTime(args.time);
 
     // figure the two images we are blending between
     double fromTime, toTime;
     double blend;
     framesNeeded(sourceTime, args.fieldToRender, &fromTime, &toTime, &blend);
 
-    // fetch the two source images
-    std::unique_ptr<OFX::Image> fromImg(srcClip_->fetchImage(fromTime));
-    std::unique_ptr<OFX::Image> toImg(srcClip_->fetchImage(toTime));
+    // fetch the two source images, only the first is needed if the output lands on it
+    std::vector<std::shared_ptr<const CachedFrame> > used;
+    std::shared_ptr<const OFX::Image> fromImg = fetchSourceFrame(fromTime, args, used);
+    std::shared_ptr<const OFX::Image> toImg;
+    if(blend != 0)
+        toImg = fetchSourceFrame(toTime, args, used);
+
+    // keep them for the next frame of the sequence
+    if(args.sequentialRenderStatus)
+        cache_.keep(used);
 
     // make sure bit depths are sane
     if(fromImg.get()) checkComponents(*fromImg, dstBitDepth, dstComponents);
@@ -206,61 +385,73 @@ RetimerPlugin::getTimeDomain(OfxRangeD &range)
     return false;
 }
 
+// instantiates and runs the processor for the pixel format being rendered
+struct RetimerRenderer {
+    RetimerPlugin &plugin;
+    const OFX::RenderArguments &args;
+
+    template <class FORMAT> void operator()(FORMAT) const
+    {
+        OFX::ImageBlender<typename FORMAT::Pixel, FORMAT::nComponents> processor(plugin);
+        plugin.setupAndProcess(processor, args);
+    }
+};
+
 // the overridden render function
 void
 RetimerPlugin::render(const OFX::RenderArguments &args)
 {
-    // instantiate the render code based on the pixel depth of the dst clip
-    OFX::BitDepthEnum       dstBitDepth    = dstClip_->getPixelDepth();
-    OFX::PixelComponentEnum dstComponents  = dstClip_->getPixelComponents();
-
-    // do the rendering
-    if(dstComponents == OFX::ePixelComponentRGBA) {
-        switch(dstBitDepth) {
-        case OFX::eBitDepthUByte : {      
-            OFX::ImageBlender<unsigned char, 4> fred(*this);
-            setupAndProcess(fred, args);
-        }
-        break;
+    // instantiate the render code based on the pixel depth and components of the dst clip
+    RetimerRenderer renderer = {*this, args};
+    OFX::dispatchPixelFormats(OFX::StandardPixelFormats(), renderer, dstClip_->getPixelDepth(), dstClip_->getPixelComponents());
+}
 
-        case OFX::eBitDepthUShort : {
-            OFX::ImageBlender<unsigned short, 4> fred(*this);
-            setupAndProcess(fred, args);
-        }                          
-        break;
+// the output is a source frame as is when it lands on one
+bool
+RetimerPlugin::isIdentity(const OFX::IsIdentityArguments &args, OFX::Clip * &identityClip, double &identityTime)
+{
+    double fromTime, toTime;
+    double blend;
+    framesNeeded(getSourceTime(args.time), args.fieldToRender, &fromTime, &toTime, &blend);
 
-        case OFX::eBitDepthFloat : {
-            OFX::ImageBlender<float, 4> fred(*this);
-            setupAndProcess(fred, args);
-        }
-        break;
-        default :
-            OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-        }
-    }
-    else {
-        switch(dstBitDepth) {
-        case OFX::eBitDepthUByte : {
-            OFX::ImageBlender<unsigned char, 1> fred(*this);
-            setupAndProcess(fred, args);
-        }
-        break;
-
-        case OFX::eBitDepthUShort : {
-            OFX::ImageBlender<unsigned short, 1> fred(*this);
-            setupAndProcess(fred, args);
-        }                          
-        break;
-
-        case OFX::eBitDepthFloat : {
-            OFX::ImageBlender<float, 1> fred(*this);
-            setupAndProcess(fred, args);
-        }                          
-        break;
-        default :
-            OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-        }
-    } // switch
+    // a field is taken from a frame with the other field interleaved, so is never the frame as is
+    if(args.fieldToRender != OFX::eFieldNone || blend != 0)
+        return false;
+
+    identityClip = srcClip_;
+    identityTime = fromTime;
+    return true;
+}
+
+// the cached frames may no longer be what the source clip would give
+void
+RetimerPlugin::purgeCaches(void)
+{
+    cache_.clear();
+}
+
+void
+RetimerPlugin::beginSequenceRender(const OFX::BeginSequenceRenderArguments &/*args*/)
+{
+    cache_.clear();
+}
+
+void
+RetimerPlugin::endSequenceRender(const OFX::EndSequenceRenderArguments &/*args*/)
+{
+    cache_.clear();
+}
+
+void
+RetimerPlugin::changedParam(const OFX::InstanceChangedArgs &/*args*/, const std::string &/*paramName*/)
+{
+    cache_.clear();
+}
+
+void
+RetimerPlugin::changedClip(const OFX::InstanceChangedArgs &/*args*/, const std::string &/*clipName*/)
+{
+    cache_.clear();
 }
 
 using namespace OFX;
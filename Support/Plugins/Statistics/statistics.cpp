@@ -0,0 +1,285 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifdef _WINDOWS
+#include <windows.h>
+#endif
+
+#include <stdio.h>
+#include <float.h>
+#include <algorithm>
+#include "ofxsImageEffect.h"
+#include "ofxsMultiThread.h"
+
+#include "../include/ofxsProcessing.H"
+#include "../include/ofxsImageReducer.H"
+#include "../include/ofxsPixelDispatch.H"
+
+// per component statistics of some pixels, with components scaled to 0..1 and alpha always last
+struct Statistics {
+  double sum[4];
+  double minimum[4];
+  double maximum[4];
+  double count;
+
+  Statistics()
+    : count(0)
+  {
+    std::fill(sum, sum + 4, 0.0);
+    std::fill(minimum, minimum + 4, DBL_MAX);
+    std::fill(maximum, maximum + 4, -DBL_MAX);
+  }
+
+  void merge(const Statistics &other)
+  {
+    for(int c = 0; c < 4; c++) {
+      sum[c] += other.sum[c];
+      minimum[c] = std::min(minimum[c], other.minimum[c]);
+      maximum[c] = std::max(maximum[c], other.maximum[c]);
+    }
+    count += other.count;
+  }
+};
+
+// Base class for the RGBA and the Alpha processor
+class StatisticsBase : public OFX::ImageReducer<Statistics> {
+protected :
+  const OFX::Image *_srcImg;
+public :
+  /** @brief no arg ctor */
+  StatisticsBase(OFX::ImageEffect &instance)
+    : OFX::ImageReducer<Statistics>(instance)
+    , _srcImg(0)
+  {
+  }
+
+  /** @brief set the src image */
+  void setSrcImg(const OFX::Image *v) {_srcImg = v;}
+};
+
+// template to gather the statistics
+template <class PIX, int nComponents, int max>
+class StatisticsGatherer : public StatisticsBase {
+public :
+  // ctor
+  StatisticsGatherer(OFX::ImageEffect &instance)
+    : StatisticsBase(instance)
+  {}
+
+  // add up the pixels of window that are in the source
+  void reduce(OfxRectI window, Statistics &stats)
+  {
+    // alpha only images put their one component last
+    int first = 4 - nComponents;
+
+    for(int y = window.y1; y < window.y2; y++) {
+      OFX::ConstImageRowSpan src = _srcImg->getRowSpan(y, window.x1, window.x2);
+      const PIX *srcPix = (const PIX *) src.data;
+      int n = src.x2 - src.x1;
+
+      // sum each row on its own first, so long rows lose less precision
+      double rowSum[4] = {0, 0, 0, 0};
+      for(int i = 0; i < n; i++) {
+        for(int c = 0; c < nComponents; c++) {
+          double v = double(srcPix[c]) / max;
+          rowSum[first + c] += v;
+          stats.minimum[first + c] = std::min(stats.minimum[first + c], v);
+          stats.maximum[first + c] = std::max(stats.maximum[first + c], v);
+        }
+        srcPix += nComponents;
+      }
+
+      for(int c = first; c < 4; c++)
+        stats.sum[c] += rowSum[c];
+      stats.count += n;
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/** @brief The plugin that does our work */
+class StatisticsPlugin : public OFX::ImageEffect {
+protected :
+  // do not need to delete these, the ImageEffect is managing them for us
+  OFX::Clip *srcClip_;
+
+  OFX::RGBAParam *mean_;
+  OFX::RGBAParam *minimum_;
+  OFX::RGBAParam *maximum_;
+
+public :
+  /** @brief ctor */
+  StatisticsPlugin(OfxImageEffectHandle handle)
+    : ImageEffect(handle)
+    , srcClip_(0)
+    , mean_(0)
+    , minimum_(0)
+    , maximum_(0)
+  {
+    srcClip_ = fetchClip(kOfxImageEffectSimpleSourceClipName);
+    mean_    = fetchRGBAParam("mean");
+    minimum_ = fetchRGBAParam("minimum");
+    maximum_ = fetchRGBAParam("maximum");
+  }
+
+  /* Override the render, which never happens as the effect is always an identity */
+  virtual void render(const OFX::RenderArguments &args);
+
+  /* override is identity */
+  virtual bool isIdentity(const OFX::IsIdentityArguments &args, OFX::Clip * &identityClip, double &identityTime);
+
+  /* override changedParam */
+  virtual void changedParam(const OFX::InstanceChangedArgs &args, const std::string &paramName);
+
+  /* gather the statistics of the source at a time into the params */
+  void analyse(StatisticsBase &gatherer, double time);
+};
+
+void
+StatisticsPlugin::render(const OFX::RenderArguments &/*args*/)
+{
+  OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
+}
+
+// the output is always the source, the statistics are the params
+bool
+StatisticsPlugin::isIdentity(const OFX::IsIdentityArguments &args, OFX::Clip * &identityClip, double &identityTime)
+{
+  identityClip = srcClip_;
+  identityTime = args.time;
+  return true;
+}
+
+void
+StatisticsPlugin::analyse(StatisticsBase &gatherer, double time)
+{
+  std::unique_ptr<OFX::Image> src(srcClip_->fetchImage(time));
+  if(!src.get())
+    return;
+
+  // add up the whole of the source
+  gatherer.setSrcImg(src.get());
+  gatherer.setRenderWindow(src->getBounds());
+  gatherer.process();
+
+  // leave the params be if the host aborted before the whole source was added up
+  const Statistics &stats = gatherer.getResult();
+  if(!gatherer.isComplete() || stats.count == 0)
+    return;
+
+  double mean[4];
+  for(int c = 0; c < 4; c++)
+    mean[c] = stats.sum[c] / stats.count;
+
+  // components the source does not have have no statistics, and are left at 0
+  int first = src->getPixelComponents() == OFX::ePixelComponentAlpha ? 3 : 0;
+  double minimum[4] = {0, 0, 0, 0}, maximum[4] = {0, 0, 0, 0};
+  std::copy(stats.minimum + first, stats.minimum + 4, minimum + first);
+  std::copy(stats.maximum + first, stats.maximum + 4, maximum + first);
+
+  mean_->setValueAtTime(time, mean[0], mean[1], mean[2], mean[3]);
+  minimum_->setValueAtTime(time, minimum[0], minimum[1], minimum[2], minimum[3]);
+  maximum_->setValueAtTime(time, maximum[0], maximum[1], maximum[2], maximum[3]);
+}
+
+// instantiates and runs the gatherer for the pixel format of the source
+struct StatisticsRunner {
+  StatisticsPlugin &plugin;
+  double time;
+
+  template <class FORMAT> void operator()(FORMAT) const
+  {
+    StatisticsGatherer<typename FORMAT::Pixel, FORMAT::nComponents, FORMAT::max> gatherer(plugin);
+    plugin.analyse(gatherer, time);
+  }
+};
+
+void
+StatisticsPlugin::changedParam(const OFX::InstanceChangedArgs &args, const std::string &paramName)
+{
+  if(paramName == "analyse" && srcClip_->isConnected()) {
+    StatisticsRunner runner = {*this, args.time};
+    OFX::dispatchPixelFormats(OFX::StandardPixelFormats(), runner, srcClip_->getPixelDepth(), srcClip_->getPixelComponents());
+  }
+}
+
+mDeclarePluginFactory(StatisticsExamplePluginFactory, {}, {});
+
+using namespace OFX;
+void StatisticsExamplePluginFactory::describe(OFX::ImageEffectDescriptor &desc)
+{
+  // basic labels
+  desc.setLabels("Statistics", "Statistics", "Statistics");
+  desc.setPluginGrouping("OFX");
+
+  // add the supported contexts, only filter at the moment
+  desc.addSupportedContext(eContextFilter);
+
+  // add supported pixel depths
+  desc.addSupportedBitDepth(eBitDepthUByte);
+  desc.addSupportedBitDepth(eBitDepthUShort);
+  desc.addSupportedBitDepth(eBitDepthFloat);
+
+  // set a few flags
+  desc.setSingleInstance(false);
+  desc.setHostFrameThreading(false);
+  desc.setSupportsMultiResolution(true);
+  desc.setSupportsTiles(true);
+  desc.setTemporalClipAccess(false);
+  desc.setRenderTwiceAlways(false);
+  desc.setSupportsMultipleClipPARs(false);
+}
+
+// define an RGBA param to hold a statistic
+static void
+defineStatisticParam(OFX::ImageEffectDescriptor &desc, const std::string &name, const std::string &label)
+{
+  RGBAParamDescriptor *param = desc.defineRGBAParam(name);
+  param->setLabels(label, label, label);
+  param->setDefault(0, 0, 0, 0);
+  param->setEvaluateOnChange(false);
+}
+
+void StatisticsExamplePluginFactory::describeInContext(OFX::ImageEffectDescriptor &desc, OFX::ContextEnum /*context*/)
+{
+  // Source clip only in the filter context
+  // create the mandated source clip
+  ClipDescriptor *srcClip = desc.defineClip(kOfxImageEffectSimpleSourceClipName);
+  srcClip->addSupportedComponent(ePixelComponentRGBA);
+  srcClip->addSupportedComponent(ePixelComponentAlpha);
+  srcClip->setTemporalClipAccess(false);
+  srcClip->setSupportsTiles(false);
+  srcClip->setIsMask(false);
+
+  // create the mandated output clip
+  ClipDescriptor *dstClip = desc.defineClip(kOfxImageEffectOutputClipName);
+  dstClip->addSupportedComponent(ePixelComponentRGBA);
+  dstClip->addSupportedComponent(ePixelComponentAlpha);
+  dstClip->setSupportsTiles(true);
+
+  // the button that gathers the statistics of the current frame
+  PushButtonParamDescriptor *analyse = desc.definePushButtonParam("analyse");
+  analyse->setLabels("Analyse", "Analyse", "Analyse");
+  analyse->setHint("Gather the statistics of the source at the current frame");
+
+  defineStatisticParam(desc, "mean", "Mean");
+  defineStatisticParam(desc, "minimum", "Minimum");
+  defineStatisticParam(desc, "maximum", "Maximum");
+}
+
+OFX::ImageEffect* StatisticsExamplePluginFactory::createInstance(OfxImageEffectHandle handle, OFX::ContextEnum /*context*/)
+{
+  return new StatisticsPlugin(handle);
+}
+
+namespace OFX
+{
+  namespace Plugin
+  {
+    void getPluginIDs(OFX::PluginFactoryArray &ids)
+    {
+      static StatisticsExamplePluginFactory p("net.sf.openfx.statisticsPlugin", 1, 0);
+      ids.push_back(&p);
+    }
+  }
+}
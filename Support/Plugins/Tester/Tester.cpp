@@ -17,6 +17,7 @@
 #include "ofxsInteract.h"
 
 #include "../include/ofxsProcessing.H"
+#include "../include/ofxsPixelDispatch.H"
 
 static const OfxPointD kBoxSize = {5, 5};
 
@@ -193,26 +194,22 @@ public :
   ImageGenericTester(OFX::ImageEffect &instance) : GenericTestBase(instance){}
   void multiThreadProcessImages(OfxRectI procWindow)
   {
+    OFX::ImageRowSpan noSrc = {0, procWindow.x2, procWindow.x2, procWindow.x2 - procWindow.x1, 0};
     for(int y = procWindow.y1; y < procWindow.y2; y++) 
     {
       if(_effect.abort()) 
         break;
       PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
-      for(int x = procWindow.x1; x < procWindow.x2; x++) 
-      {
-        PIX *srcPix = (PIX *)  (_srcImg ? _srcImg->getPixelAddress(x, y) : 0);
-        if(srcPix) 
-        {
-          for(int c = 0; c < nComponents; c++)
-            dstPix[c] = max - srcPix[c];
-        }
-        else 
-        {
-          for(int c = 0; c < nComponents; c++)
-            dstPix[c] = 0;
-        }
-        dstPix += nComponents;
-      }
+      OFX::ImageRowSpan src = _srcImg ? _srcImg->getRowSpan(y, procWindow.x1, procWindow.x2) : noSrc;
+      const PIX *srcPix = (const PIX *) src.data;
+      int n = (src.x2 - src.x1) * nComponents;
+
+      std::fill(dstPix, dstPix + src.left * nComponents, PIX(0));
+      dstPix += src.left * nComponents;
+      for(int i = 0; i < n; i++)
+        dstPix[i] = max - srcPix[i];
+      dstPix += n;
+      std::fill(dstPix, dstPix + src.right * nComponents, PIX(0));
     }
   }
 };
@@ -234,6 +231,16 @@ public:
   }
 };
 
+struct AnalyserRunner 
+{
+  OFX::Clip* srcClip;
+  OFX::DoubleParam* dbl;
+  template <class FORMAT> void operator()(FORMAT) const
+  {
+    Analyser<typename FORMAT::Pixel, FORMAT::nComponents, FORMAT::max> analyse(srcClip, dbl);
+  }
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 /** @brief The plugin that does our work */
 class GenericTestPlugin : public OFX::ImageEffect 
@@ -271,56 +278,9 @@ public :
     }
     else if(paramName == "analyseButton")
     {
-      OFX::BitDepthEnum       dstBitDepth    = srcClip_->getPixelDepth();
-      OFX::PixelComponentEnum dstComponents  = srcClip_->getPixelComponents();
       OFX::DoubleParam* dbl = fetchDoubleParam("analysisParam");
-
-      if(dstComponents == OFX::ePixelComponentRGBA) 
-      {
-        switch(dstBitDepth) 
-        {
-        case OFX::eBitDepthUByte : 
-          {
-            Analyser<unsigned char, 4, 255> analyse(srcClip_, dbl);
-            break;
-          }
-        case OFX::eBitDepthUShort :
-          {
-            Analyser<unsigned short, 4, 65535> analyse(srcClip_, dbl);
-            break;
-          }
-        case OFX::eBitDepthFloat :
-          {
-            Analyser<float, 4, 1> analyse(srcClip_, dbl);
-            break;
-          }
-        default :
-          OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-        }
-      }
-      else 
-      {
-        switch(dstBitDepth) 
-        {
-        case OFX::eBitDepthUByte :
-          {
-            Analyser<unsigned char, 1, 255> analyse(srcClip_, dbl);
-            break;
-          }
-        case OFX::eBitDepthUShort :
-          {
-            Analyser<unsigned short, 1, 65535> analyse(srcClip_, dbl);
-            break;
-          }
-        case OFX::eBitDepthFloat : 
-          {
-            Analyser<float, 1, 1> analyse(srcClip_, dbl);
-            break;
-          }
-        default :
-          OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-        }
-      }
+      AnalyserRunner runner = {srcClip_, dbl};
+      OFX::dispatchPixelFormats(OFX::StandardPixelFormats(), runner, srcClip_->getPixelDepth(), srcClip_->getPixelComponents());
     }
   }
 };
@@ -350,66 +310,21 @@ void GenericTestPlugin::setupAndProcess(GenericTestBase &processor, const OFX::R
 }
 
 
-void GenericTestPlugin::render(const OFX::RenderArguments &args)
+struct GenericTestRenderer 
 {
-  OFX::BitDepthEnum       dstBitDepth    = dstClip_->getPixelDepth();
-  OFX::PixelComponentEnum dstComponents  = dstClip_->getPixelComponents();
-
-  if(dstComponents == OFX::ePixelComponentRGBA) 
+  GenericTestPlugin &plugin;
+  const OFX::RenderArguments &args;
+  template <class FORMAT> void operator()(FORMAT) const
   {
-    switch(dstBitDepth) 
-    {
-    case OFX::eBitDepthUByte : 
-      {      
-        ImageGenericTester<unsigned char, 4, 255> fred(*this);
-        setupAndProcess(fred, args);
-      }
-      break;
-
-    case OFX::eBitDepthUShort : 
-      {
-        ImageGenericTester<unsigned short, 4, 65535> fred(*this);
-        setupAndProcess(fred, args);
-      }                          
-      break;
-
-    case OFX::eBitDepthFloat : 
-      {
-        ImageGenericTester<float, 4, 1> fred(*this);
-        setupAndProcess(fred, args);
-      }
-      break;
-    default :
-      OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
+    ImageGenericTester<typename FORMAT::Pixel, FORMAT::nComponents, FORMAT::max> processor(plugin);
+    plugin.setupAndProcess(processor, args);
   }
-  else {
-    switch(dstBitDepth) 
-    {
-    case OFX::eBitDepthUByte : 
-      {
-        ImageGenericTester<unsigned char, 1, 255> fred(*this);
-        setupAndProcess(fred, args);
-      }
-      break;
-
-    case OFX::eBitDepthUShort : 
-      {
-        ImageGenericTester<unsigned short, 1, 65535> fred(*this);
-        setupAndProcess(fred, args);
-      }                          
-      break;
-
-    case OFX::eBitDepthFloat : 
-      {
-        ImageGenericTester<float, 1, 1> fred(*this);
-        setupAndProcess(fred, args);
-      }                          
-      break;
-    default :
-      OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  } 
+};
+
+void GenericTestPlugin::render(const OFX::RenderArguments &args)
+{
+  GenericTestRenderer renderer = {*this, args};
+  OFX::dispatchPixelFormats(OFX::StandardPixelFormats(), renderer, dstClip_->getPixelDepth(), dstClip_->getPixelComponents());
 }
 
 class PositionOverlayDescriptor : public OFX::DefaultEffectOverlayDescriptor<PositionOverlayDescriptor, PositionInteract> {};
@@ -2,11 +2,13 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 #include <stdio.h>
+#include <algorithm>
 #include "ofxsImageEffect.h"
 #include "ofxsMultiThread.h"
 
 #include "../include/ofxsProcessing.H"
 #include "../include/ofxsImageBlender.H"
+#include "../include/ofxsPixelDispatch.H"
 
 ////////////////////////////////////////////////////////////////////////////////
 /** @brief The plugin that does our work */
@@ -75,17 +77,18 @@ CrossFadePlugin::setupAndProcess(OFX::ImageBlenderBase &processor, const OFX::Re
   OFX::BitDepthEnum          dstBitDepth    = dst->getPixelDepth();
   OFX::PixelComponentEnum    dstComponents  = dst->getPixelComponents();
 
-  // fetch the two source images
-  std::unique_ptr<OFX::Image> fromImg(fromClip_->fetchImage(args.time));
-  std::unique_ptr<OFX::Image> toImg(toClip_->fetchImage(args.time));
+  // get the transition value
+  float blend = (float)transition_->getValueAtTime(args.time);
+
+  // fetch the two source images, hosts that render rather than asking if we are an identity at either end
+  // only need the one that shows
+  std::unique_ptr<OFX::Image> fromImg(blend < 1.0f ? fromClip_->fetchImage(args.time) : 0);
+  std::unique_ptr<OFX::Image> toImg(blend > 0.0f ? toClip_->fetchImage(args.time) : 0);
 
   // make sure bit depths are sane
   if(fromImg.get()) checkComponents(*fromImg, dstBitDepth, dstComponents);
   if(toImg.get()) checkComponents(*toImg, dstBitDepth, dstComponents);
 
-  // get the transition value
-  float blend = (float)transition_->getValueAtTime(args.time);
-
   // set the images
   processor.setDstImg(dst.get());
   processor.setFromImg(fromImg.get());
@@ -94,68 +97,32 @@ CrossFadePlugin::setupAndProcess(OFX::ImageBlenderBase &processor, const OFX::Re
   // set the render window
   processor.setRenderWindow(args.renderWindow);
 
-  // set the scales
-  processor.setBlend(blend);
+  // set the blend, clamped so that either end copies the image that shows
+  processor.setBlend(std::max(0.0f, std::min(1.0f, blend)));
 
   // Call the base class process member, this will call the derived templated process code
   processor.process();
 }
 
+// instantiates and runs the processor for the pixel format being rendered
+struct CrossFadeRenderer {
+  CrossFadePlugin &plugin;
+  const OFX::RenderArguments &args;
+
+  template <class FORMAT> void operator()(FORMAT) const
+  {
+    OFX::ImageBlender<typename FORMAT::Pixel, FORMAT::nComponents> processor(plugin);
+    plugin.setupAndProcess(processor, args);
+  }
+};
+
 // the overridden render function
 void
 CrossFadePlugin::render(const OFX::RenderArguments &args)
 {
-  // instantiate the render code based on the pixel depth of the dst clip
-  OFX::BitDepthEnum       dstBitDepth    = dstClip_->getPixelDepth();
-  OFX::PixelComponentEnum dstComponents  = dstClip_->getPixelComponents();
-
-  // do the rendering
-  if(dstComponents == OFX::ePixelComponentRGBA) {
-    switch(dstBitDepth) {
-case OFX::eBitDepthUByte : {      
-  OFX::ImageBlender<unsigned char, 4> fred(*this);
-  setupAndProcess(fred, args);
-                           }
-                           break;
-
-case OFX::eBitDepthUShort : {
-  OFX::ImageBlender<unsigned short, 4> fred(*this);
-  setupAndProcess(fred, args);
-                            }                          
-                            break;
-
-case OFX::eBitDepthFloat : {
-  OFX::ImageBlender<float, 4> fred(*this);
-  setupAndProcess(fred, args);
-                           }
-                           break;
-default :
-  OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  }
-  else {
-    switch(dstBitDepth) {
-case OFX::eBitDepthUByte : {
-  OFX::ImageBlender<unsigned char, 1> fred(*this);
-  setupAndProcess(fred, args);
-                           }
-                           break;
-
-case OFX::eBitDepthUShort : {
-  OFX::ImageBlender<unsigned short, 1> fred(*this);
-  setupAndProcess(fred, args);
-                            }                          
-                            break;
-
-case OFX::eBitDepthFloat : {
-  OFX::ImageBlender<float, 1> fred(*this);
-  setupAndProcess(fred, args);
-                           }                          
-                           break;
-default :
-  OFX::throwSuiteStatusException(kOfxStatErrUnsupported);
-    }
-  } // switch
+  // instantiate the render code based on the pixel depth and components of the dst clip
+  CrossFadeRenderer renderer = {*this, args};
+  OFX::dispatchPixelFormats(OFX::StandardPixelFormats(), renderer, dstClip_->getPixelDepth(), dstClip_->getPixelComponents());
 }
 
 // overridden is identity
@@ -201,6 +168,7 @@ void CrossFadeExamplePluginFactory::describe(OFX::ImageEffectDescriptor &desc)
   // Add supported pixel depths
   desc.addSupportedBitDepth(eBitDepthUByte);
   desc.addSupportedBitDepth(eBitDepthUShort);
+  desc.addSupportedBitDepth(eBitDepthHalf);
   desc.addSupportedBitDepth(eBitDepthFloat);
 
   // set a few flags
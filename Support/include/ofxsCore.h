@@ -294,6 +294,15 @@ namespace OFX {
     /// get an int property
     int propGetInt(const char* property, int idx, bool throwOnFailure = true) const;
 
+    /// get a string property without copying it, the string is the host's and is only good until the property changes
+    const char *propGetCString(const char* property, int idx = 0, bool throwOnFailure = true) const;
+
+    /// get all count values of a double property in one go
+    void propGetDoubleN(const char* property, double *values, int count, bool throwOnFailure = true) const;
+
+    /// get all count values of an int property in one go
+    void propGetIntN(const char* property, int *values, int count, bool throwOnFailure = true) const;
+
     /// get a pointer property with index 0
     void* propGetPointer(const char* property, bool throwOnFailure = true) const
     {
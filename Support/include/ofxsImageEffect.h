@@ -18,6 +18,7 @@ of the direct OFX objects and any library side only functions.
 #include "ofxProgress.h"
 #include "ofxTimeLine.h"
 #include "ofxParametricParam.h"
+#include "ofxImageDescriptor.h"
 
 /** @brief Nasty macro used to define empty protected copy ctors and assign ops */
 #define mDeclareProtectedAssignAndCC(CLASS) \
@@ -284,6 +285,19 @@ namespace OFX {
   /// retrieve the host description
   ImageEffectHostDescription* getImageEffectHostDescription();
 
+  ////////////////////////////////////////////////////////////////////////////////
+  /** @brief Names of the per-clip properties set in the region of interest, frames needed and clip preferences actions.
+
+  These are made once, when the clip is defined, so the actions need not build them.
+  */
+  struct ClipPropertyNames {
+    std::string components;       /**< @brief OfxImageClipPropComponents_<clip> */
+    std::string depth;            /**< @brief OfxImageClipPropDepth_<clip> */
+    std::string pixelAspectRatio; /**< @brief OfxImageClipPropPAR_<clip> */
+    std::string regionOfInterest; /**< @brief OfxImageClipPropRoI_<clip> */
+    std::string frameRange;       /**< @brief OfxImageClipPropFrameRange_<clip> */
+  };
+
   ////////////////////////////////////////////////////////////////////////////////
   /** @brief Wraps up a clip */
   class ClipDescriptor {
@@ -298,6 +312,9 @@ namespace OFX {
     /** @brief properties for this clip */
     PropertySet _clipProps;
 
+    /** @brief names of the action properties for this clip */
+    ClipPropertyNames _propertyNames;
+
   protected :
     /** @brief hidden constructor */
     ClipDescriptor(const std::string &name, OfxPropertySetHandle props);
@@ -309,6 +326,9 @@ namespace OFX {
 
     PropertySet &getPropertySet() {return _clipProps;}
 
+    /** @brief names of the action properties for this clip */
+    const ClipPropertyNames &getPropertyNames() const {return _propertyNames;}
+
 
     /** @brief set the label properties */
     void setLabel(const std::string &label);
@@ -445,6 +465,9 @@ namespace OFX {
     */
     ClipDescriptor *defineClip(const std::string &name);
 
+    /** @brief the action property names of a defined clip, NULL if no clip of that name was defined */
+    const ClipPropertyNames *getClipPropertyNames(const std::string &name) const;
+
     /** @brief Access to the string maps needed for runtime properties. Because the char array must persist after the call,
     we need these to be stored in the descriptor, which is only deleted on unload.*/
 
@@ -478,9 +501,22 @@ namespace OFX {
     OfxRectI  _bounds;                       /**< @brief the bounds on the pixel data */
     double    _pixelAspectRatio;             /**< @brief the pixel aspect ratio */
     FieldEnum _field;                        /**< @brief which field this represents */
-    std::string _uniqueID;                   /**< @brief the unique ID of this image */
+    mutable std::string _uniqueID;           /**< @brief the unique ID of this image */
+    mutable bool _uniqueIDFetched;           /**< @brief has _uniqueID been fetched yet */
     OfxPointD _renderScale;                  /**< @brief any scaling factor applied to the image */
 
+    /** @brief fetch the properties from the host */
+    void fetchProperties();
+
+    /** @brief set the properties from the host's packed descriptor */
+    void setFromDescriptor(const OfxImageDescriptorV1 &descriptor);
+
+    /** @brief set the components and depth from the host's strings */
+    void setPixelFormat(const char *components, const char *depth);
+
+    /** @brief ctor, only validating the properties if asked to, and taking them from the descriptor instead if not NULL */
+    ImageBase(OfxPropertySetHandle props, bool validate, const OfxImageDescriptorV1 *descriptor);
+
   public :
     /** @brief ctor */
     ImageBase(OfxPropertySetHandle props);
@@ -501,6 +537,9 @@ namespace OFX {
     /** @brief get the number of components in the image */
     int getPixelComponentCount(void) const { return _pixelComponentCount; }
 
+    /** @brief get the number of bytes in a pixel, 0 for custom depths or components */
+    int getPixelBytes(void) const { return _pixelBytes; }
+
     /** @brief get the string representing the pixel components */
     std::string getPixelComponentsProperty(void) const { return _imageProps.propGetString(kOfxImageEffectPropComponents);}
 
@@ -525,21 +564,51 @@ namespace OFX {
     /** @brief get the fielding of this image */
     FieldEnum getField(void) const { return _field;}
 
-    /** @brief the unique ID of this image */
-    const std::string& getUniqueIdentifier(void) const { return _uniqueID;}
+    /** @brief the unique ID of this image, fetched on the first call, so not to be first called from several threads at once */
+    const std::string& getUniqueIdentifier(void) const;
+  };
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /** @brief The part of a run of pixels on a row that lies in an image's bounds, see Image::getRowSpan
+
+  The run [x1 - left, x2 + right) is the one asked for. Pixels [x1, x2) are in the image
+  and start at data, the \em left pixels before them and the \em right pixels after them
+  are not. If none are in the image, x1 == x2 and data is NULL.
+  */
+  template <class DATA>
+  struct ImageRowSpanT {
+    DATA data;  /**< @brief address of the pixel at x1, NULL if the span is empty */
+    int  x1;    /**< @brief first pixel of the span */
+    int  x2;    /**< @brief one past the last pixel of the span */
+    int  left;  /**< @brief number of pixels asked for before x1 */
+    int  right; /**< @brief number of pixels asked for from x2 on */
   };
 
+  typedef ImageRowSpanT<void *> ImageRowSpan;
+  typedef ImageRowSpanT<const void *> ConstImageRowSpan;
+
   ////////////////////////////////////////////////////////////////////////////////
   /** @brief Wraps up an image */
   class Image : public ImageBase {
   protected :
     void     *_pixelData;                    /**< @brief the base address of the image */
 
+    /** @brief friend so we get access to ctor */
+    friend class Clip;
+
+    /** @brief ctor, only validating the properties if asked to, and taking them from the descriptor instead if not NULL
+
+    With NULL props and a descriptor, this wraps pixels the plugin owns, such as a copy of an image kept
+    in ImageMemory, so that they can be handed to code written for images. They are not released. Such
+    an image has no property set, so it is only made by a subclass that keeps it to the plugin.
+    */
+    Image(OfxPropertySetHandle props, bool validate, const OfxImageDescriptorV1 *descriptor);
+
   public :
     /** @brief ctor */
     Image(OfxPropertySetHandle props);
 
-    /** @brief dtor */
+    /** @brief dtor, releases the image back to the host */
     virtual ~Image();
 
     /** @brief get the pixel data for this image */
@@ -565,6 +634,19 @@ namespace OFX {
     can't know the pixel size to do the work.
     */
     const void *getPixelAddress(int x, int y) const;
+
+    /** @brief return the pixels of [x1, x2) on row y that are inside the image bounds
+
+    x1, x2 and y are in pixel coordinates. Unlike getPixelAddress, the bounds are checked once
+    for the whole run, so a processor can deal with the edges and then loop over the
+    pixels in between without checking each one.
+
+    If the components are custom, no pixels are inside the bounds, as with getPixelAddress.
+    */
+    ImageRowSpan getRowSpan(int y, int x1, int x2);
+
+    /** @brief return the pixels of [x1, x2) on row y that are inside the image bounds */
+    ConstImageRowSpan getRowSpan(int y, int x1, int x2) const;
   };
 
   ////////////////////////////////////////////////////////////////////////////////
@@ -606,8 +688,14 @@ namespace OFX {
     /** @brief effect instance that owns this clip */
     ImageEffect *_effect;
 
+    /** @brief names of the action properties for this clip, from the clip's descriptor, NULL if it had none */
+    const ClipPropertyNames *_propertyNames;
+
     /** @brief hidden constructor */
-    Clip(ImageEffect *effect, const std::string &name, OfxImageClipHandle handle, OfxPropertySetHandle props);
+    Clip(ImageEffect *effect, const std::string &name, OfxImageClipHandle handle, OfxPropertySetHandle props, const ClipPropertyNames *propertyNames);
+
+    /** @brief wrap up an image fetched from this clip */
+    Image *makeImage(OfxPropertySetHandle imageHandle);
 
     /** @brief so one can be made */
     friend class ImageEffect;
@@ -625,6 +713,9 @@ namespace OFX {
     /** @brief get the name */
     const std::string &name(void) const {return _clipName;}
 
+    /** @brief names of the action properties for this clip, throws if the clip was never defined */
+    const ClipPropertyNames &getPropertyNames(void) const;
+
     /** @brief fetch the label */
     void getLabel(std::string &label) const;
 
@@ -827,21 +918,10 @@ namespace OFX {
   class ClipPreferencesSetter {
     OFX::PropertySet outArgs_;
     bool doneSomething_;
-    typedef std::map<std::string, std::string> StringStringMap;
-    const StringStringMap& clipDepthPropNames_;
-    const StringStringMap& clipComponentPropNames_;
-    const StringStringMap& clipPARPropNames_;
-    const std::string& extractValueForName(const StringStringMap& m, const std::string& name);
   public :
-    ClipPreferencesSetter( OFX::PropertySet props, 
-      const StringStringMap& depthPropNames,
-      const StringStringMap& componentPropNames,
-      const StringStringMap& PARPropNames) 
+    ClipPreferencesSetter(OFX::PropertySet props) 
       : outArgs_(props)
       , doneSomething_(false)
-      , clipDepthPropNames_(depthPropNames)
-      , clipComponentPropNames_(componentPropNames)
-      , clipPARPropNames_(PARPropNames)
     {}
 
     bool didSomething(void) const {return doneSomething_;}
@@ -938,6 +1018,9 @@ namespace OFX {
     /** @brief to get access to the effect handle without exposing it generally via a function */
     friend class ImageMemory;
 
+    /** @brief so the descriptor can be set on creation */
+    friend OfxStatus Private::mainEntryStr(const char *, const void *, OfxPropertySetHandle, OfxPropertySetHandle, const char *);
+
     /** @brief The effect handle */
     OfxImageEffectHandle _effectHandle;
 
@@ -947,6 +1030,9 @@ namespace OFX {
     /** @brief the context of the effect */
     ContextEnum _context;
 
+    /** @brief the descriptor this effect was described with in its context, set once the instance is made */
+    const ImageEffectDescriptor *_descriptor;
+
     /** @brief Set of all previously defined parameters, defined on demand */
     std::map<std::string, Clip *> _fetchedClips;
 
@@ -955,6 +1041,12 @@ namespace OFX {
 
     /** @brief cached result of whether progress start succeeded. */
     bool _progressStartSuccess;
+
+    /** @brief whether each render is wrapped in a param snapshot */
+    bool _renderParamSnapshots;
+
+    /** @brief set the descriptor, and resolve the property names of any clips the plugin fetched while being made */
+    void setDescriptor(const ImageEffectDescriptor *desc);
   public :
     /** @brief ctor */
     ImageEffect(OfxImageEffectHandle handle);
@@ -1005,6 +1097,15 @@ namespace OFX {
     /** @brief Have we informed the host we support image tiling ? */
     bool getSupportsTiles(void) const;
 
+    /** @brief Serve getValueAtTime(args.time) from a param snapshot during each render, see ParamSet::beginParamSnapshot. Defaults to false.
+
+    It pays off for plugins whose frames are rendered as many tiles or by many threads, all sharing the one snapshot.
+    */
+    void setRenderParamSnapshots(bool v) {_renderParamSnapshots = v;}
+
+    /** @brief are renders wrapped in a param snapshot */
+    bool getRenderParamSnapshots(void) const {return _renderParamSnapshots;}
+
 #ifdef OFX_SUPPORTS_OPENGLRENDER
     /** @brief Does the plugin support OpenGL accelerated rendering (but is also capable of CPU rendering) ? Can only be called from changedParam or changedClip. */
     void setSupportsOpenGLRender(bool v);
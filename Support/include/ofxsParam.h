@@ -16,7 +16,9 @@ each represent the actions that can be carried out on those particular OFX objec
 
  */
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include "ofxsCore.h"
 
 /** @brief Nasty macro used to define empty protected copy ctors and assign ops */
@@ -72,6 +74,9 @@ namespace OFX {
     class PushButtonParam;
     class ParamSet;
 
+    namespace Private {
+        struct ParamSnapshot;
+    }
 
     /** @brief Enumerates the different types of parameter */
     enum ParamTypeEnum {eDummyParam,
@@ -911,6 +916,18 @@ namespace OFX {
     protected :
         /** @brief hidden constructor */
         ValueParam(const ParamSet *paramSet, const std::string &name, ParamTypeEnum type, OfxParamHandle handle);
+
+        /** @brief this param's slot in the param set's snapshots */
+        int _snapshotSlot;
+
+        /** @brief fetch n values at time t from the param set's snapshot at that time, false if there are none to be had */
+        bool getSnapshotValues(double t, double *v, int n);
+
+        /** @brief fetch n values at time t from the param set's snapshot at that time, false if there are none to be had */
+        bool getSnapshotValues(double t, int *v, int n);
+
+        /** @brief forget the param set's snapshots, called as the param is changed */
+        void dropSnapshotValues(void);
       
         friend class ParamSet;
     public :
@@ -1001,6 +1018,10 @@ namespace OFX {
         /** @brief and a nicer one */
         int getValueAtTime(double t) {int v; getValueAtTime(t, v); return v;}
 
+        /** @brief get the values at many times in one go, values must have room for nTimes entries, eg: when sampling
+            over a shutter interval. OfxParameterSuiteV1 has no batch call, so this is still a suite call a time. */
+        void getValuesAtTimes(const double *times, int nTimes, int *values);
+
         /** @brief set value */
         void setValue(int v);
 
@@ -1061,6 +1082,10 @@ namespace OFX {
         /** @brief get the  value */
         OfxPointI getValueAtTime(double t) {OfxPointI v; getValueAtTime(t, v.x, v.y); return v;}
 
+        /** @brief get the values at many times in one go, values must have room for nTimes entries, eg: when sampling
+            over a shutter interval. OfxParameterSuiteV1 has no batch call, so this is still a suite call a time. */
+        void getValuesAtTimes(const double *times, int nTimes, OfxPointI *values);
+
         /** @brief set value */
         void setValue(int x, int y);
 
@@ -1115,6 +1140,10 @@ namespace OFX {
         /** @brief get the value at a time */
         void getValueAtTime(double t, int &x, int &y, int &z);
 
+        /** @brief get the values at many times in one go, values must have room for nTimes entries, eg: when sampling
+            over a shutter interval. OfxParameterSuiteV1 has no batch call, so this is still a suite call a time. */
+        void getValuesAtTimes(const double *times, int nTimes, Ofx3DPointI *values);
+
         /** @brief set value */
         void setValue(int x, int y, int z);
 
@@ -1203,6 +1232,10 @@ namespace OFX {
         /** @brief get value */
         double getValueAtTime(double t) {double v; getValueAtTime(t, v); return v;}
 
+        /** @brief get the values at many times in one go, values must have room for nTimes entries, eg: when sampling
+            over a shutter interval. OfxParameterSuiteV1 has no batch call, so this is still a suite call a time. */
+        void getValuesAtTimes(const double *times, int nTimes, double *values);
+
         /** @brief set value */
         void setValue(double v);
 
@@ -1263,6 +1296,10 @@ namespace OFX {
         /** @brief get the value at a time */
         void getValueAtTime(double t, double &x, double &y);
 
+        /** @brief get the values at many times in one go, values must have room for nTimes entries, eg: when sampling
+            over a shutter interval. OfxParameterSuiteV1 has no batch call, so this is still a suite call a time. */
+        void getValuesAtTimes(const double *times, int nTimes, OfxPointD *values);
+
         /** @brief set value */
         void setValue(double x, double y);
 
@@ -1323,6 +1360,10 @@ namespace OFX {
         /** @brief get the value at a time */
         void getValueAtTime(double t, double &x, double &y, double &z);
 
+        /** @brief get the values at many times in one go, values must have room for nTimes entries, eg: when sampling
+            over a shutter interval. OfxParameterSuiteV1 has no batch call, so this is still a suite call a time. */
+        void getValuesAtTimes(const double *times, int nTimes, Ofx3DPointD *values);
+
         /** @brief set value */
         void setValue(double x, double y, double z);
 
@@ -1367,6 +1408,10 @@ namespace OFX {
         /** @brief get the value at a time */
         void getValueAtTime(double t, double &r, double &g, double &b);
 
+        /** @brief get the values at many times in one go, values must have room for nTimes entries, eg: when sampling
+            over a shutter interval. OfxParameterSuiteV1 has no batch call, so this is still a suite call a time. */
+        void getValuesAtTimes(const double *times, int nTimes, OfxRGBColourD *values);
+
         /** @brief set value */
         void setValue(double r, double g, double b);
 
@@ -1400,6 +1445,10 @@ namespace OFX {
         /** @brief get the value at a time */
         void getValueAtTime(double t, double &r, double &g, double &b, double &a);
 
+        /** @brief get the values at many times in one go, values must have room for nTimes entries, eg: when sampling
+            over a shutter interval. OfxParameterSuiteV1 has no batch call, so this is still a suite call a time. */
+        void getValuesAtTimes(const double *times, int nTimes, OfxRGBAColourD *values);
+
         /** @brief set value */
         void setValue(double r, double g, double b, double a);
 
@@ -1676,6 +1725,20 @@ namespace OFX {
         /** @brief Set of all previously fetched parameters, created on demand */
         mutable std::map<std::string, Param *> _fetchedParams;
 
+        /** @brief number of slots handed out to params for their snapshotted values, see beginParamSnapshot */
+        mutable std::atomic<int> _nSnapshotSlots;
+
+        /** @brief guards _snapshots */
+        mutable std::mutex _snapshotMutex;
+
+        /** @brief the snapshots taken so far, oldest first, shared by every thread rendering at their times */
+        mutable std::vector<std::shared_ptr<const Private::ParamSnapshot> > _snapshots;
+
+        /** @brief the snapshot at a time, taking it from the host if there is none yet */
+        std::shared_ptr<const Private::ParamSnapshot> fetchParamSnapshot(double time) const;
+
+        friend class ValueParam;
+
         /** @brief see if we have a param of the given name in out map */
         Param *findPreviouslyFetchedParam(const std::string &name) const;
 
@@ -1738,6 +1801,24 @@ namespace OFX {
 
         Param* getParam(const std::string& name) const;
 
+        /** @brief Start serving getValueAtTime(time) calls made on this thread to this set's params from a snapshot.
+
+        The first begin at a time fetches the value of every int, double, colour, boolean and choice
+        param fetched so far from the host, after which the snapshot is only read, so every thread
+        and tile rendering at that time shares it. Calls nest. Values at other times, of params fetched
+        later, and getValue, always go to the host.
+
+        Snapshots are kept for the last few times until dropParamSnapshots, which setting a
+        param and the instance changed action do.
+        */
+        void beginParamSnapshot(double time);
+
+        /** @brief Stop serving getValueAtTime(time) calls on this thread from a snapshot, see beginParamSnapshot */
+        void endParamSnapshot(double time);
+
+        /** @brief Forget the snapshots taken so far, so the next ones are taken from the host again */
+        void dropParamSnapshots(void) const;
+
         /** @brief Fetch an integer param */
         IntParam *fetchIntParam(const std::string &name) const;
 
@@ -0,0 +1,71 @@
+// Copyright OpenFX and contributors to the OpenFX project.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef _ofxImageDescriptor_h_
+#define _ofxImageDescriptor_h_
+
+#include "ofxCore.h"
+
+/** @file ofxImageDescriptor.h
+
+This file defines an optional extension to the Image Effect API, which lets a plugin read
+everything describing an image fetched with OfxImageEffectSuiteV1::clipGetImage in a
+single property call, rather than a call per property and per dimension.
+
+A host supporting it puts a ::kOfxImagePropPackedDescriptor pointer property on its
+images. Plugins that find it missing should fall back on the individual image
+properties.
+*/
+
+/** @brief Pointer to an ::OfxImageDescriptorV1 describing an image
+
+    - Type - pointer X 1
+    - Property Set - an image instance (read only)
+
+This is an optional extension to images. The descriptor it points to, and any strings
+it points to, are owned by the host and are valid until the image is released. The
+descriptor holds the same values as the individual image properties.
+ */
+#define kOfxImagePropPackedDescriptor "OfxImagePropPackedDescriptor"
+
+/** @brief The values of an image's properties, packed into one struct
+
+The strings are the values of the string properties of the same name, and so are
+compared with strcmp, not by pointer.
+ */
+typedef struct OfxImageDescriptorV1 {
+  /** @brief the value of ::kOfxImagePropData, NULL for a texture */
+  void *data;
+
+  /** @brief the value of ::kOfxImagePropBounds */
+  OfxRectI bounds;
+
+  /** @brief the value of ::kOfxImagePropRegionOfDefinition */
+  OfxRectI regionOfDefinition;
+
+  /** @brief the value of ::kOfxImagePropRowBytes */
+  int rowBytes;
+
+  /** @brief the value of ::kOfxImagePropPixelAspectRatio */
+  double pixelAspectRatio;
+
+  /** @brief the value of ::kOfxImageEffectPropRenderScale */
+  OfxPointD renderScale;
+
+  /** @brief the value of ::kOfxImageEffectPropComponents */
+  const char *components;
+
+  /** @brief the value of ::kOfxImageEffectPropPixelDepth */
+  const char *pixelDepth;
+
+  /** @brief the value of ::kOfxImageEffectPropPreMultiplication */
+  const char *preMultiplication;
+
+  /** @brief the value of ::kOfxImagePropField */
+  const char *field;
+
+  /** @brief the value of ::kOfxImagePropUniqueIdentifier */
+  const char *uniqueIdentifier;
+} OfxImageDescriptorV1;
+
+#endif